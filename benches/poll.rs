@@ -0,0 +1,109 @@
+//! Measure `wasi:io/poll.poll` over a large list of idle pollables when a
+//! single one becomes ready while the guest is waiting, calling the host
+//! implementation directly.
+
+use criterion::{criterion_group, criterion_main, Criterion};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+use tokio::sync::Notify;
+use wasmtime::component::{Resource, ResourceTable};
+use wasmtime_wasi::preview2::bindings::{clocks::monotonic_clock::Host as _, io::poll::Host as _};
+use wasmtime_wasi::preview2::{subscribe, Subscribe, WasiCtx, WasiCtxBuilder, WasiView};
+
+criterion_group!(benches, bench_poll);
+criterion_main!(benches);
+
+struct Ctx {
+    table: ResourceTable,
+    wasi: WasiCtx,
+}
+
+impl WasiView for Ctx {
+    fn table(&self) -> &ResourceTable {
+        &self.table
+    }
+    fn table_mut(&mut self) -> &mut ResourceTable {
+        &mut self.table
+    }
+    fn ctx(&self) -> &WasiCtx {
+        &self.wasi
+    }
+    fn ctx_mut(&mut self) -> &mut WasiCtx {
+        &mut self.wasi
+    }
+}
+
+fn bench_poll(c: &mut Criterion) {
+    let _ = env_logger::try_init();
+
+    let runtime = tokio::runtime::Runtime::new().unwrap();
+    let _guard = runtime.enter();
+
+    let mut ctx = Ctx {
+        table: ResourceTable::new(),
+        wasi: WasiCtxBuilder::new().build(),
+    };
+
+    for idle in [100, 10_000] {
+        // Idle pollables are timers an hour out, so each one is registered
+        // with the reactor when it's polled, as a socket's would be.
+        let mut pollables = (0..idle)
+            .map(|_| ctx.subscribe_duration(3_600_000_000_000).unwrap())
+            .collect::<Vec<_>>();
+        let event = Event::default();
+        let resource = ctx.table.push(event.clone()).unwrap();
+        pollables.push(subscribe(&mut ctx.table, resource).unwrap());
+
+        c.bench_function(&format!("poll/{idle}-idle-1-woken"), |b| {
+            b.iter(|| {
+                let list = pollables.iter().map(borrow).collect();
+                event.reset();
+                let ready = runtime
+                    .block_on(async {
+                        // `join!` polls both futures before either is polled
+                        // again, so every pollable has subscribed by the time
+                        // the event is set.
+                        let set = async {
+                            tokio::task::yield_now().await;
+                            event.set();
+                        };
+                        tokio::join!(ctx.poll(list), set).0
+                    })
+                    .unwrap();
+                assert_eq!(ready, [idle]);
+            })
+        });
+    }
+}
+
+/// A pollable which becomes ready once set, waking the task polling it.
+#[derive(Clone, Default)]
+struct Event(Arc<(AtomicBool, Notify)>);
+
+impl Event {
+    fn set(&self) {
+        self.0 .0.store(true, Ordering::SeqCst);
+        self.0 .1.notify_waiters();
+    }
+
+    fn reset(&self) {
+        self.0 .0.store(false, Ordering::SeqCst);
+    }
+}
+
+#[async_trait::async_trait]
+impl Subscribe for Event {
+    async fn ready(&mut self) {
+        loop {
+            let notified = self.0 .1.notified();
+            if self.0 .0.load(Ordering::SeqCst) {
+                return;
+            }
+            notified.await;
+        }
+    }
+}
+
+fn borrow<T: 'static>(resource: &Resource<T>) -> Resource<T> {
+    Resource::new_borrow(resource.rep())
+}
@@ -0,0 +1,128 @@
+//! Measure the requests per second `wasmtime serve` sustains when driven by a
+//! load generator over loopback, with and without `--shards`.
+
+use bytes::Bytes;
+use criterion::{criterion_group, criterion_main, Criterion, Throughput};
+use http_body_util::{BodyExt, Empty};
+use std::io::{BufRead, BufReader};
+use std::net::SocketAddr;
+use std::process::{Child, Command, Stdio};
+use std::time::{Duration, Instant};
+use wasmtime_wasi_http::io::TokioIo;
+
+criterion_group!(benches, bench_serve);
+criterion_main!(benches);
+
+/// Concurrent connections kept open by the load generator.
+const CONNECTIONS: usize = 64;
+
+fn bench_serve(c: &mut Criterion) {
+    let _ = env_logger::try_init();
+
+    let runtime = tokio::runtime::Runtime::new().unwrap();
+    let shards = std::thread::available_parallelism().map_or(1, |n| n.get());
+
+    let mut group = c.benchmark_group("serve");
+    group.throughput(Throughput::Elements(1));
+    for (name, args) in [
+        ("multi-thread".to_string(), vec![]),
+        (
+            format!("shards-{shards}"),
+            vec![format!("--shards={shards}")],
+        ),
+    ] {
+        let server = Server::spawn(&args);
+        group.bench_function(format!("{name}-{CONNECTIONS}-connections"), |b| {
+            b.iter_custom(|requests| runtime.block_on(load(server.addr, requests)))
+        });
+    }
+    group.finish();
+}
+
+/// A `wasmtime serve` process running the `api_proxy` test program, which is
+/// killed when dropped.
+struct Server {
+    child: Child,
+    addr: SocketAddr,
+}
+
+impl Server {
+    fn spawn(args: &[String]) -> Server {
+        let mut child = Command::new(env!("CARGO_BIN_EXE_wasmtime"))
+            .arg("serve")
+            .arg("--addr=127.0.0.1:0")
+            .args(args)
+            .arg(test_programs_artifacts::API_PROXY_COMPONENT)
+            .stdout(Stdio::null())
+            .stderr(Stdio::piped())
+            .spawn()
+            .unwrap();
+
+        // Wait for the server to start listening, and find out which port it
+        // picked, before sending it requests.
+        let mut stderr = BufReader::new(child.stderr.take().unwrap());
+        let mut line = String::new();
+        let addr = loop {
+            line.clear();
+            if stderr.read_line(&mut line).unwrap() == 0 {
+                panic!("`wasmtime serve` exited before it started listening");
+            }
+            if let Some(rest) = line.strip_prefix("Serving HTTP on http://") {
+                break rest.split('/').next().unwrap().parse().unwrap();
+            }
+        };
+
+        // Keep draining stderr so that the server never blocks writing to it.
+        std::thread::spawn(move || std::io::copy(&mut stderr, &mut std::io::sink()));
+
+        Server { child, addr }
+    }
+}
+
+impl Drop for Server {
+    fn drop(&mut self) {
+        let _ = self.child.kill();
+        let _ = self.child.wait();
+    }
+}
+
+/// Sends `requests` requests to `addr`, spread over `CONNECTIONS` concurrent
+/// connections, and returns how long they took, not counting connecting.
+async fn load(addr: SocketAddr, requests: u64) -> Duration {
+    let mut senders = Vec::with_capacity(CONNECTIONS);
+    for _ in 0..CONNECTIONS {
+        let stream = tokio::net::TcpStream::connect(addr).await.unwrap();
+        stream.set_nodelay(true).unwrap();
+        let (sender, conn) = hyper::client::conn::http1::handshake(TokioIo::new(stream))
+            .await
+            .unwrap();
+        tokio::task::spawn(conn);
+        senders.push(sender);
+    }
+
+    let start = Instant::now();
+    let tasks = senders
+        .into_iter()
+        .enumerate()
+        .map(|(i, mut sender)| {
+            let count = requests / CONNECTIONS as u64
+                + u64::from((i as u64) < requests % CONNECTIONS as u64);
+            tokio::task::spawn(async move {
+                for _ in 0..count {
+                    sender.ready().await.unwrap();
+                    let req = hyper::Request::get("/")
+                        .header(hyper::header::HOST, addr.to_string())
+                        .body(Empty::<Bytes>::new())
+                        .unwrap();
+                    let resp = sender.send_request(req).await.unwrap();
+                    assert!(resp.status().is_success());
+                    resp.into_body().collect().await.unwrap();
+                }
+            })
+        })
+        .collect::<Vec<_>>();
+    for task in tasks {
+        task.await.unwrap();
+    }
+    start.elapsed()
+}
@@ -0,0 +1,118 @@
+//! Measure WASI preview2 UDP throughput over loopback, calling the host
+//! implementations of `wasi:sockets/udp` directly.
+
+use criterion::{criterion_group, criterion_main, Criterion, Throughput};
+use std::net::{Ipv4Addr, SocketAddr};
+use wasmtime::component::{Resource, ResourceTable};
+use wasmtime_wasi::preview2::bindings::sockets::{
+    instance_network::Host as _,
+    network::{IpAddressFamily, Network},
+    udp::{
+        self, HostIncomingDatagramStream as _, HostOutgoingDatagramStream as _, HostUdpSocket as _,
+    },
+    udp_create_socket::Host as _,
+};
+use wasmtime_wasi::preview2::{WasiCtx, WasiCtxBuilder, WasiView};
+
+criterion_group!(benches, bench_udp);
+criterion_main!(benches);
+
+const DATAGRAMS: usize = 16;
+const DATAGRAM_SIZE: usize = 1200;
+
+struct Ctx {
+    table: ResourceTable,
+    wasi: WasiCtx,
+}
+
+impl WasiView for Ctx {
+    fn table(&self) -> &ResourceTable {
+        &self.table
+    }
+    fn table_mut(&mut self) -> &mut ResourceTable {
+        &mut self.table
+    }
+    fn ctx(&self) -> &WasiCtx {
+        &self.wasi
+    }
+    fn ctx_mut(&mut self) -> &mut WasiCtx {
+        &mut self.wasi
+    }
+}
+
+fn bench_udp(c: &mut Criterion) {
+    let _ = env_logger::try_init();
+
+    // Sockets are registered with the ambient tokio reactor.
+    let runtime = tokio::runtime::Runtime::new().unwrap();
+    let _guard = runtime.enter();
+
+    let mut ctx = Ctx {
+        table: ResourceTable::new(),
+        wasi: WasiCtxBuilder::new()
+            .inherit_network()
+            .allow_udp(true)
+            .build(),
+    };
+    let network = ctx.instance_network().unwrap();
+    let ((_, sender), _) = bind(&mut ctx, &network);
+    let ((receiver, _), addr) = bind(&mut ctx, &network);
+
+    let datagrams = (0..DATAGRAMS)
+        .map(|_| udp::OutgoingDatagram {
+            data: vec![0xa5; DATAGRAM_SIZE],
+            remote_address: Some(addr.into()),
+        })
+        .collect::<Vec<_>>();
+
+    let mut group = c.benchmark_group("udp");
+    group.throughput(Throughput::Bytes((DATAGRAMS * DATAGRAM_SIZE) as u64));
+    group.bench_function(format!("loopback-{DATAGRAMS}x{DATAGRAM_SIZE}"), |b| {
+        b.iter(|| {
+            let mut sent = 0;
+            while sent < DATAGRAMS {
+                let permit = ctx.check_send(borrow(&sender)).unwrap() as usize;
+                let n = permit.min(DATAGRAMS - sent);
+                if n > 0 {
+                    sent += ctx
+                        .send(borrow(&sender), datagrams[sent..sent + n].to_vec())
+                        .unwrap() as usize;
+                }
+            }
+            let mut received = 0;
+            while received < DATAGRAMS {
+                received += ctx
+                    .receive(borrow(&receiver), DATAGRAMS as u64)
+                    .unwrap()
+                    .len();
+            }
+        })
+    });
+    group.finish();
+}
+
+/// Create a socket bound to an ephemeral loopback port, returning its
+/// unconnected datagram streams and the address it's bound to.
+fn bind(
+    ctx: &mut Ctx,
+    network: &Resource<Network>,
+) -> (
+    (
+        Resource<udp::IncomingDatagramStream>,
+        Resource<udp::OutgoingDatagramStream>,
+    ),
+    SocketAddr,
+) {
+    let socket = ctx.create_udp_socket(IpAddressFamily::Ipv4).unwrap();
+    let local = SocketAddr::from((Ipv4Addr::LOCALHOST, 0));
+    ctx.start_bind(borrow(&socket), borrow(network), local.into())
+        .unwrap();
+    ctx.finish_bind(borrow(&socket)).unwrap();
+    let streams = ctx.stream(borrow(&socket), None).unwrap();
+    let addr = ctx.local_address(borrow(&socket)).unwrap().into();
+    (streams, addr)
+}
+
+fn borrow<T: 'static>(resource: &Resource<T>) -> Resource<T> {
+    Resource::new_borrow(resource.rep())
+}
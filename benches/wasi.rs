@@ -18,6 +18,15 @@ fn bench_wasi(c: &mut Criterion) {
         file.set_len(4096).unwrap();
     }
 
+    // Build a copy of it a few directories down for benchmarking path
+    // resolution.
+    let nested_file = Path::new("benches/wasi/nested/a/b/c/d/test.bin");
+    if !nested_file.is_file() {
+        std::fs::create_dir_all(nested_file.parent().unwrap()).unwrap();
+        let file = File::create(nested_file).unwrap();
+        file.set_len(4096).unwrap();
+    }
+
     // Benchmark each `*.wat` file in the `wasi` directory.
     for file in std::fs::read_dir("benches/wasi").unwrap() {
         let path = file.unwrap().path();
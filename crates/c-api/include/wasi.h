@@ -9,6 +9,7 @@
 
 #include "wasm.h"
 #include <stdint.h>
+#include <wasmtime/error.h>
 
 #ifndef WASI_API_EXTERN
 #ifdef _WIN32
@@ -111,6 +112,46 @@ WASI_API_EXTERN bool wasi_config_set_stdin_file(wasi_config_t *config,
 WASI_API_EXTERN void wasi_config_set_stdin_bytes(wasi_config_t *config,
                                                  wasm_byte_vec_t *binary);
 
+/**
+ * \brief Callback used to read input for a WASI program.
+ *
+ * The first argument is the `data` pointer given when the callback was
+ * configured. The callback should fill in up to `len` bytes at `buf` and
+ * return how many were written, return 0 at the end of input, or return a
+ * negative value to report an I/O error to the program.
+ */
+typedef intptr_t (*wasi_input_callback_t)(void *data, uint8_t *buf,
+                                          size_t len);
+
+/**
+ * \brief Configures standard input to be pulled from a callback.
+ *
+ * The callback is invoked each time the WASI program reads from stdin, on
+ * whichever thread is running it, so input is produced on demand rather than
+ * being buffered up front.
+ *
+ * The `finalizer`, if not `NULL`, is called with `data` when the callback is
+ * no longer in use.
+ */
+WASI_API_EXTERN void
+wasi_config_set_stdin_callback(wasi_config_t *config,
+                               wasi_input_callback_t callback, void *data,
+                               void (*finalizer)(void *));
+
+/**
+ * \brief Configures standard input to be read from borrowed memory.
+ *
+ * Unlike #wasi_config_set_stdin_bytes the `len` bytes at `buf` are not copied.
+ * They are read directly by the WASI program, and so must remain valid and
+ * unmodified until they are released. Once the span can no longer be read,
+ * because `config` or the store it was configured into was deleted,
+ * `finalizer` is called with `data` if it isn't `NULL`.
+ */
+WASI_API_EXTERN void wasi_config_set_stdin_span(wasi_config_t *config,
+                                                const uint8_t *buf, size_t len,
+                                                void *data,
+                                                void (*finalizer)(void *));
+
 /**
  * \brief Configures this process's own stdin stream to be used as stdin for
  * this WASI configuration.
@@ -153,6 +194,101 @@ WASI_API_EXTERN bool wasi_config_set_stderr_file(wasi_config_t *config,
  */
 WASI_API_EXTERN void wasi_config_inherit_stderr(wasi_config_t *config);
 
+/**
+ * \brief Callback invoked with output written by a WASI program.
+ *
+ * The first argument is the `data` pointer given when the callback was
+ * configured, followed by a pointer to the bytes written and their length.
+ * The bytes are only valid for the duration of the call.
+ */
+typedef void (*wasi_output_callback_t)(void *data, const uint8_t *buf,
+                                       size_t len);
+
+/**
+ * \brief Configures standard output to be passed to a callback.
+ *
+ * Each write the WASI program makes to stdout is passed to `callback`, along
+ * with `data`, without any intermediate buffering. The callback is invoked on
+ * whichever thread is running the WASI program.
+ *
+ * The `finalizer`, if not `NULL`, is called with `data` when the callback is
+ * no longer in use, either because `config` was deleted or because the store
+ * it was configured into was deleted.
+ */
+WASI_API_EXTERN void
+wasi_config_set_stdout_callback(wasi_config_t *config,
+                                wasi_output_callback_t callback, void *data,
+                                void (*finalizer)(void *));
+
+/**
+ * \brief Configures standard error to be passed to a callback.
+ *
+ * This is the same as #wasi_config_set_stdout_callback except for stderr.
+ */
+WASI_API_EXTERN void
+wasi_config_set_stderr_callback(wasi_config_t *config,
+                                wasi_output_callback_t callback, void *data,
+                                void (*finalizer)(void *));
+
+/**
+ * \typedef wasi_ring_buffer_t
+ * \brief Convenience alias for #wasi_ring_buffer_t
+ *
+ * \struct wasi_ring_buffer_t
+ * \brief A bounded in-memory buffer capturing output of a WASI program.
+ *
+ * Once the buffer is full the oldest bytes are discarded to make room for new
+ * ones, so it always holds the most recent output.
+ *
+ * \fn void wasi_ring_buffer_delete(wasi_ring_buffer_t *);
+ * \brief Deletes a ring buffer.
+ *
+ * Configurations and stores the buffer was configured into keep their own
+ * reference to it, so it may be deleted at any time.
+ */
+WASI_DECLARE_OWN(ring_buffer)
+
+/**
+ * \brief Creates a new ring buffer holding at most `capacity` bytes.
+ */
+WASI_API_EXTERN own wasi_ring_buffer_t *wasi_ring_buffer_new(size_t capacity);
+
+/**
+ * \brief Reads and removes the oldest bytes held in a ring buffer.
+ *
+ * Copies up to `len` bytes into `buf` and returns the number of bytes copied,
+ * which is zero if the buffer is empty. This may be called concurrently with
+ * a WASI program writing to the buffer.
+ */
+WASI_API_EXTERN size_t wasi_ring_buffer_read(wasi_ring_buffer_t *buffer,
+                                             uint8_t *buf, size_t len);
+
+/**
+ * \brief Returns the total number of bytes discarded because the ring buffer
+ * was full.
+ */
+WASI_API_EXTERN uint64_t
+wasi_ring_buffer_overwritten(const wasi_ring_buffer_t *buffer);
+
+/**
+ * \brief Configures standard output to be captured in a ring buffer.
+ *
+ * The `buffer` is not consumed; it can be shared between configurations and
+ * read from while the WASI program runs.
+ */
+WASI_API_EXTERN void
+wasi_config_set_stdout_ring_buffer(wasi_config_t *config,
+                                   const wasi_ring_buffer_t *buffer);
+
+/**
+ * \brief Configures standard error to be captured in a ring buffer.
+ *
+ * This is the same as #wasi_config_set_stdout_ring_buffer except for stderr.
+ */
+WASI_API_EXTERN void
+wasi_config_set_stderr_ring_buffer(wasi_config_t *config,
+                                   const wasi_ring_buffer_t *buffer);
+
 /**
  * \brief Configures a "preopened directory" to be available to WASI APIs.
  *
@@ -183,6 +319,47 @@ WASI_API_EXTERN bool wasi_config_preopen_socket(wasi_config_t *config,
                                                 uint32_t fd_num,
                                                 const char *host_port);
 
+/**
+ * \typedef wasi_ctx_template_t
+ * \brief Convenience alias for #wasi_ctx_template_t
+ *
+ * \struct wasi_ctx_template_t
+ * \brief A WASI configuration which has been set up once to be used by many
+ * stores.
+ *
+ * Templates are created with #wasi_ctx_template_new and applied to stores
+ * with #wasmtime_context_set_wasi_template. Applying a template doesn't
+ * reopen any files or directories, so it's much cheaper than creating and
+ * applying a #wasi_config_t for each store. A template may be applied from
+ * multiple threads concurrently.
+ *
+ * Stores configured from the same template share open files, directories,
+ * and sockets much like forked processes do: for example the position of a
+ * shared stdout file is shared. Stdin given with
+ * #wasi_config_set_stdin_bytes or #wasi_config_set_stdin_span is the
+ * exception, and is read from the start in each store.
+ *
+ * \fn void wasi_ctx_template_delete(wasi_ctx_template_t *);
+ * \brief Deletes a template.
+ */
+WASI_DECLARE_OWN(ctx_template)
+
+/**
+ * \brief Creates a template from a WASI configuration.
+ *
+ * This takes ownership of `config`, opening everything it refers to. The
+ * caller should no longer use `config` after calling this function (even if
+ * an error is returned).
+ *
+ * On success `NULL` is returned and the new template is stored in `out`.
+ * Otherwise an error is returned describing why the configuration is
+ * invalid, for example if its arguments or environment aren't valid UTF-8,
+ * and `out` is left untouched.
+ */
+WASI_API_EXTERN wasmtime_error_t *
+wasi_ctx_template_new(own wasi_config_t *config,
+                      own wasi_ctx_template_t **out);
+
 #undef own
 
 #ifdef __cplusplus
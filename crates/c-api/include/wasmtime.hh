@@ -0,0 +1,1294 @@
+/**
+ * \file wasmtime.hh
+ *
+ * \brief C++ API for Wasmtime
+ *
+ * This header is a header-only C++17 layer on top of the C API in
+ * \ref wasmtime.h. It provides RAII wrappers for engines, stores, modules,
+ * linkers and instances, along with statically typed functions:
+ *
+ * ```cpp
+ * #include <wasmtime.hh>
+ *
+ * using namespace wasmtime;
+ *
+ * Engine engine;
+ * Store store(engine);
+ * Module module = Module::compile(engine, "(module ...)").unwrap();
+ *
+ * Linker linker(engine);
+ * linker.func_wrap("host", "double", [](int32_t x) { return x * 2; }).unwrap();
+ * Instance instance = linker.instantiate(store, module).unwrap();
+ *
+ * auto run = instance.get_typed_func<int64_t(int32_t, double)>(store, "run")
+ *                .unwrap();
+ * int64_t result = run.call(store, 1, 2.0).unwrap();
+ * ```
+ *
+ * Typed functions check their signature once when they're created, and calls
+ * afterwards go through #wasmtime_func_call_unchecked with arguments and
+ * results stored in an array of #wasmtime_val_raw_t whose size is known at
+ * compile time. Host functions are similarly defined with
+ * #wasmtime_func_new_unchecked and a trampoline generated for the signature of
+ * the C++ callable, so neither direction involves #wasmtime_val_t.
+ *
+ * The supported value types are `int32_t`, `uint32_t`, `int64_t`, `uint64_t`,
+ * `float` and `double`. Functions with no results use `void`, and functions
+ * with multiple results use `std::tuple`.
+ *
+ * When compiled as C++20, asynchronous calls and instantiation return a
+ * #wasmtime::CallFuture which may be awaited with `co_await`, and asynchronous
+ * host functions may be written as coroutines returning a #wasmtime::HostTask:
+ *
+ * ```cpp
+ * linker.func_wrap_async("host", "fetch", [](int32_t id) -> HostTask<int32_t> {
+ *   co_return co_await fetch_from_network(id);
+ * }).unwrap();
+ *
+ * Task<void> handle(Store &store, TypedFunc<int32_t(int32_t)> run) {
+ *   Result<int32_t> result = co_await run.call_async(store, 1).on(executor);
+ * }
+ * ```
+ *
+ * This header does not use exceptions. Fallible operations instead return a
+ * #wasmtime::Result, and host functions may return a #wasmtime::Result to
+ * raise a trap.
+ */
+
+#ifndef WASMTIME_HH
+#define WASMTIME_HH
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define WASMTIME_HH_COROUTINES
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#endif
+
+#include <wasmtime.h>
+
+namespace wasmtime {
+
+namespace detail {
+
+template <typename T, void (*Delete)(T *)> struct deleter {
+  void operator()(T *ptr) const { Delete(ptr); }
+};
+
+template <typename T, void (*Delete)(T *)>
+using owned = std::unique_ptr<T, deleter<T, Delete>>;
+
+} // namespace detail
+
+/**
+ * \brief An error from Wasmtime, either a #wasmtime_error_t or a trap.
+ */
+class Error {
+  detail::owned<wasmtime_error_t, wasmtime_error_delete> error_;
+  detail::owned<wasm_trap_t, wasm_trap_delete> trap_;
+
+public:
+  /// Takes ownership of an error returned by the C API.
+  explicit Error(wasmtime_error_t *error) : error_(error) {}
+  /// Takes ownership of a trap returned by the C API.
+  explicit Error(wasm_trap_t *trap) : trap_(trap) {}
+  /// Creates a new error with the given message.
+  explicit Error(const std::string &message)
+      : error_(wasmtime_error_new(message.c_str())) {}
+
+  /// Returns whether this error is a trap raised while executing wasm.
+  bool is_trap() const { return trap_ != nullptr; }
+
+  /// Returns the trap code of this error, if it's a trap with a code.
+  std::optional<wasmtime_trap_code_t> trap_code() const {
+    wasmtime_trap_code_t code;
+    if (trap_ && wasmtime_trap_code(trap_.get(), &code))
+      return code;
+    return std::nullopt;
+  }
+
+  /// Returns the message of this error, or an empty string if it has been
+  /// moved from.
+  std::string message() const {
+    wasm_byte_vec_t raw;
+    if (trap_) {
+      wasm_trap_message(trap_.get(), &raw);
+    } else if (error_) {
+      wasmtime_error_message(error_.get(), &raw);
+    } else {
+      return std::string();
+    }
+    std::string message(raw.data, raw.size);
+    wasm_byte_vec_delete(&raw);
+    // Trap messages include a trailing nul byte.
+    if (!message.empty() && message.back() == '\0')
+      message.pop_back();
+    return message;
+  }
+
+  /// Converts this error into a trap owned by the caller, for returning from
+  /// host functions.
+  wasm_trap_t *release_trap() {
+    if (trap_)
+      return trap_.release();
+    std::string message = this->message();
+    return wasmtime_trap_new(message.data(), message.size());
+  }
+};
+
+/**
+ * \brief Either a successful `T` or an #Error.
+ *
+ * Operations which don't produce a value use `Result<std::monostate>`.
+ */
+template <typename T> class [[nodiscard]] Result {
+  std::variant<T, Error> data_;
+
+public:
+  /// Creates a successful result.
+  Result(T ok) : data_(std::move(ok)) {}
+  /// Creates a failed result.
+  Result(Error err) : data_(std::move(err)) {}
+
+  /// Returns whether this result is successful.
+  explicit operator bool() const { return data_.index() == 0; }
+
+  /// Returns the successful value; this result must be successful.
+  T &ok() { return std::get<0>(data_); }
+  /// Returns the error; this result must have failed.
+  Error &err() { return std::get<1>(data_); }
+
+  /// Returns the successful value, or prints the error and aborts.
+  T unwrap() {
+    if (!*this) {
+      std::fprintf(stderr, "error: %s\n", err().message().c_str());
+      std::abort();
+    }
+    return std::move(ok());
+  }
+};
+
+namespace detail {
+
+inline Result<std::monostate> check(wasmtime_error_t *error) {
+  if (error)
+    return Error(error);
+  return std::monostate();
+}
+
+inline Result<std::monostate> check(wasmtime_error_t *error,
+                                    wasm_trap_t *trap) {
+  if (error)
+    return Error(error);
+  if (trap)
+    return Error(trap);
+  return std::monostate();
+}
+
+/// Mapping of C++ types to wasm value types and their slot in a
+/// #wasmtime_val_raw_t or #wasmtime_val_t.
+template <typename T> struct WasmType;
+
+#define WASMTIME_HH_TYPE(ty, kind_, val_kind, field)                           \
+  template <> struct WasmType<ty> {                                            \
+    static constexpr wasm_valkind_t kind = kind_;                              \
+    static void store(wasmtime_val_raw_t *raw, ty value) {                     \
+      raw->field = static_cast<decltype(raw->field)>(value);                   \
+    }                                                                          \
+    static ty load(const wasmtime_val_raw_t *raw) {                            \
+      return static_cast<ty>(raw->field);                                      \
+    }                                                                          \
+    static void store(wasmtime_val_t *val, ty value) {                         \
+      val->kind = val_kind;                                                    \
+      val->of.field = static_cast<decltype(val->of.field)>(value);             \
+    }                                                                          \
+    static ty load(const wasmtime_val_t *val) {                                \
+      return static_cast<ty>(val->of.field);                                   \
+    }                                                                          \
+  };
+
+WASMTIME_HH_TYPE(int32_t, WASM_I32, WASMTIME_I32, i32)
+WASMTIME_HH_TYPE(uint32_t, WASM_I32, WASMTIME_I32, i32)
+WASMTIME_HH_TYPE(int64_t, WASM_I64, WASMTIME_I64, i64)
+WASMTIME_HH_TYPE(uint64_t, WASM_I64, WASMTIME_I64, i64)
+WASMTIME_HH_TYPE(float, WASM_F32, WASMTIME_F32, f32)
+WASMTIME_HH_TYPE(double, WASM_F64, WASMTIME_F64, f64)
+
+#undef WASMTIME_HH_TYPE
+
+template <typename... Ts> bool valtypes_match(const wasm_valtype_vec_t *types) {
+  if (types->size != sizeof...(Ts))
+    return false;
+  size_t i = 0;
+  (void)i;
+  return (... &&
+          (wasm_valtype_kind(types->data[i++]) == WasmType<Ts>::kind));
+}
+
+template <typename... Ts> void valtypes_new(wasm_valtype_vec_t *out) {
+  wasm_valtype_t *types[] = {wasm_valtype_new(WasmType<Ts>::kind)..., nullptr};
+  wasm_valtype_vec_new(out, sizeof...(Ts), types);
+}
+
+/// Mapping of a C++ result type to the wasm results of a function: `void` for
+/// none, a value type for one, or a `std::tuple` of value types for several.
+template <typename T> struct WasmResults {
+  using type = T;
+  static constexpr size_t count = 1;
+  static bool matches(const wasm_valtype_vec_t *types) {
+    return valtypes_match<T>(types);
+  }
+  static void types(wasm_valtype_vec_t *out) { valtypes_new<T>(out); }
+  template <typename Slot> static T load(const Slot *slots) {
+    return WasmType<T>::load(slots);
+  }
+  template <typename Slot> static void store(Slot *slots, const T &value) {
+    WasmType<T>::store(slots, value);
+  }
+};
+
+template <> struct WasmResults<std::monostate> {
+  using type = std::monostate;
+  static constexpr size_t count = 0;
+  static bool matches(const wasm_valtype_vec_t *types) {
+    return valtypes_match<>(types);
+  }
+  static void types(wasm_valtype_vec_t *out) { valtypes_new<>(out); }
+  template <typename Slot> static std::monostate load(const Slot *) {
+    return {};
+  }
+  template <typename Slot> static void store(Slot *, std::monostate) {}
+};
+
+template <> struct WasmResults<void> : WasmResults<std::monostate> {};
+
+template <typename... Ts> struct WasmResults<std::tuple<Ts...>> {
+  using type = std::tuple<Ts...>;
+  static constexpr size_t count = sizeof...(Ts);
+  static bool matches(const wasm_valtype_vec_t *types) {
+    return valtypes_match<Ts...>(types);
+  }
+  static void types(wasm_valtype_vec_t *out) { valtypes_new<Ts...>(out); }
+  template <typename Slot> static type load(const Slot *slots) {
+    return load(slots, std::index_sequence_for<Ts...>());
+  }
+  template <typename Slot> static void store(Slot *slots, const type &value) {
+    store(slots, value, std::index_sequence_for<Ts...>());
+  }
+
+private:
+  template <typename Slot, size_t... I>
+  static type load(const Slot *slots, std::index_sequence<I...>) {
+    return type(WasmType<Ts>::load(&slots[I])...);
+  }
+  template <typename Slot, size_t... I>
+  static void store(Slot *slots, const type &value, std::index_sequence<I...>) {
+    (WasmType<Ts>::store(&slots[I], std::get<I>(value)), ...);
+  }
+};
+
+template <typename R, typename... Params>
+wasm_functype_t *functype_new() {
+  wasm_valtype_vec_t params, results;
+  valtypes_new<Params...>(&params);
+  WasmResults<R>::types(&results);
+  return wasm_functype_new(&params, &results);
+}
+
+constexpr size_t max(size_t a, size_t b) { return a > b ? a : b; }
+
+} // namespace detail
+
+class Store;
+
+/**
+ * \brief Configuration for an #Engine.
+ *
+ * The underlying #wasm_config_t is available through #capi for use with the
+ * `wasmtime_config_*` functions.
+ */
+class Config {
+  friend class Engine;
+  detail::owned<wasm_config_t, wasm_config_delete> ptr_;
+
+public:
+  /// Creates a new default configuration.
+  Config() : ptr_(wasm_config_new()) {}
+
+  /// Returns the underlying C API pointer.
+  wasm_config_t *capi() { return ptr_.get(); }
+};
+
+/**
+ * \brief Global compilation state, see #wasm_engine_t.
+ */
+class Engine {
+  detail::owned<wasm_engine_t, wasm_engine_delete> ptr_;
+
+public:
+  /// Creates a new engine with the default configuration.
+  Engine() : ptr_(wasm_engine_new()) {}
+  /// Creates a new engine with the given configuration.
+  explicit Engine(Config config)
+      : ptr_(wasm_engine_new_with_config(config.ptr_.release())) {}
+
+  /// Returns the underlying C API pointer.
+  wasm_engine_t *capi() const { return ptr_.get(); }
+};
+
+/**
+ * \brief A store owning wasm instances and their state, see
+ * #wasmtime_store_t.
+ */
+class Store {
+  detail::owned<wasmtime_store_t, wasmtime_store_delete> ptr_;
+
+public:
+  /**
+   * \brief A borrowed view of a store, see #wasmtime_context_t.
+   *
+   * Functions taking a `Store::Context` also accept a `Store &`.
+   */
+  class Context {
+    wasmtime_context_t *ptr_;
+
+  public:
+    /// Wraps a context from the C API.
+    Context(wasmtime_context_t *ptr) : ptr_(ptr) {}
+    /// Borrows the context of a store.
+    Context(Store &store) : Context(store.context()) {}
+
+    /// Returns the underlying C API pointer.
+    wasmtime_context_t *capi() const { return ptr_; }
+
+    /// Runs a garbage collection of `externref`s in this store.
+    void gc() { wasmtime_context_gc(ptr_); }
+
+    /// Configures whether traps capture backtraces, see
+    /// #wasmtime_context_set_wasm_backtrace.
+    void set_wasm_backtrace(bool enable) {
+      wasmtime_context_set_wasm_backtrace(ptr_, enable);
+    }
+
+    /// Sets the fuel of this store, see #wasmtime_context_set_fuel.
+    Result<std::monostate> set_fuel(uint64_t fuel) {
+      return detail::check(wasmtime_context_set_fuel(ptr_, fuel));
+    }
+
+    /// Returns the fuel of this store, see #wasmtime_context_get_fuel.
+    Result<uint64_t> get_fuel() const {
+      uint64_t fuel = 0;
+      wasmtime_error_t *error = wasmtime_context_get_fuel(ptr_, &fuel);
+      if (error)
+        return Error(error);
+      return fuel;
+    }
+  };
+
+  /// Creates a new store within the given engine.
+  explicit Store(Engine &engine)
+      : ptr_(wasmtime_store_new(engine.capi(), nullptr, nullptr)) {}
+
+  /// Returns the context of this store.
+  Context context() { return wasmtime_store_context(ptr_.get()); }
+
+  /// Returns the underlying C API pointer.
+  wasmtime_store_t *capi() const { return ptr_.get(); }
+};
+
+/**
+ * \brief A compiled wasm module, see #wasmtime_module_t.
+ *
+ * Copying a module is cheap and shares the compiled code.
+ */
+class Module {
+  detail::owned<wasmtime_module_t, wasmtime_module_delete> ptr_;
+
+  explicit Module(wasmtime_module_t *raw) : ptr_(raw) {}
+
+public:
+  /// Shares the compiled code of `other`.
+  Module(const Module &other) : ptr_(wasmtime_module_clone(other.ptr_.get())) {}
+  /// Shares the compiled code of `other`.
+  Module &operator=(const Module &other) {
+    ptr_.reset(wasmtime_module_clone(other.ptr_.get()));
+    return *this;
+  }
+  /// Moves a module.
+  Module(Module &&) = default;
+  /// Moves a module.
+  Module &operator=(Module &&) = default;
+
+  /// Compiles a module from the wasm binary `wasm`.
+  static Result<Module> compile(Engine &engine, const uint8_t *wasm,
+                                size_t len) {
+    wasmtime_module_t *raw = nullptr;
+    wasmtime_error_t *error = wasmtime_module_new(engine.capi(), wasm, len, &raw);
+    if (error)
+      return Error(error);
+    return Module(raw);
+  }
+
+  /// Compiles a module from the text format `wat`.
+  static Result<Module> compile(Engine &engine, std::string_view wat) {
+    wasm_byte_vec_t wasm;
+    wasmtime_error_t *error = wasmtime_wat2wasm(wat.data(), wat.size(), &wasm);
+    if (error)
+      return Error(error);
+    auto ret = compile(engine, reinterpret_cast<const uint8_t *>(wasm.data),
+                       wasm.size);
+    wasm_byte_vec_delete(&wasm);
+    return ret;
+  }
+
+  /// Returns the underlying C API pointer.
+  wasmtime_module_t *capi() const { return ptr_.get(); }
+};
+
+/**
+ * \brief The context of a host function call, see #wasmtime_caller_t.
+ *
+ * This is only valid for the duration of the host call it was passed to.
+ */
+class Caller {
+  wasmtime_caller_t *ptr_;
+
+public:
+  /// Wraps a caller from the C API.
+  explicit Caller(wasmtime_caller_t *ptr) : ptr_(ptr) {}
+
+  /// Returns the context of the store the call is happening in.
+  Store::Context context() const { return wasmtime_caller_context(ptr_); }
+
+  /// Looks up the memory exported as `name` from the calling instance.
+  std::optional<wasmtime_memory_t> get_memory(std::string_view name) const {
+    wasmtime_extern_t item;
+    if (!wasmtime_caller_export_get(ptr_, name.data(), name.size(), &item))
+      return std::nullopt;
+    std::optional<wasmtime_memory_t> ret;
+    if (item.kind == WASMTIME_EXTERN_MEMORY)
+      ret = item.of.memory;
+    wasmtime_extern_delete(&item);
+    return ret;
+  }
+
+  /// Returns the underlying C API pointer.
+  wasmtime_caller_t *capi() const { return ptr_; }
+};
+
+namespace detail {
+
+/// Argument and result types of a C++ callable.
+template <typename F>
+struct FuncTraits : FuncTraits<decltype(&F::operator())> {};
+
+template <typename R, typename... Args> struct FuncTraits<R (*)(Args...)> {
+  using result = R;
+  using args = std::tuple<Args...>;
+};
+
+template <typename C, typename R, typename... Args>
+struct FuncTraits<R (C::*)(Args...)> : FuncTraits<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct FuncTraits<R (C::*)(Args...) const> : FuncTraits<R (*)(Args...)> {};
+
+/// Strips a `Result` returned by a fallible host function.
+template <typename R> struct HostResult {
+  using type = R;
+};
+
+template <typename R> struct HostResult<Result<R>> {
+  using type = R;
+};
+
+/// The trampoline for a host function `F`, with wasm parameters `Params`
+/// following an optional leading `Caller`.
+template <typename F, typename R, bool WithCaller, typename... Params>
+struct HostFunc {
+  using Results = WasmResults<typename HostResult<R>::type>;
+
+  static wasm_functype_t *type() {
+    return functype_new<typename HostResult<R>::type, Params...>();
+  }
+
+  static wasm_trap_t *invoke(void *env, wasmtime_caller_t *caller,
+                             wasmtime_val_raw_t *args_and_results, size_t) {
+    return dispatch(*static_cast<F *>(env), Caller(caller), args_and_results,
+                    std::index_sequence_for<Params...>());
+  }
+
+  static void finalize(void *env) { delete static_cast<F *>(env); }
+
+private:
+  template <size_t... I>
+  static R call(F &f, Caller caller, const wasmtime_val_raw_t *raw,
+                std::index_sequence<I...>) {
+    (void)caller;
+    (void)raw;
+    if constexpr (WithCaller) {
+      return f(caller, WasmType<Params>::load(&raw[I])...);
+    } else {
+      return f(WasmType<Params>::load(&raw[I])...);
+    }
+  }
+
+  template <size_t... I>
+  static wasm_trap_t *dispatch(F &f, Caller caller, wasmtime_val_raw_t *raw,
+                               std::index_sequence<I...> params) {
+    if constexpr (std::is_void_v<R>) {
+      call(f, caller, raw, params);
+    } else if constexpr (std::is_same_v<R, typename HostResult<R>::type>) {
+      Results::store(raw, call(f, caller, raw, params));
+    } else {
+      R result = call(f, caller, raw, params);
+      if (!result)
+        return result.err().release_trap();
+      Results::store(raw, result.ok());
+    }
+    return nullptr;
+  }
+};
+
+template <typename F, typename R, typename Args> struct HostFuncFor;
+
+template <typename F, typename R, typename... Params>
+struct HostFuncFor<F, R, std::tuple<Params...>> {
+  using type = HostFunc<F, R, false, Params...>;
+};
+
+template <typename F, typename R, typename... Params>
+struct HostFuncFor<F, R, std::tuple<Caller, Params...>> {
+  using type = HostFunc<F, R, true, Params...>;
+};
+
+template <typename F>
+using host_func_t = typename HostFuncFor<F, typename FuncTraits<F>::result,
+                                         typename FuncTraits<F>::args>::type;
+
+} // namespace detail
+
+#ifdef WASMTIME_HH_COROUTINES
+
+namespace detail {
+
+/// The state of an asynchronous call, shared between its #CallFuture, the
+/// waker registered with the underlying #wasmtime_call_future_t, and any work
+/// posted to an executor on its behalf.
+class AsyncCall : public std::enable_shared_from_this<AsyncCall> {
+  enum : uint8_t { Idle, Scheduled, Polling, Notified, Done };
+
+  std::atomic<uint8_t> state_{Idle};
+  std::coroutine_handle<> waiter_;
+  void *executor_ = nullptr;
+  void (*post_)(void *executor, std::shared_ptr<AsyncCall> call) = nullptr;
+
+public:
+  wasmtime_call_future_t *future = nullptr;
+  wasm_trap_t *trap = nullptr;
+  wasmtime_error_t *error = nullptr;
+
+  virtual ~AsyncCall() {
+    cancel();
+    if (trap)
+      wasm_trap_delete(trap);
+    if (error)
+      wasmtime_error_delete(error);
+  }
+
+  /// Deletes the underlying future, releasing everything it borrows.
+  void cancel() {
+    if (future) {
+      wasmtime_call_future_delete(future);
+      future = nullptr;
+    }
+  }
+
+  template <typename Executor> void set_executor(Executor &executor) {
+    executor_ = &executor;
+    post_ = [](void *target, std::shared_ptr<AsyncCall> call) {
+      static_cast<Executor *>(target)->execute(
+          [call = std::move(call)] { call->run(); });
+    };
+  }
+
+  /// Polls the future for the first time on behalf of `waiter`, returning
+  /// whether `waiter` should stay suspended.
+  bool start(std::coroutine_handle<> waiter) {
+    waiter_ = waiter;
+    wasmtime_call_future_set_waker(
+        future, on_wake, new std::shared_ptr<AsyncCall>(shared_from_this()),
+        on_finalize);
+    state_.store(Polling, std::memory_order_release);
+    return !drive();
+  }
+
+private:
+  static void on_wake(void *env) {
+    (*static_cast<std::shared_ptr<AsyncCall> *>(env))->notify();
+  }
+
+  static void on_finalize(void *env) {
+    delete static_cast<std::shared_ptr<AsyncCall> *>(env);
+  }
+
+  void notify() {
+    uint8_t state = state_.load(std::memory_order_acquire);
+    for (;;) {
+      uint8_t next;
+      if (state == Idle)
+        next = Scheduled;
+      else if (state == Polling)
+        next = Notified;
+      else
+        return;
+      if (state_.compare_exchange_weak(state, next, std::memory_order_acq_rel,
+                                       std::memory_order_acquire))
+        break;
+    }
+    if (state != Idle)
+      return;
+    if (post_)
+      post_(executor_, shared_from_this());
+    else
+      run();
+  }
+
+  void run() {
+    state_.store(Polling, std::memory_order_release);
+    if (drive())
+      waiter_.resume();
+  }
+
+  /// Polls the future until it completes, returning true, or until it's
+  /// either waiting to be woken or has been posted back to the executor,
+  /// returning false.
+  bool drive() {
+    for (;;) {
+      if (!future)
+        return false;
+      if (wasmtime_call_future_poll(future)) {
+        state_.store(Done, std::memory_order_release);
+        return true;
+      }
+      uint8_t polling = Polling;
+      if (state_.compare_exchange_strong(polling, Idle,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire))
+        return false;
+
+      // Woken while polling, typically by a fuel or epoch yield. Let the
+      // executor run something else before polling again.
+      if (post_) {
+        state_.store(Scheduled, std::memory_order_release);
+        post_(executor_, shared_from_this());
+        return false;
+      }
+      state_.store(Polling, std::memory_order_release);
+    }
+  }
+};
+
+/// An #AsyncCall along with the arguments, results and other values its
+/// future borrows.
+template <typename Storage> struct AsyncCallWith : AsyncCall {
+  Storage storage;
+
+  template <typename... Args>
+  explicit AsyncCallWith(Args &&...args) : storage{std::forward<Args>(args)...} {}
+};
+
+} // namespace detail
+
+/**
+ * \brief An asynchronous call, awaitable from a C++20 coroutine.
+ *
+ * Awaiting this suspends the coroutine until the call completes, producing a
+ * #Result. A waker is registered with the underlying #wasmtime_call_future_t,
+ * so the future is only polled again once it can make progress.
+ *
+ * By default the future is polled, and the awaiting coroutine resumed, on
+ * whichever thread wakes it. Use #on to instead do so on an executor, which
+ * is also where polling continues after fuel or epoch yields.
+ *
+ * Asynchronous host functions that use a polled
+ * #wasmtime_func_async_continuation_callback_t never wake the future, so calls
+ * which may reach them can't be awaited. Host functions defined with
+ * #Linker::func_wrap_async complete through a #wasmtime_async_completion_t and
+ * don't have this restriction.
+ *
+ * Everything the call borrows must stay alive, and a coroutine awaiting the
+ * call must not be destroyed while it's suspended. Destroying the future
+ * before it completes cancels the call. Host coroutines which the call is
+ * waiting on still run to completion, but their results are discarded.
+ */
+template <typename T> class [[nodiscard]] CallFuture {
+  std::shared_ptr<detail::AsyncCall> call_;
+  T (*load_)(detail::AsyncCall &);
+
+public:
+  /// Wraps a call whose results are read with `load` once it completes.
+  CallFuture(std::shared_ptr<detail::AsyncCall> call,
+             T (*load)(detail::AsyncCall &))
+      : call_(std::move(call)), load_(load) {}
+  /// Moves a future.
+  CallFuture(CallFuture &&) = default;
+  CallFuture &operator=(CallFuture &&) = delete;
+
+  ~CallFuture() {
+    if (call_)
+      call_->cancel();
+  }
+
+  /**
+   * \brief Polls this future on `executor` instead of on the waking thread.
+   *
+   * `Executor` is any type with an `execute` method taking a nullary callable,
+   * such as an Asio executor. It must outlive this future.
+   */
+  template <typename Executor> CallFuture &&on(Executor &executor) && {
+    call_->set_executor(executor);
+    return std::move(*this);
+  }
+
+  /// \private
+  bool await_ready() const noexcept { return false; }
+  /// \private
+  bool await_suspend(std::coroutine_handle<> waiter) {
+    return call_->start(waiter);
+  }
+  /// \private
+  Result<T> await_resume() {
+    call_->cancel();
+    if (call_->error)
+      return Error(std::exchange(call_->error, nullptr));
+    if (call_->trap)
+      return Error(std::exchange(call_->trap, nullptr));
+    return load_(*call_);
+  }
+};
+
+template <typename R = void> class HostTask;
+
+namespace detail {
+
+struct HostPromiseBase {
+  wasmtime_async_completion_t *completion = nullptr;
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename P> void await_suspend(std::coroutine_handle<P> h) noexcept {
+      // Results have been written by now, so destroy the coroutine and then
+      // let wasm continue.
+      wasmtime_async_completion_t *completion = h.promise().completion;
+      h.destroy();
+      wasmtime_async_completion_signal(completion);
+      wasmtime_async_completion_delete(completion);
+    }
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() { std::terminate(); }
+};
+
+template <typename T> struct HostPromise : HostPromiseBase {
+  void return_value(Result<T> result) {
+    // Results go to storage owned by the completion, which is valid even if
+    // the call was cancelled while this coroutine was suspended, but there's
+    // no use in storing them then.
+    if (wasmtime_async_completion_is_cancelled(completion))
+      return;
+    if (result)
+      WasmResults<T>::store(wasmtime_async_completion_results(completion),
+                            result.ok());
+    else
+      wasmtime_async_completion_set_trap(completion,
+                                         result.err().release_trap());
+  }
+};
+
+template <> struct HostPromise<void> : HostPromiseBase {
+  void return_void() {}
+};
+
+/// The trampoline for an asynchronous host function `F` producing `T`.
+template <typename F, typename T, bool WithCaller, typename... Params>
+struct AsyncHostFunc {
+  static wasm_functype_t *type() { return functype_new<T, Params...>(); }
+
+  static void invoke(void *env, wasmtime_caller_t *caller,
+                     const wasmtime_val_t *args, size_t, wasmtime_val_t *,
+                     size_t, wasm_trap_t **,
+                     wasmtime_async_continuation_t *continuation_ret) {
+    auto handle = call(*static_cast<F *>(env), Caller(caller), args,
+                       std::index_sequence_for<Params...>())
+                      .release();
+    handle.promise().completion =
+        wasmtime_async_continuation_completion(continuation_ret);
+    handle.resume();
+  }
+
+  static void finalize(void *env) { delete static_cast<F *>(env); }
+
+private:
+  template <size_t... I>
+  static HostTask<T> call(F &f, Caller caller, const wasmtime_val_t *args,
+                          std::index_sequence<I...>) {
+    (void)caller;
+    (void)args;
+    if constexpr (WithCaller) {
+      return f(caller, WasmType<Params>::load(&args[I])...);
+    } else {
+      return f(WasmType<Params>::load(&args[I])...);
+    }
+  }
+};
+
+template <typename F, typename R, typename Args> struct AsyncHostFuncFor;
+
+template <typename F, typename T, typename... Params>
+struct AsyncHostFuncFor<F, HostTask<T>, std::tuple<Params...>> {
+  using type = AsyncHostFunc<F, T, false, Params...>;
+};
+
+template <typename F, typename T, typename... Params>
+struct AsyncHostFuncFor<F, HostTask<T>, std::tuple<Caller, Params...>> {
+  using type = AsyncHostFunc<F, T, true, Params...>;
+};
+
+template <typename F>
+using async_host_func_t =
+    typename AsyncHostFuncFor<F, typename FuncTraits<F>::result,
+                              typename FuncTraits<F>::args>::type;
+
+} // namespace detail
+
+/**
+ * \brief The return type of an asynchronous host function written as a C++20
+ * coroutine, see #Linker::func_wrap_async.
+ *
+ * The coroutine starts running when wasm calls it, and wasm is suspended until
+ * the coroutine finishes with `co_return`. `R` is the wasm result type as for
+ * synchronous host functions, and for non-`void` results the coroutine may
+ * `co_return` an #Error to raise a trap instead. Use `HostTask<std::monostate>`
+ * for a function without results which may trap.
+ *
+ * The #Caller is only valid until the coroutine first suspends.
+ */
+template <typename R> class [[nodiscard]] HostTask {
+public:
+  /// \private
+  struct promise_type : detail::HostPromise<R> {
+    HostTask get_return_object() {
+      return HostTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+  };
+
+  /// Moves a task.
+  HostTask(HostTask &&other) : handle_(std::exchange(other.handle_, {})) {}
+  HostTask &operator=(HostTask &&) = delete;
+
+  ~HostTask() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  /// \private
+  std::coroutine_handle<promise_type> release() {
+    return std::exchange(handle_, {});
+  }
+
+private:
+  explicit HostTask(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+#endif // WASMTIME_HH_COROUTINES
+
+template <typename Sig> class TypedFunc;
+
+/**
+ * \brief A wasm function, see #wasmtime_func_t.
+ */
+class Func {
+  wasmtime_func_t func_;
+
+public:
+  /// Wraps a function from the C API.
+  Func(wasmtime_func_t func) : func_(func) {}
+
+  /**
+   * \brief Creates a host function within `cx` which calls `f`.
+   *
+   * The wasm signature is derived from the signature of `f`, which may take a
+   * #Caller as its first argument. `f` may return a #Result to raise a trap.
+   */
+  template <typename F> static Func wrap(Store::Context cx, F f) {
+    using Host = detail::host_func_t<F>;
+    wasm_functype_t *ty = Host::type();
+    wasmtime_func_t func;
+    wasmtime_func_new_unchecked(cx.capi(), ty, Host::invoke,
+                                new F(std::move(f)), Host::finalize, &func);
+    wasm_functype_delete(ty);
+    return func;
+  }
+
+  /**
+   * \brief Returns a typed view of this function.
+   *
+   * This fails if the signature of this function doesn't match `Sig`.
+   */
+  template <typename Sig>
+  Result<TypedFunc<Sig>> typed(Store::Context cx) const {
+    if (!TypedFunc<Sig>::matches(cx, *this))
+      return Error(std::string("function signature mismatch"));
+    return TypedFunc<Sig>(*this);
+  }
+
+  /// Returns the underlying C API value.
+  const wasmtime_func_t &capi() const { return func_; }
+};
+
+/**
+ * \brief A wasm function with a signature checked at creation.
+ *
+ * Create one with #Func::typed or #Instance::get_typed_func.
+ */
+template <typename R, typename... Params> class TypedFunc<R(Params...)> {
+  friend class Func;
+
+  using Results = detail::WasmResults<R>;
+
+  Func func_;
+
+  explicit TypedFunc(Func func) : func_(func) {}
+
+  static bool matches(Store::Context cx, const Func &func) {
+    wasm_functype_t *ty = wasmtime_func_type(cx.capi(), &func.capi());
+    bool ret = detail::valtypes_match<Params...>(wasm_functype_params(ty)) &&
+               Results::matches(wasm_functype_results(ty));
+    wasm_functype_delete(ty);
+    return ret;
+  }
+
+public:
+  /// The value produced by a successful call.
+  using result_type = typename Results::type;
+
+  /// Calls this function with `params`.
+  Result<result_type> call(Store::Context cx, Params... params) const {
+    constexpr size_t len = detail::max(sizeof...(Params), Results::count);
+    std::array<wasmtime_val_raw_t, detail::max(len, 1)> raw;
+    size_t i = 0;
+    (void)i;
+    (detail::WasmType<Params>::store(&raw[i++], params), ...);
+    wasm_trap_t *trap = nullptr;
+    wasmtime_error_t *error = wasmtime_func_call_unchecked(
+        cx.capi(), &func_.capi(), raw.data(), len, &trap);
+    if (error)
+      return Error(error);
+    if (trap)
+      return Error(trap);
+    return Results::load(raw.data());
+  }
+
+#ifdef WASMTIME_HH_COROUTINES
+  /**
+   * \brief Calls this function asynchronously with `params`, see
+   * #wasmtime_func_call_async.
+   *
+   * The store must be configured for async support, and no other calls may be
+   * made on it until the returned future completes or is destroyed.
+   */
+  CallFuture<result_type> call_async(Store::Context cx,
+                                     Params... params) const {
+    struct Storage {
+      wasmtime_func_t func;
+      std::array<wasmtime_val_t, sizeof...(Params)> args = {};
+      std::array<wasmtime_val_t, Results::count> results = {};
+    };
+    using Call = detail::AsyncCallWith<Storage>;
+    auto call = std::make_shared<Call>(func_.capi());
+    Storage &s = call->storage;
+    size_t i = 0;
+    (void)i;
+    (detail::WasmType<Params>::store(&s.args[i++], params), ...);
+    call->future = wasmtime_func_call_async(
+        cx.capi(), &s.func, s.args.data(), s.args.size(), s.results.data(),
+        s.results.size(), &call->trap, &call->error);
+    return CallFuture<result_type>(
+        std::move(call), [](detail::AsyncCall &c) -> result_type {
+          return Results::load(static_cast<Call &>(c).storage.results.data());
+        });
+  }
+#endif
+
+  /// Returns the untyped function.
+  const Func &func() const { return func_; }
+};
+
+/**
+ * \brief An instance of a wasm module, see #wasmtime_instance_t.
+ */
+class Instance {
+  wasmtime_instance_t instance_;
+
+public:
+  /// Wraps an instance from the C API.
+  Instance(wasmtime_instance_t instance) : instance_(instance) {}
+
+  /// Instantiates `module` with the given imports, see
+  /// #wasmtime_instance_new.
+  static Result<Instance> create(Store::Context cx, const Module &module,
+                                 const std::vector<wasmtime_extern_t> &imports) {
+    wasmtime_instance_t instance;
+    wasm_trap_t *trap = nullptr;
+    auto result = detail::check(
+        wasmtime_instance_new(cx.capi(), module.capi(), imports.data(),
+                              imports.size(), &instance, &trap),
+        trap);
+    if (!result)
+      return std::move(result.err());
+    return Instance(instance);
+  }
+
+  /// Looks up the function exported as `name`.
+  std::optional<Func> get_func(Store::Context cx, std::string_view name) const {
+    wasmtime_extern_t item;
+    if (!wasmtime_instance_export_get(cx.capi(), &instance_, name.data(),
+                                      name.size(), &item))
+      return std::nullopt;
+    std::optional<Func> ret;
+    if (item.kind == WASMTIME_EXTERN_FUNC)
+      ret = Func(item.of.func);
+    wasmtime_extern_delete(&item);
+    return ret;
+  }
+
+  /// Looks up the memory exported as `name`.
+  std::optional<wasmtime_memory_t> get_memory(Store::Context cx,
+                                              std::string_view name) const {
+    wasmtime_extern_t item;
+    if (!wasmtime_instance_export_get(cx.capi(), &instance_, name.data(),
+                                      name.size(), &item))
+      return std::nullopt;
+    std::optional<wasmtime_memory_t> ret;
+    if (item.kind == WASMTIME_EXTERN_MEMORY)
+      ret = item.of.memory;
+    wasmtime_extern_delete(&item);
+    return ret;
+  }
+
+  /// Looks up the function exported as `name` and checks that its signature
+  /// is `Sig`.
+  template <typename Sig>
+  Result<TypedFunc<Sig>> get_typed_func(Store::Context cx,
+                                        std::string_view name) const {
+    std::optional<Func> func = get_func(cx, name);
+    if (!func)
+      return Error("failed to find function export `" + std::string(name) +
+                   "`");
+    return func->template typed<Sig>(cx);
+  }
+
+  /// Returns the underlying C API value.
+  const wasmtime_instance_t &capi() const { return instance_; }
+};
+
+/**
+ * \brief A module with its imports resolved by a #Linker, ready to be
+ * instantiated, see #wasmtime_instance_pre_t.
+ *
+ * Copies share the same underlying #wasmtime_instance_pre_t.
+ */
+class InstancePre {
+  std::shared_ptr<wasmtime_instance_pre_t> ptr_;
+
+public:
+  /// Takes ownership of an instance pre from the C API.
+  explicit InstancePre(wasmtime_instance_pre_t *raw)
+      : ptr_(raw, wasmtime_instance_pre_delete) {}
+
+  /// Instantiates the module within `store`.
+  Result<Instance> instantiate(Store &store) const {
+    wasmtime_instance_t instance;
+    wasm_trap_t *trap = nullptr;
+    auto result = detail::check(wasmtime_instance_pre_instantiate(
+                                    ptr_.get(), store.capi(), &instance, &trap),
+                                trap);
+    if (!result)
+      return std::move(result.err());
+    return Instance(instance);
+  }
+
+#ifdef WASMTIME_HH_COROUTINES
+  /// Instantiates the module within `cx` asynchronously, see
+  /// #wasmtime_instance_pre_instantiate_async.
+  CallFuture<Instance> instantiate_async(Store::Context cx) const {
+    struct Storage {
+      std::shared_ptr<wasmtime_instance_pre_t> pre;
+      wasmtime_instance_t instance = {};
+    };
+    using Call = detail::AsyncCallWith<Storage>;
+    auto call = std::make_shared<Call>(ptr_);
+    call->future = wasmtime_instance_pre_instantiate_async(
+        ptr_.get(), cx.capi(), &call->storage.instance, &call->trap,
+        &call->error);
+    return CallFuture<Instance>(
+        std::move(call), [](detail::AsyncCall &c) -> Instance {
+          return static_cast<Call &>(c).storage.instance;
+        });
+  }
+#endif
+
+  /// Returns the underlying C API pointer.
+  wasmtime_instance_pre_t *capi() const { return ptr_.get(); }
+};
+
+/**
+ * \brief Definitions used to instantiate modules, see #wasmtime_linker_t.
+ */
+class Linker {
+  detail::owned<wasmtime_linker_t, wasmtime_linker_delete> ptr_;
+
+public:
+  /// Creates a new empty linker for modules compiled with `engine`.
+  explicit Linker(Engine &engine) : ptr_(wasmtime_linker_new(engine.capi())) {}
+
+  /// Configures whether later definitions may shadow earlier ones.
+  void allow_shadowing(bool allow) {
+    wasmtime_linker_allow_shadowing(ptr_.get(), allow);
+  }
+
+  /// Defines `item` as `module::name`.
+  Result<std::monostate> define(Store::Context cx, std::string_view module,
+                                std::string_view name,
+                                const wasmtime_extern_t &item) {
+    return detail::check(wasmtime_linker_define(ptr_.get(), cx.capi(),
+                                                module.data(), module.size(),
+                                                name.data(), name.size(), &item));
+  }
+
+  /// Defines the exports of `instance` under the module name `name`.
+  Result<std::monostate> define_instance(Store::Context cx,
+                                         std::string_view name,
+                                         const Instance &instance) {
+    return detail::check(wasmtime_linker_define_instance(
+        ptr_.get(), cx.capi(), name.data(), name.size(), &instance.capi()));
+  }
+
+  /// Defines WASI functions, see #wasmtime_linker_define_wasi.
+  Result<std::monostate> define_wasi() {
+    return detail::check(wasmtime_linker_define_wasi(ptr_.get()));
+  }
+
+  /**
+   * \brief Defines a host function `module::name` which calls `f`.
+   *
+   * This is the store-independent analog of #Func::wrap.
+   */
+  template <typename F>
+  Result<std::monostate> func_wrap(std::string_view module,
+                                   std::string_view name, F f) {
+    using Host = detail::host_func_t<F>;
+    wasm_functype_t *ty = Host::type();
+    wasmtime_error_t *error = wasmtime_linker_define_func_unchecked(
+        ptr_.get(), module.data(), module.size(), name.data(), name.size(), ty,
+        Host::invoke, new F(std::move(f)), Host::finalize);
+    wasm_functype_delete(ty);
+    return detail::check(error);
+  }
+
+  /// Instantiates `module` with the definitions in this linker.
+  Result<Instance> instantiate(Store::Context cx, const Module &module) const {
+    wasmtime_instance_t instance;
+    wasm_trap_t *trap = nullptr;
+    auto result = detail::check(wasmtime_linker_instantiate(
+                                    ptr_.get(), cx.capi(), module.capi(),
+                                    &instance, &trap),
+                                trap);
+    if (!result)
+      return std::move(result.err());
+    return Instance(instance);
+  }
+
+  /// Resolves the imports of `module` ahead of time, see
+  /// #wasmtime_linker_instantiate_pre.
+  Result<InstancePre> instantiate_pre(const Module &module) const {
+    wasmtime_instance_pre_t *raw = nullptr;
+    auto result = detail::check(
+        wasmtime_linker_instantiate_pre(ptr_.get(), module.capi(), &raw));
+    if (!result)
+      return std::move(result.err());
+    return InstancePre(raw);
+  }
+
+#ifdef WASMTIME_HH_COROUTINES
+  /**
+   * \brief Defines an asynchronous host function `module::name` which calls
+   * the coroutine `f`, see #wasmtime_linker_define_async_func.
+   *
+   * `f` takes the same arguments as for #func_wrap and returns a #HostTask.
+   * Wasm is suspended while the coroutine is, and resumes once it finishes.
+   */
+  template <typename F>
+  Result<std::monostate> func_wrap_async(std::string_view module,
+                                         std::string_view name, F f) {
+    using Host = detail::async_host_func_t<F>;
+    wasm_functype_t *ty = Host::type();
+    wasmtime_error_t *error = wasmtime_linker_define_async_func(
+        ptr_.get(), module.data(), module.size(), name.data(), name.size(), ty,
+        Host::invoke, new F(std::move(f)), Host::finalize);
+    wasm_functype_delete(ty);
+    return detail::check(error);
+  }
+
+  /**
+   * \brief Instantiates `module` asynchronously, see
+   * #wasmtime_linker_instantiate_async.
+   *
+   * This linker must outlive the returned future.
+   */
+  CallFuture<Instance> instantiate_async(Store::Context cx,
+                                         const Module &module) const {
+    struct Storage {
+      Module module;
+      wasmtime_instance_t instance = {};
+    };
+    using Call = detail::AsyncCallWith<Storage>;
+    auto call = std::make_shared<Call>(module);
+    call->future = wasmtime_linker_instantiate_async(
+        ptr_.get(), cx.capi(), call->storage.module.capi(),
+        &call->storage.instance, &call->trap, &call->error);
+    return CallFuture<Instance>(
+        std::move(call), [](detail::AsyncCall &c) -> Instance {
+          return static_cast<Call &>(c).storage.instance;
+        });
+  }
+#endif
+
+  /// Returns the underlying C API pointer.
+  wasmtime_linker_t *capi() const { return ptr_.get(); }
+};
+
+} // namespace wasmtime
+
+#endif // WASMTIME_HH
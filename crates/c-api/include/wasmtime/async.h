@@ -17,16 +17,24 @@
  * stack until the function returns or yields control back to the caller.
  *
  * It's expected these futures are pulled in a loop until completed, at which
- * point the future should be deleted. Functions that return a
- * #wasmtime_call_future_t are special in that all parameters to that function
- * should not be modified in any way and must be kept alive until the future is
- * deleted. This includes concurrent calls for a single store - another function
- * on a store should not be called while there is a #wasmtime_call_future_t
- * alive.
+ * point the future should be deleted. Rather than polling continuously, a
+ * waker may be registered with #wasmtime_call_future_set_waker, in which case
+ * the future only needs to be polled again once the waker has been invoked.
+ * C++20 coroutines can instead `co_await` the futures returned by the API in
+ * \ref wasmtime.hh.
+ *
+ * Functions that return a #wasmtime_call_future_t are special in that all
+ * parameters to that function should not be modified in any way and must be
+ * kept alive until the future is deleted. This includes concurrent calls for a
+ * single store - another function on a store should not be called while there
+ * is a #wasmtime_call_future_t alive.
  *
  * As for asynchronous host calls - the reverse contract is upheld. Wasmtime
  * will keep all parameters to the function alive and unmodified until the
- * #wasmtime_func_async_continuation_callback_t returns true.
+ * #wasmtime_func_async_continuation_callback_t returns true. Alternatively a
+ * host function may complete through a #wasmtime_async_completion_t created
+ * with #wasmtime_async_continuation_completion, which wakes the calling future
+ * rather than requiring it to be polled.
  *
  */
 
@@ -132,6 +140,88 @@ typedef struct wasmtime_async_continuation_t {
   void (*finalizer)(void *);
 } wasmtime_async_continuation_t;
 
+/**
+ * \brief A handle used to signal completion of an asynchronous host function.
+ *
+ * Created with #wasmtime_async_continuation_completion and owned by the caller,
+ * it must be deleted with #wasmtime_async_completion_delete.
+ */
+typedef struct wasmtime_async_completion wasmtime_async_completion_t;
+
+/**
+ * \brief Configures a continuation to complete when signaled.
+ *
+ * This is intended to be called from within a #wasmtime_func_async_callback_t
+ * on its `continuation_ret` argument, replacing the need for a polled
+ * #wasmtime_func_async_continuation_callback_t. The host function completes
+ * once #wasmtime_async_completion_signal is called on the returned handle, at
+ * which point the waker of the calling #wasmtime_call_future_t, if any, is
+ * invoked.
+ *
+ * The handle owns the storage for the host function's results and trap, which
+ * are written with #wasmtime_async_completion_results and
+ * #wasmtime_async_completion_set_trap before signaling. The `results` and
+ * `trap_ret` arguments of the host function aren't used once it has created a
+ * completion, as they belong to the call and are freed if the call's future is
+ * deleted before the host function completes. The handle's storage stays valid
+ * until the handle is deleted, so the host may always write to it, even after
+ * the call has been cancelled.
+ *
+ * The returned handle is owned by the caller and must be deleted with
+ * #wasmtime_async_completion_delete, which may happen before or after it is
+ * signaled.
+ */
+WASM_API_EXTERN wasmtime_async_completion_t *
+wasmtime_async_continuation_completion(
+    wasmtime_async_continuation_t *continuation);
+
+/**
+ * \brief Signals that the asynchronous host function associated with
+ * `completion` has completed.
+ *
+ * This may be called from any thread. Calling this more than once has no
+ * further effect.
+ */
+WASM_API_EXTERN void
+wasmtime_async_completion_signal(const wasmtime_async_completion_t *completion);
+
+/**
+ * \brief Returns the storage for the results of the asynchronous host function
+ * associated with `completion`.
+ *
+ * The storage holds as many values as the host function has results, and must
+ * not be written to after `completion` has been signaled.
+ */
+WASM_API_EXTERN wasmtime_val_t *wasmtime_async_completion_results(
+    const wasmtime_async_completion_t *completion);
+
+/**
+ * \brief Makes the asynchronous host function associated with `completion`
+ * trap with `trap` once it completes.
+ *
+ * Ownership of `trap` is transferred to the completion. This must not be called
+ * after `completion` has been signaled.
+ */
+WASM_API_EXTERN void wasmtime_async_completion_set_trap(
+    const wasmtime_async_completion_t *completion, wasm_trap_t *trap);
+
+/**
+ * \brief Returns whether the call waiting on `completion` has been cancelled.
+ *
+ * This becomes true once the #wasmtime_call_future_t of the call is deleted
+ * before `completion` is signaled, after which any results are discarded. The
+ * host may use this to abandon work early, but needn't check it before writing
+ * results, as the completion's storage is valid regardless.
+ */
+WASM_API_EXTERN bool wasmtime_async_completion_is_cancelled(
+    const wasmtime_async_completion_t *completion);
+
+/**
+ * \brief Deletes a completion handle.
+ */
+WASM_API_EXTERN void
+wasmtime_async_completion_delete(wasmtime_async_completion_t *completion);
+
 /**
  * \brief Callback signature for #wasmtime_linker_define_async_func.
  *
@@ -194,6 +284,36 @@ typedef struct wasmtime_call_future wasmtime_call_future_t;
  */
 WASM_API_EXTERN bool wasmtime_call_future_poll(wasmtime_call_future_t *future);
 
+/**
+ * \brief Callback invoked when a #wasmtime_call_future_t is ready to make
+ * progress when polled.
+ */
+typedef void (*wasmtime_call_future_wake_callback_t)(void *env);
+
+/**
+ * \brief Registers a waker for a future.
+ *
+ * Once registered, `wake` is invoked whenever the future may be able to make
+ * progress, such as when an asynchronous host function completes through a
+ * #wasmtime_async_completion_t or when execution yields due to fuel or epochs.
+ * Until then there's no need to call #wasmtime_call_future_poll again, allowing
+ * an event loop to park instead of polling continuously.
+ *
+ * The `wake` callback may be invoked from any thread, may be invoked
+ * spuriously, and may be invoked during #wasmtime_call_future_poll itself. Its
+ * `env` may outlive the future as wakers can be retained by completion handles,
+ * and `finalizer` is run once all references to it are gone. Registering a new
+ * waker replaces the previous one.
+ *
+ * Note that asynchronous host functions using a polled
+ * #wasmtime_func_async_continuation_callback_t never invoke the waker, so
+ * futures which may call them must still be polled periodically.
+ */
+WASM_API_EXTERN void
+wasmtime_call_future_set_waker(wasmtime_call_future_t *future,
+                               wasmtime_call_future_wake_callback_t wake,
+                               void *env, void (*finalizer)(void *));
+
 /**
  * /brief Frees the underlying memory for a future.
  *
@@ -292,6 +412,66 @@ WASM_API_EXTERN wasmtime_call_future_t *wasmtime_instance_pre_instantiate_async(
     wasmtime_instance_t *instance, wasm_trap_t **trap_ret,
     wasmtime_error_t **error_ret);
 
+/**
+ * \brief A pool of threads which runs #wasmtime_call_future_t to completion.
+ *
+ * Each worker thread has its own run queue and idle workers steal work from
+ * each other, so many stores' calls can make progress concurrently without the
+ * embedder writing its own scheduler. Futures spawned onto an executor are
+ * polled only when woken, and are requeued behind other runnable futures when
+ * they yield. To time-slice long-running WebAssembly, configure its store with
+ * #wasmtime_context_epoch_deadline_async_yield_and_update or
+ * #wasmtime_context_fuel_async_yield_interval.
+ *
+ * Note that futures which call asynchronous host functions using a polled
+ * #wasmtime_func_async_continuation_callback_t are only polled again when
+ * something wakes them, so such host functions should complete through a
+ * #wasmtime_async_completion_t instead.
+ */
+typedef struct wasmtime_executor wasmtime_executor_t;
+
+/**
+ * \brief Creates a new executor with `num_threads` worker threads.
+ *
+ * If `num_threads` is zero then one thread is created per available CPU. The
+ * returned executor must be deleted with #wasmtime_executor_delete.
+ */
+WASM_API_EXTERN wasmtime_executor_t *wasmtime_executor_new(size_t num_threads);
+
+/**
+ * \brief Deletes an executor.
+ *
+ * This stops and joins all worker threads. Futures which haven't completed are
+ * cancelled and deleted without invoking their `on_complete` callback.
+ */
+WASM_API_EXTERN void wasmtime_executor_delete(wasmtime_executor_t *executor);
+
+/**
+ * \brief Runs a future to completion on an executor.
+ *
+ * \param executor the executor to run `future` on.
+ * \param future the future to run, ownership of which is transferred to the
+ *        executor. The future is deleted once it completes.
+ * \param weight the number of times the future may be polled in a row when it
+ *        yields before other futures get a turn, which allows prioritizing some
+ *        stores over others. A weight of zero is treated as one.
+ * \param on_complete an optional callback invoked with `data` on a worker
+ *        thread after the future completes and has been deleted, at which
+ *        point its results may be read.
+ * \param data user-provided data passed to `on_complete`.
+ * \param finalizer an optional finalizer for `data`.
+ *
+ * The future may be polled from any of the executor's threads, so everything
+ * it references (including its store) must not be used from other threads
+ * until it completes.
+ */
+WASM_API_EXTERN void wasmtime_executor_spawn(wasmtime_executor_t *executor,
+                                             wasmtime_call_future_t *future,
+                                             uint32_t weight,
+                                             void (*on_complete)(void *data),
+                                             void *data,
+                                             void (*finalizer)(void *));
+
 /**
  * A callback to get the top of the stack address and the length of the stack,
  * excluding guard pages.
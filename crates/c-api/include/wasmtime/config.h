@@ -109,6 +109,17 @@ WASMTIME_CONFIG_PROP(void, debug_info, bool)
  */
 WASMTIME_CONFIG_PROP(void, consume_fuel, bool)
 
+/**
+ * \brief Whether or not a core dump is captured when WebAssembly traps.
+ *
+ * This setting is `false` by default. When enabled the #wasm_trap_t returned
+ * from a trapping call carries a core dump of the store which can be written
+ * out with #wasmtime_trap_coredump_write.
+ *
+ * This option requires the `coredump` feature of the C API.
+ */
+WASMTIME_CONFIG_PROP(void, coredump_on_trap, bool)
+
 /**
  * \brief Whether or not epoch-based interruption is enabled for generated code.
  *
@@ -311,6 +322,17 @@ WASMTIME_CONFIG_PROP(void, dynamic_memory_guard_size, uint64_t)
  */
 WASMTIME_CONFIG_PROP(void, dynamic_memory_reserved_for_growth, uint64_t)
 
+/**
+ * \brief Configures whether the space reserved for growth of a “dynamic”
+ * memory scales with the size of the memory when it's relocated.
+ *
+ * This option defaults to false.
+ *
+ * For more information see the Rust documentation at
+ * https://docs.wasmtime.dev/api/wasmtime/struct.Config.html#method.dynamic_memory_growth_geometric
+ */
+WASMTIME_CONFIG_PROP(void, dynamic_memory_growth_geometric, bool)
+
 /**
  * \brief Configures whether to generate native unwind information (e.g.
  * .eh_frame on Linux).
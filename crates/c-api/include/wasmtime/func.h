@@ -9,6 +9,7 @@
 
 #include <wasm.h>
 #include <wasmtime/extern.h>
+#include <wasmtime/module.h>
 #include <wasmtime/store.h>
 #include <wasmtime/val.h>
 
@@ -146,6 +147,57 @@ WASM_API_EXTERN void wasmtime_func_new_unchecked(
     wasmtime_func_unchecked_callback_t callback, void *env,
     void (*finalizer)(void *), wasmtime_func_t *ret);
 
+/**
+ * \brief Callback signature for #wasmtime_func_new_native.
+ *
+ * This is a placeholder type: the callback is actually invoked with the native
+ * signature declared by the type given to #wasmtime_func_new_native, see there
+ * for more information.
+ */
+typedef void (*wasmtime_func_native_callback_t)(void);
+
+/**
+ * \brief Creates a new host function whose callback has a native C signature.
+ *
+ * Rather than receiving its parameters and producing its results through an
+ * array as with #wasmtime_func_new and #wasmtime_func_new_unchecked, the
+ * `callback` is invoked directly with the signature described by `type`. For
+ * example a function of type `(param i32 i64) (result i32)` must have the
+ * signature:
+ *
+ * ```c
+ * int32_t callback(void *env, wasmtime_caller_t *caller, int32_t a, int64_t b);
+ * ```
+ *
+ * Arguments are passed to the callback in registers following the platform's
+ * calling convention, making calls from WebAssembly faster than with the other
+ * kinds of host functions. Callbacks raise traps with #wasmtime_caller_trap.
+ *
+ * Only a limited set of signatures is supported: up to four `i32` or `i64`
+ * parameters, and either no result or a single `i32` or `i64` result. An error
+ * is returned for other signatures, in which case `finalizer` is invoked on
+ * `env` before returning.
+ *
+ * It's up to the caller to ensure that `callback` actually has the signature
+ * described by `type`, otherwise behavior is undefined.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_func_new_native(
+    wasmtime_context_t *store, const wasm_functype_t *type,
+    wasmtime_func_native_callback_t callback, void *env,
+    void (*finalizer)(void *), wasmtime_func_t *ret);
+
+/**
+ * \brief Raises a trap from a host function created with
+ * #wasmtime_func_new_native.
+ *
+ * The trap is raised once the host function returns, at which point its
+ * return value is ignored. Ownership of `trap` is transferred to `caller`.
+ * Other kinds of host functions return their traps instead, and traps set
+ * through this function are ignored for them.
+ */
+WASM_API_EXTERN void wasmtime_caller_trap(wasmtime_caller_t *caller,
+                                          wasm_trap_t *trap);
+
 /**
  * \brief Returns the type of the function specified
  *
@@ -254,6 +306,20 @@ WASM_API_EXTERN bool wasmtime_caller_export_get(wasmtime_caller_t *caller,
                                                 size_t name_len,
                                                 wasmtime_extern_t *item);
 
+/**
+ * \brief Loads a #wasmtime_extern_t looked up ahead of time from the caller's
+ * context.
+ *
+ * This is the same as #wasmtime_caller_export_get except that `export_` was
+ * found with #wasmtime_module_export_index, so there's no need to look it up
+ * by name on each call. Returns `false` if there's no caller instance or if
+ * `export_` was looked up in a module other than the caller's.
+ */
+WASM_API_EXTERN bool
+wasmtime_caller_export_get_by_index(wasmtime_caller_t *caller,
+                                    const wasmtime_module_export_t *export_,
+                                    wasmtime_extern_t *item);
+
 /**
  * \brief Returns the store context of the caller object.
  */
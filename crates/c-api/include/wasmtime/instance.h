@@ -87,6 +87,25 @@ WASM_API_EXTERN bool wasmtime_instance_export_get(
     wasmtime_context_t *store, const wasmtime_instance_t *instance,
     const char *name, size_t name_len, wasmtime_extern_t *item);
 
+/**
+ * \brief Get an export looked up ahead of time from an instance.
+ *
+ * \param store the store that owns `instance`
+ * \param instance the instance to get the export from
+ * \param export_ the export, found with #wasmtime_module_export_index
+ * \param item where to store the export
+ *
+ * \return `true` if the export was found, or `false` if `export_` was looked
+ * up in a module other than the one `instance` was instantiated from.
+ *
+ * This is the same as #wasmtime_instance_export_get except that it doesn't
+ * need to look up the export by name. The returned item must be deleted with
+ * #wasmtime_extern_delete.
+ */
+WASM_API_EXTERN bool wasmtime_instance_export_get_by_index(
+    wasmtime_context_t *store, const wasmtime_instance_t *instance,
+    const wasmtime_module_export_t *export_, wasmtime_extern_t *item);
+
 /**
  * \brief Get an export by index from an instance.
  *
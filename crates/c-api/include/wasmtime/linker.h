@@ -124,6 +124,20 @@ WASM_API_EXTERN wasmtime_error_t *wasmtime_linker_define_func_unchecked(
     wasmtime_func_unchecked_callback_t cb, void *data,
     void (*finalizer)(void *));
 
+/**
+ * \brief Defines a new function in this linker.
+ *
+ * This is the same as #wasmtime_linker_define_func except that it's the analog
+ * of #wasmtime_func_new_native instead of #wasmtime_func_new. Be sure to
+ * consult the documentation of #wasmtime_func_new_native for the signatures
+ * which are supported. If an error is returned then `finalizer` has already
+ * been invoked on `data`.
+ */
+WASM_API_EXTERN wasmtime_error_t *wasmtime_linker_define_func_native(
+    wasmtime_linker_t *linker, const char *module, size_t module_len,
+    const char *name, size_t name_len, const wasm_functype_t *ty,
+    wasmtime_func_native_callback_t cb, void *data, void (*finalizer)(void *));
+
 /**
  * \brief Defines WASI functions in this linker.
  *
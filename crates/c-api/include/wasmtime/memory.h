@@ -109,6 +109,46 @@ WASM_API_EXTERN wasmtime_error_t *
 wasmtime_memory_grow(wasmtime_context_t *store, const wasmtime_memory_t *memory,
                      uint64_t delta, uint64_t *prev_size);
 
+/**
+ * \brief A region of linear memory as seen by the host.
+ *
+ * This has the same layout as POSIX `struct iovec` so arrays of it may be
+ * passed directly to functions such as `readv` and `writev`.
+ */
+typedef struct wasmtime_iovec {
+  /// Host pointer to the start of the region.
+  void *base;
+  /// Length of the region, in bytes.
+  size_t len;
+} wasmtime_iovec_t;
+
+/**
+ * \brief Resolves an array of guest iovecs to host pointers in one step.
+ *
+ * \param store the store that owns `memory`
+ * \param memory the memory that both the iovec array and the buffers it
+ *        describes reside in
+ * \param iovs the guest address of an array of `count` WASI-style iovecs, each
+ *        a pair of little-endian 32-bit buffer address and buffer length
+ * \param count the number of iovecs to resolve
+ * \param out where to store the `count` resolved host iovecs
+ *
+ * This validates that the iovec array and every buffer it describes are
+ * in-bounds of `memory` and fills in `out` with host pointers directly into
+ * linear memory, suitable for zero-copy vectored I/O such as `preadv` or
+ * `recvmsg`. If any of them are out-of-bounds then an error representing a
+ * #WASMTIME_TRAP_CODE_MEMORY_OUT_OF_BOUNDS trap is returned and the contents
+ * of `out` are unspecified.
+ *
+ * The returned pointers are invalidated by anything that may grow `memory`,
+ * such as calling back into WebAssembly (see
+ * #wasmtime_context_memory_generation).
+ */
+WASM_API_EXTERN wasmtime_error_t *
+wasmtime_memory_iovecs(const wasmtime_context_t *store,
+                       const wasmtime_memory_t *memory, uint64_t iovs,
+                       size_t count, wasmtime_iovec_t *out);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
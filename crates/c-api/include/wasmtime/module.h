@@ -69,6 +69,37 @@ WASM_API_EXTERN void wasmtime_module_imports(const wasmtime_module_t *module,
 WASM_API_EXTERN void wasmtime_module_exports(const wasmtime_module_t *module,
                                              wasm_exporttype_vec_t *out);
 
+/**
+ * \typedef wasmtime_module_export_t
+ * \brief Convenience alias for #wasmtime_module_export
+ *
+ * \struct wasmtime_module_export
+ * \brief An export of a #wasmtime_module_t which has been looked up ahead of
+ * time.
+ *
+ * This can be used with #wasmtime_instance_export_get_by_index and
+ * #wasmtime_caller_export_get_by_index to get the export from instances of
+ * the module without looking it up by name each time.
+ */
+typedef struct wasmtime_module_export wasmtime_module_export_t;
+
+/**
+ * \brief Looks up the export named `name` in `module`.
+ *
+ * Returns `NULL` if the module has no such export or if `name` is not valid
+ * UTF-8. Otherwise the returned handle is owned by the caller and must be
+ * deleted with #wasmtime_module_export_delete.
+ */
+WASM_API_EXTERN wasmtime_module_export_t *
+wasmtime_module_export_index(const wasmtime_module_t *module, const char *name,
+                             size_t name_len);
+
+/**
+ * \brief Deletes a #wasmtime_module_export_t.
+ */
+WASM_API_EXTERN void
+wasmtime_module_export_delete(wasmtime_module_export_t *export_);
+
 /**
  * \brief Validate a WebAssembly binary.
  *
@@ -113,6 +113,34 @@ WASM_API_EXTERN void wasmtime_store_limiter(wasmtime_store_t *store,
                                             int64_t instances, int64_t tables,
                                             int64_t memories);
 
+/**
+ * \brief Configures a callback invoked whenever a linear memory in this store
+ * grows.
+ *
+ * \param store the store to configure.
+ * \param func the callback to invoke, which receives `data`, or `NULL` to
+ * remove the current callback.
+ * \param data user-provided data passed to `func`.
+ * \param finalizer an optional finalizer for `data`.
+ *
+ * Growing a linear memory may move its base pointer in addition to changing
+ * its size, so this callback can be used to invalidate any cached results of
+ * #wasmtime_memory_data and #wasmtime_memory_data_size. The callback runs after
+ * the new base and size are visible, both for `memory.grow` executed by
+ * WebAssembly and for #wasmtime_memory_grow called by the host. It is not
+ * invoked for shared memories, whose base never changes.
+ *
+ * The callback must not call back into this store. Replacing or removing the
+ * callback runs the finalizer of the previous one. The counter returned by
+ * #wasmtime_context_memory_generation is maintained either way.
+ *
+ * See also #wasmtime_context_memory_generation.
+ */
+WASM_API_EXTERN void
+wasmtime_store_memory_grow_callback(wasmtime_store_t *store,
+                                    void (*func)(void *data), void *data,
+                                    void (*finalizer)(void *));
+
 /**
  * \brief Deletes a store.
  */
@@ -145,6 +173,19 @@ WASM_API_EXTERN void wasmtime_context_set_data(wasmtime_context_t *context,
  */
 WASM_API_EXTERN void wasmtime_context_gc(wasmtime_context_t *context);
 
+/**
+ * \brief Configures whether backtraces are captured when wasm in this
+ * context's store traps.
+ *
+ * Backtraces are captured by default. When disabled, traps don't walk the
+ * stack and #wasmtime_error_wasm_trace and #wasm_trap_trace return empty
+ * traces. When enabled, function names and
+ * source locations are only resolved once a trace's frames are inspected, so
+ * checking #wasmtime_trap_code alone stays cheap either way.
+ */
+WASM_API_EXTERN void
+wasmtime_context_set_wasm_backtrace(wasmtime_context_t *context, bool enable);
+
 /**
  * \brief Set fuel to this context's store for wasm to consume while executing.
  *
@@ -175,6 +216,22 @@ wasmtime_context_set_fuel(wasmtime_context_t *store, uint64_t fuel);
 WASM_API_EXTERN wasmtime_error_t *
 wasmtime_context_get_fuel(const wasmtime_context_t *context, uint64_t *fuel);
 
+/**
+ * \brief Returns a pointer to this context's memory generation counter.
+ *
+ * The counter starts at zero and is incremented every time a linear memory in
+ * this store grows (see #wasmtime_store_memory_grow_callback for precisely
+ * when). Hosts can cache the results of #wasmtime_memory_data and
+ * #wasmtime_memory_data_size alongside the counter's value and revalidate the
+ * cache with a single load of the counter rather than calling back into
+ * Wasmtime.
+ *
+ * The returned pointer is valid for as long as the store is alive and must
+ * only be read from the thread currently using the store.
+ */
+WASM_API_EXTERN const uint64_t *
+wasmtime_context_memory_generation(const wasmtime_context_t *context);
+
 /**
  * \brief Configures WASI state within the specified store.
  *
@@ -189,6 +246,22 @@ wasmtime_context_get_fuel(const wasmtime_context_t *context, uint64_t *fuel);
 WASM_API_EXTERN wasmtime_error_t *
 wasmtime_context_set_wasi(wasmtime_context_t *context, wasi_config_t *wasi);
 
+/**
+ * \brief Configures WASI state within the specified store from a template.
+ *
+ * This is an alternative to #wasmtime_context_set_wasi for creating many
+ * stores with the same WASI configuration. The store gets its own WASI
+ * context, but it shares the arguments, environment, stdio, and preopened
+ * directories and sockets already opened by `wasi`, so no files or
+ * directories are reopened and nothing is copied.
+ *
+ * This function does not take ownership of `context` or `wasi`, and the
+ * template may be deleted while stores configured from it are still in use.
+ */
+WASM_API_EXTERN void
+wasmtime_context_set_wasi_template(wasmtime_context_t *context,
+                                   const wasi_ctx_template_t *wasi);
+
 /**
  * \brief Configures the relative deadline at which point WebAssembly code will
  * trap or invoke the callback function.
@@ -8,6 +8,8 @@
 #define WASMTIME_TRAP_H
 
 #include <wasm.h>
+#include <wasmtime/error.h>
+#include <wasmtime/store.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -95,6 +97,32 @@ wasmtime_frame_func_name(const wasm_frame_t *);
 WASM_API_EXTERN const wasm_name_t *
 wasmtime_frame_module_name(const wasm_frame_t *);
 
+/**
+ * \brief Writes the core dump attached to a trap to a file descriptor.
+ *
+ * \param trap the trap, which must have been produced by a call made with
+ *        #wasmtime_config_coredump_on_trap_set enabled
+ * \param store the store the trap originated from
+ * \param name the name of the program recorded in the core dump
+ * \param name_len the byte length of `name`
+ * \param fd the file descriptor to write to, which remains owned by the
+ *        caller and is not closed
+ *
+ * The core dump is written in the standard wasm core dump format. Linear
+ * memories are streamed directly from the store rather than being copied into
+ * an intermediate buffer, and pages which are entirely zero are omitted.
+ *
+ * This may be called from a background thread after the trap has been
+ * returned, provided nothing else uses `store` until it returns.
+ *
+ * Returns an error if the trap has no core dump attached, if writing to `fd`
+ * fails, or if this platform doesn't support writing to file descriptors.
+ * This function requires the `coredump` feature of the C API.
+ */
+WASM_API_EXTERN wasmtime_error_t *
+wasmtime_trap_coredump_write(const wasm_trap_t *trap, wasmtime_context_t *store,
+                             const char *name, size_t name_len, int fd);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
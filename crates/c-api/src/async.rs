@@ -1,13 +1,17 @@
+use std::cell::{Cell, RefCell, UnsafeCell};
 use std::ffi::c_void;
 use std::future::Future;
 use std::mem::{self, MaybeUninit};
 use std::num::NonZeroU64;
 use std::ops::Range;
 use std::pin::Pin;
-use std::sync::Arc;
-use std::task::{Context, Poll};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Wake, Waker};
 use std::{ptr, str};
 
+use futures::task::AtomicWaker;
+
 use wasmtime::{AsContextMut, Caller, Func, Instance, Result, StackCreator, StackMemory, Val};
 
 use crate::{
@@ -74,10 +78,13 @@ impl Drop for wasmtime_async_continuation_t {
 }
 impl Future for wasmtime_async_continuation_t {
     type Output = ();
-    fn poll(self: Pin<&mut Self>, _cx: &mut Context) -> Poll<Self::Output> {
+    fn poll(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Self::Output> {
         let this = self.get_mut();
         let cb = this.callback;
-        if cb(this.env) {
+        let prev = CONTINUATION_WAKER.with(|w| w.replace(cx.waker()));
+        let ready = cb(this.env);
+        CONTINUATION_WAKER.with(|w| w.set(prev));
+        if ready {
             Poll::Ready(())
         } else {
             Poll::Pending
@@ -85,6 +92,132 @@ impl Future for wasmtime_async_continuation_t {
     }
 }
 
+thread_local! {
+    /// The waker of the task polling a `wasmtime_async_continuation_t`, set
+    /// for the duration of its callback so that completion-based
+    /// continuations can register it.
+    static CONTINUATION_WAKER: Cell<*const Waker> = Cell::new(ptr::null());
+
+    /// The asynchronous host function whose callback is running on this
+    /// thread, so that completions created by the callback can be attached to
+    /// it.
+    static HOSTCALL: RefCell<Option<HostCall>> = RefCell::new(None);
+}
+
+struct HostCall {
+    nresults: usize,
+    completion: Option<Arc<Completion>>,
+}
+
+/// State shared between a completion-based continuation and the
+/// `wasmtime_async_completion_t` the host uses to signal it.
+///
+/// The results and trap of the host function live here rather than in the
+/// call, so that the host can still write them after the call is dropped.
+struct Completion {
+    done: AtomicBool,
+    cancelled: AtomicBool,
+    waker: AtomicWaker,
+    /// Written by the host until `done` is set, and only read by the call
+    /// after that.
+    results: UnsafeCell<Vec<wasmtime_val_t>>,
+    trap: Mutex<Option<Box<wasm_trap_t>>>,
+}
+
+// Access to `results` is handed over from the host to the call by `done`.
+unsafe impl Send for Completion {}
+unsafe impl Sync for Completion {}
+
+pub struct wasmtime_async_completion_t {
+    completion: Arc<Completion>,
+}
+
+extern "C" fn completion_continuation_callback(env: *mut c_void) -> bool {
+    let completion = unsafe { &*(env as *const Completion) };
+    // Register the waker before checking `done` so a concurrent signal either
+    // observes the registration or is observed by the check below.
+    CONTINUATION_WAKER.with(|w| {
+        if let Some(waker) = unsafe { w.get().as_ref() } {
+            completion.waker.register(waker);
+        }
+    });
+    completion.done.load(Ordering::Acquire)
+}
+
+extern "C" fn completion_continuation_finalizer(env: *mut c_void) {
+    let completion = unsafe { Arc::from_raw(env as *const Completion) };
+    // The call is being dropped, either after it has completed or because it
+    // was cancelled while waiting for the host.
+    if !completion.done.load(Ordering::Acquire) {
+        completion.cancelled.store(true, Ordering::Release);
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_async_continuation_completion(
+    continuation: &mut wasmtime_async_continuation_t,
+) -> Box<wasmtime_async_completion_t> {
+    let completion = HOSTCALL.with(|hostcall| {
+        let mut hostcall = hostcall.borrow_mut();
+        let nresults = hostcall.as_ref().map_or(0, |h| h.nresults);
+        let completion = Arc::new(Completion {
+            done: AtomicBool::new(false),
+            cancelled: AtomicBool::new(false),
+            waker: AtomicWaker::new(),
+            results: UnsafeCell::new(
+                (0..nresults)
+                    .map(|_| wasmtime_val_t {
+                        kind: WASMTIME_I32,
+                        of: wasmtime_val_union { i32: 0 },
+                    })
+                    .collect(),
+            ),
+            trap: Mutex::new(None),
+        });
+        if let Some(hostcall) = hostcall.as_mut() {
+            hostcall.completion = Some(completion.clone());
+        }
+        completion
+    });
+    *continuation = wasmtime_async_continuation_t {
+        callback: completion_continuation_callback,
+        env: Arc::into_raw(completion.clone()) as *mut c_void,
+        finalizer: Some(completion_continuation_finalizer),
+    };
+    Box::new(wasmtime_async_completion_t { completion })
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_async_completion_signal(completion: &wasmtime_async_completion_t) {
+    completion.completion.done.store(true, Ordering::Release);
+    completion.completion.waker.wake();
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_async_completion_results(
+    completion: &wasmtime_async_completion_t,
+) -> *mut wasmtime_val_t {
+    unsafe { (*completion.completion.results.get()).as_mut_ptr() }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_async_completion_set_trap(
+    completion: &wasmtime_async_completion_t,
+    trap: Box<wasm_trap_t>,
+) {
+    *completion.completion.trap.lock().unwrap() = Some(trap);
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_async_completion_is_cancelled(
+    completion: &wasmtime_async_completion_t,
+) -> bool {
+    completion.completion.cancelled.load(Ordering::Acquire)
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_async_completion_delete(_completion: Box<wasmtime_async_completion_t>) {}
+
 /// Internal structure to add Send/Sync to a c_void member.
 ///
 /// This is useful in closures that need to capture some C data.
@@ -120,7 +253,7 @@ async fn invoke_c_async_callback<'a>(
 
     // Invoke the C function pointer.
     // The result will be a continutation which we will wrap in a Future.
-    let mut caller = wasmtime_caller_t { caller };
+    let mut caller = wasmtime_caller_t::new(caller);
     let mut trap = None;
     extern "C" fn panic_callback(_: *mut c_void) -> bool {
         panic!("callback must be set")
@@ -130,6 +263,12 @@ async fn invoke_c_async_callback<'a>(
         env: ptr::null_mut(),
         finalizer: None,
     };
+    let prev = HOSTCALL.with(|h| {
+        h.replace(Some(HostCall {
+            nresults: out_results.len(),
+            completion: None,
+        }))
+    });
     cb(
         data.ptr,
         &mut caller,
@@ -140,7 +279,20 @@ async fn invoke_c_async_callback<'a>(
         &mut trap,
         &mut continuation,
     );
-    continuation.await;
+    let completion = HOSTCALL
+        .with(|h| h.replace(prev))
+        .and_then(|h| h.completion);
+    (&mut continuation).await;
+
+    // Host functions which completed through a completion wrote their
+    // results and trap into it instead.
+    if let Some(completion) = completion {
+        trap = completion.trap.lock().unwrap().take();
+        let results = mem::take(unsafe { &mut *completion.results.get() });
+        for (slot, result) in out_results.iter_mut().zip(results) {
+            *slot = result;
+        }
+    }
 
     if let Some(trap) = trap {
         return Err(trap.error);
@@ -182,9 +334,22 @@ unsafe fn c_async_callback_to_rust_fn(
     }
 }
 
-#[repr(transparent)]
 pub struct wasmtime_call_future_t<'a> {
     underlying: Pin<Box<dyn Future<Output = ()> + 'a>>,
+    waker: Option<Waker>,
+}
+
+impl<'a> wasmtime_call_future_t<'a> {
+    pub(crate) fn new(underlying: Pin<Box<dyn Future<Output = ()> + 'a>>) -> Box<Self> {
+        Box::new(wasmtime_call_future_t {
+            underlying,
+            waker: None,
+        })
+    }
+
+    pub(crate) fn into_underlying(self: Box<Self>) -> Pin<Box<dyn Future<Output = ()> + 'a>> {
+        self.underlying
+    }
 }
 
 #[no_mangle]
@@ -192,13 +357,45 @@ pub extern "C" fn wasmtime_call_future_delete(_future: Box<wasmtime_call_future_
 
 #[no_mangle]
 pub extern "C" fn wasmtime_call_future_poll(future: &mut wasmtime_call_future_t) -> bool {
-    let w = futures::task::noop_waker_ref();
+    let w = match &future.waker {
+        Some(waker) => waker,
+        None => futures::task::noop_waker_ref(),
+    };
     match future.underlying.as_mut().poll(&mut Context::from_waker(w)) {
         Poll::Ready(()) => true,
         Poll::Pending => false,
     }
 }
 
+pub type wasmtime_call_future_wake_callback_t = extern "C" fn(*mut c_void);
+
+/// A `Waker` which invokes a C callback.
+struct CWaker {
+    foreign: crate::ForeignData,
+    wake: wasmtime_call_future_wake_callback_t,
+}
+
+impl Wake for CWaker {
+    fn wake(self: Arc<Self>) {
+        self.wake_by_ref()
+    }
+
+    fn wake_by_ref(self: &Arc<Self>) {
+        (self.wake)(self.foreign.data)
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_call_future_set_waker(
+    future: &mut wasmtime_call_future_t,
+    wake: wasmtime_call_future_wake_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    let foreign = crate::ForeignData { data, finalizer };
+    future.waker = Some(Waker::from(Arc::new(CWaker { foreign, wake })));
+}
+
 fn handle_call_error(
     err: wasmtime::Error,
     trap_ret: &mut *mut wasm_trap_t,
@@ -252,7 +449,7 @@ pub unsafe extern "C" fn wasmtime_func_call_async<'a>(
     let fut = Box::pin(do_func_call_async(
         store, func, args, results, trap_ret, err_ret,
     ));
-    Box::new(wasmtime_call_future_t { underlying: fut })
+    wasmtime_call_future_t::new(fut)
 }
 
 #[no_mangle]
@@ -310,7 +507,7 @@ pub extern "C" fn wasmtime_linker_instantiate_async<'a>(
         trap_ret,
         err_ret,
     ));
-    Box::new(crate::wasmtime_call_future_t { underlying: fut })
+    crate::wasmtime_call_future_t::new(fut)
 }
 
 async fn do_instance_pre_instantiate_async(
@@ -342,7 +539,7 @@ pub extern "C" fn wasmtime_instance_pre_instantiate_async<'a>(
         trap_ret,
         err_ret,
     ));
-    Box::new(crate::wasmtime_call_future_t { underlying: fut })
+    crate::wasmtime_call_future_t::new(fut)
 }
 
 pub type wasmtime_stack_memory_get_callback_t =
@@ -60,6 +60,12 @@ pub extern "C" fn wasmtime_config_consume_fuel_set(c: &mut wasm_config_t, enable
     c.config.consume_fuel(enable);
 }
 
+#[no_mangle]
+#[cfg(feature = "coredump")]
+pub extern "C" fn wasmtime_config_coredump_on_trap_set(c: &mut wasm_config_t, enable: bool) {
+    c.config.coredump_on_trap(enable);
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_config_epoch_interruption_set(c: &mut wasm_config_t, enable: bool) {
     c.config.epoch_interruption(enable);
@@ -226,6 +232,14 @@ pub extern "C" fn wasmtime_config_dynamic_memory_reserved_for_growth_set(
     c.config.dynamic_memory_reserved_for_growth(size);
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_config_dynamic_memory_growth_geometric_set(
+    c: &mut wasm_config_t,
+    enable: bool,
+) {
+    c.config.dynamic_memory_growth_geometric(enable);
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_config_native_unwind_info_set(c: &mut wasm_config_t, enabled: bool) {
     c.config.native_unwind_info(enabled);
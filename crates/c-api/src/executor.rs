@@ -0,0 +1,442 @@
+//! A multi-threaded executor for `wasmtime_call_future_t`s.
+//!
+//! Each worker thread has its own run queue, onto which go tasks woken by that
+//! worker. New tasks and tasks woken from other threads go onto a shared
+//! injector queue. Workers run tasks from their own queue, then from the
+//! injector, and then steal from the back of other workers' queues. Tasks which
+//! yield, for example due to fuel or epoch yields, go to the back of the
+//! injector, behind every other ready task, once they have used up the number
+//! of polls given by their weight.
+
+use crate::{wasmtime_call_future_t, ForeignData};
+use std::cell::Cell;
+use std::collections::{HashMap, VecDeque};
+use std::ffi::c_void;
+use std::future::Future;
+use std::pin::Pin;
+use std::ptr;
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicU8, Ordering};
+use std::sync::{Arc, Condvar, Mutex, Weak};
+use std::task::{Context, Poll, Wake, Waker};
+use std::thread::JoinHandle;
+use std::time::Duration;
+
+pub struct wasmtime_executor_t {
+    shared: Arc<Shared>,
+    workers: Vec<JoinHandle<()>>,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_executor_t);
+
+struct Shared {
+    injector: Mutex<VecDeque<Arc<Task>>>,
+    locals: Vec<Mutex<VecDeque<Arc<Task>>>>,
+    sleep: Mutex<()>,
+    wakeup: Condvar,
+    shutdown: AtomicBool,
+    /// Every task which hasn't completed yet, including those only referenced
+    /// by wakers, so they can be cancelled when the executor is deleted.
+    live: Mutex<HashMap<u64, Weak<Task>>>,
+    next_id: AtomicU64,
+}
+
+/// A call future which may be polled from any worker thread.
+///
+/// The C API requires that everything a future references remains valid
+/// until it's deleted, and stores may be used from any thread, so the futures
+/// given to an executor are sent across threads.
+struct SendFuture(Pin<Box<dyn Future<Output = ()>>>);
+
+unsafe impl Send for SendFuture {}
+
+struct Task {
+    id: u64,
+    future: Mutex<Option<SendFuture>>,
+    state: AtomicU8,
+    weight: u32,
+    shared: Arc<Shared>,
+    on_complete: Option<extern "C" fn(*mut c_void)>,
+    data: ForeignData,
+}
+
+// States of a `Task`, transitioned by wakeups and by the worker polling it.
+const IDLE: u8 = 0;
+const SCHEDULED: u8 = 1;
+const RUNNING: u8 = 2;
+const NOTIFIED: u8 = 3;
+const COMPLETE: u8 = 4;
+
+thread_local! {
+    /// The executor and index of the worker running on this thread, if any.
+    static WORKER: Cell<Option<(*const Shared, usize)>> = Cell::new(None);
+}
+
+impl Wake for Task {
+    fn wake(self: Arc<Self>) {
+        self.wake_by_ref()
+    }
+
+    fn wake_by_ref(self: &Arc<Self>) {
+        let mut state = self.state.load(Ordering::Acquire);
+        loop {
+            let next = match state {
+                IDLE => SCHEDULED,
+                RUNNING => NOTIFIED,
+                _ => return,
+            };
+            match self
+                .state
+                .compare_exchange(state, next, Ordering::AcqRel, Ordering::Acquire)
+            {
+                Ok(_) => break,
+                Err(actual) => state = actual,
+            }
+        }
+        if state != IDLE {
+            return;
+        }
+        match WORKER.with(|w| w.get()) {
+            Some((shared, index)) if ptr::eq(shared, &*self.shared) => {
+                self.shared.locals[index]
+                    .lock()
+                    .unwrap()
+                    .push_back(self.clone());
+                self.shared.notify();
+            }
+            _ => self.shared.push_injector(self.clone()),
+        }
+    }
+}
+
+impl Shared {
+    fn push_injector(&self, task: Arc<Task>) {
+        let mut injector = self.injector.lock().unwrap();
+        // Once the executor has been deleted nothing will run the task, and
+        // queueing it would leak it, along with the executor, through the
+        // cycle between the two. The executor clears the injector under this
+        // lock after setting `shutdown`, so tasks can't be pushed after that.
+        if self.shutdown.load(Ordering::Acquire) {
+            return;
+        }
+        injector.push_back(task);
+        drop(injector);
+        self.notify();
+    }
+
+    fn notify(&self) {
+        // Acquire the sleep lock so the notification can't be lost between a
+        // worker finding no work and going to sleep.
+        drop(self.sleep.lock().unwrap());
+        self.wakeup.notify_one();
+    }
+
+    fn find_task(&self, index: usize) -> Option<Arc<Task>> {
+        if let Some(task) = self.locals[index].lock().unwrap().pop_front() {
+            return Some(task);
+        }
+        if let Some(task) = self.injector.lock().unwrap().pop_front() {
+            return Some(task);
+        }
+        let n = self.locals.len();
+        (1..n).find_map(|i| self.locals[(index + i) % n].lock().unwrap().pop_back())
+    }
+
+    fn has_work(&self) -> bool {
+        !self.injector.lock().unwrap().is_empty()
+            || self.locals.iter().any(|q| !q.lock().unwrap().is_empty())
+    }
+
+    fn run_worker(&self, index: usize) {
+        WORKER.with(|w| w.set(Some((self, index))));
+        while !self.shutdown.load(Ordering::Acquire) {
+            match self.find_task(index) {
+                Some(task) => self.run_task(task),
+                None => {
+                    let guard = self.sleep.lock().unwrap();
+                    if !self.has_work() && !self.shutdown.load(Ordering::Acquire) {
+                        // The timeout is only a backstop; pushes notify
+                        // sleeping workers.
+                        drop(
+                            self.wakeup
+                                .wait_timeout(guard, Duration::from_millis(100))
+                                .unwrap(),
+                        );
+                    }
+                }
+            }
+        }
+    }
+
+    fn run_task(&self, task: Arc<Task>) {
+        let waker = Waker::from(task.clone());
+        let mut cx = Context::from_waker(&waker);
+        let mut future = task.future.lock().unwrap();
+        let mut polls = 0;
+        loop {
+            task.state.store(RUNNING, Ordering::Release);
+            let fut = match future.as_mut() {
+                Some(fut) => fut,
+                None => return,
+            };
+            if let Poll::Ready(()) = fut.0.as_mut().poll(&mut cx) {
+                task.state.store(COMPLETE, Ordering::Release);
+                // Drop the future, and with it its borrows of the store and
+                // result locations, before notifying the embedder.
+                *future = None;
+                self.live.lock().unwrap().remove(&task.id);
+                if let Some(on_complete) = task.on_complete {
+                    on_complete(task.data.data);
+                }
+                return;
+            }
+            if task
+                .state
+                .compare_exchange(RUNNING, IDLE, Ordering::AcqRel, Ordering::Acquire)
+                .is_ok()
+            {
+                // Waiting on something else, which will wake this task.
+                return;
+            }
+
+            // Woken while running, typically a fuel or epoch yield. Keep going
+            // while this task has polls left in its turn, otherwise go to the
+            // back of the injector to give every other ready task a chance to
+            // run first.
+            polls += 1;
+            if polls >= task.weight {
+                task.state.store(SCHEDULED, Ordering::Release);
+                drop(future);
+                self.push_injector(task);
+                return;
+            }
+        }
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_executor_new(num_threads: usize) -> Box<wasmtime_executor_t> {
+    let num_threads = if num_threads == 0 {
+        std::thread::available_parallelism().map_or(1, |n| n.get())
+    } else {
+        num_threads
+    };
+    let shared = Arc::new(Shared {
+        injector: Mutex::new(VecDeque::new()),
+        locals: (0..num_threads)
+            .map(|_| Mutex::new(VecDeque::new()))
+            .collect(),
+        sleep: Mutex::new(()),
+        wakeup: Condvar::new(),
+        shutdown: AtomicBool::new(false),
+        live: Mutex::new(HashMap::new()),
+        next_id: AtomicU64::new(0),
+    });
+    let workers = (0..num_threads)
+        .map(|index| {
+            let shared = shared.clone();
+            std::thread::Builder::new()
+                .name(format!("wasmtime-executor-{index}"))
+                .spawn(move || shared.run_worker(index))
+                .expect("failed to spawn executor thread")
+        })
+        .collect();
+    Box::new(wasmtime_executor_t { shared, workers })
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_executor_spawn(
+    executor: &wasmtime_executor_t,
+    future: Box<wasmtime_call_future_t<'static>>,
+    weight: u32,
+    on_complete: Option<extern "C" fn(*mut c_void)>,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    let shared = &executor.shared;
+    let task = Arc::new(Task {
+        id: shared.next_id.fetch_add(1, Ordering::Relaxed),
+        future: Mutex::new(Some(SendFuture(future.into_underlying()))),
+        state: AtomicU8::new(SCHEDULED),
+        weight: weight.max(1),
+        shared: shared.clone(),
+        on_complete,
+        data: ForeignData { data, finalizer },
+    });
+    shared
+        .live
+        .lock()
+        .unwrap()
+        .insert(task.id, Arc::downgrade(&task));
+    shared.push_injector(task);
+}
+
+impl Drop for wasmtime_executor_t {
+    fn drop(&mut self) {
+        self.shared.shutdown.store(true, Ordering::Release);
+        drop(self.shared.sleep.lock().unwrap());
+        self.shared.wakeup.notify_all();
+        for worker in self.workers.drain(..) {
+            let _ = worker.join();
+        }
+
+        // Cancel everything that didn't complete. Tasks waiting on a wakeup
+        // may be kept alive by their wakers, so their futures are dropped
+        // here to release their borrows of stores.
+        let live = std::mem::take(&mut *self.shared.live.lock().unwrap());
+        for task in live.values().filter_map(|t| t.upgrade()) {
+            task.future.lock().unwrap().take();
+        }
+        for queue in self.shared.locals.iter().chain(Some(&self.shared.injector)) {
+            // Dropping a task runs its finalizer, which shouldn't happen with
+            // the queue locked.
+            let tasks = std::mem::take(&mut *queue.lock().unwrap());
+            drop(tasks);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::future::poll_fn;
+    use std::sync::atomic::AtomicUsize;
+    use std::sync::mpsc;
+
+    /// Spawns `future` onto `executor`, returning a receiver which gets a
+    /// message once it completes.
+    fn spawn(
+        executor: &wasmtime_executor_t,
+        weight: u32,
+        future: impl Future<Output = ()> + 'static,
+    ) -> mpsc::Receiver<()> {
+        extern "C" fn on_complete(data: *mut c_void) {
+            let tx = unsafe { &*(data as *const mpsc::Sender<()>) };
+            tx.send(()).unwrap();
+        }
+        extern "C" fn finalize(data: *mut c_void) {
+            unsafe { drop(Box::from_raw(data as *mut mpsc::Sender<()>)) }
+        }
+
+        let (tx, rx) = mpsc::channel();
+        wasmtime_executor_spawn(
+            executor,
+            wasmtime_call_future_t::new(Box::pin(future)),
+            weight,
+            Some(on_complete),
+            Box::into_raw(Box::new(tx)) as *mut c_void,
+            Some(finalize),
+        );
+        rx
+    }
+
+    /// A future which is polled `polls` times, waking itself each time it
+    /// returns pending, and logs `name` on each poll.
+    fn yielding(name: char, mut polls: usize, log: Arc<Mutex<String>>) -> impl Future<Output = ()> {
+        poll_fn(move |cx| {
+            log.lock().unwrap().push(name);
+            polls -= 1;
+            if polls == 0 {
+                Poll::Ready(())
+            } else {
+                cx.waker().wake_by_ref();
+                Poll::Pending
+            }
+        })
+    }
+
+    const TIMEOUT: Duration = Duration::from_secs(10);
+
+    #[test]
+    fn runs_spawned_futures() {
+        let executor = wasmtime_executor_new(2);
+        let done = (0..16)
+            .map(|_| spawn(&executor, 1, async {}))
+            .collect::<Vec<_>>();
+        for rx in done {
+            rx.recv_timeout(TIMEOUT).unwrap();
+        }
+    }
+
+    #[test]
+    fn runs_woken_futures() {
+        let executor = wasmtime_executor_new(2);
+        let waker = Arc::new(Mutex::new(None::<Waker>));
+        let mut polled = false;
+        let done = spawn(&executor, 1, {
+            let waker = waker.clone();
+            poll_fn(move |cx| {
+                if polled {
+                    return Poll::Ready(());
+                }
+                polled = true;
+                *waker.lock().unwrap() = Some(cx.waker().clone());
+                Poll::Pending
+            })
+        });
+
+        // Wake the future from a thread which isn't one of the executor's.
+        let start = std::time::Instant::now();
+        let waker = loop {
+            if let Some(waker) = waker.lock().unwrap().take() {
+                break waker;
+            }
+            assert!(start.elapsed() < TIMEOUT);
+            std::thread::yield_now();
+        };
+        assert!(done.try_recv().is_err());
+        waker.wake();
+        done.recv_timeout(TIMEOUT).unwrap();
+    }
+
+    #[test]
+    fn wake_after_delete_drops_task() {
+        static FINALIZED: AtomicUsize = AtomicUsize::new(0);
+        extern "C" fn finalize(_data: *mut c_void) {
+            FINALIZED.fetch_add(1, Ordering::SeqCst);
+        }
+
+        let executor = wasmtime_executor_new(1);
+        let (tx, rx) = mpsc::channel();
+        wasmtime_executor_spawn(
+            &executor,
+            wasmtime_call_future_t::new(Box::pin(poll_fn(move |cx| {
+                let _ = tx.send(cx.waker().clone());
+                Poll::Pending
+            }))),
+            1,
+            None,
+            ptr::null_mut(),
+            Some(finalize),
+        );
+        let waker = rx.recv_timeout(TIMEOUT).unwrap();
+
+        drop(executor);
+        assert_eq!(FINALIZED.load(Ordering::SeqCst), 0);
+
+        // The waker holds the last reference to the task, which isn't requeued
+        // anywhere now that the executor is gone.
+        waker.wake();
+        assert_eq!(FINALIZED.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn yields_after_weight_polls() {
+        let executor = wasmtime_executor_new(1);
+        let log = Arc::new(Mutex::new(String::new()));
+
+        // Hold the only worker until both tasks are queued, so that they're
+        // taken from the injector in order.
+        let (release, gate) = mpsc::channel::<()>();
+        let gate_done = spawn(&executor, 1, async move {
+            gate.recv().unwrap();
+        });
+        let a = spawn(&executor, 3, yielding('a', 6, log.clone()));
+        let b = spawn(&executor, 1, yielding('b', 4, log.clone()));
+        release.send(()).unwrap();
+
+        for rx in [gate_done, a, b] {
+            rx.recv_timeout(TIMEOUT).unwrap();
+        }
+        assert_eq!(*log.lock().unwrap(), "aaabaaabbb");
+    }
+}
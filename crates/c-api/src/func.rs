@@ -1,16 +1,20 @@
 use crate::wasm_trap_t;
 use crate::{
-    wasm_extern_t, wasm_functype_t, wasm_store_t, wasm_val_t, wasm_val_vec_t, wasmtime_error_t,
-    wasmtime_extern_t, wasmtime_val_t, wasmtime_val_union, CStoreContext, CStoreContextMut,
+    handle_result, wasm_extern_t, wasm_functype_t, wasm_store_t, wasm_val_t, wasm_val_vec_t,
+    wasmtime_error_t, wasmtime_extern_t, wasmtime_val_t, wasmtime_val_union, CStoreContext,
+    CStoreContextMut,
 };
-use anyhow::{Error, Result};
+use anyhow::{bail, Error, Result};
 use std::any::Any;
 use std::ffi::c_void;
 use std::mem::{self, MaybeUninit};
 use std::panic::{self, AssertUnwindSafe};
 use std::ptr;
 use std::str;
-use wasmtime::{AsContextMut, Caller, Extern, Func, Trap, Val, ValRaw};
+use wasmtime::{
+    AsContextMut, Caller, Extern, Func, FuncType, IntoFunc, Linker, Trap, Val, ValRaw, ValType,
+    WasmRet, WasmTy,
+};
 
 #[derive(Clone)]
 #[repr(transparent)]
@@ -201,6 +205,14 @@ pub extern "C" fn wasm_func_as_extern_const(f: &wasm_func_t) -> &wasm_extern_t {
 #[repr(C)]
 pub struct wasmtime_caller_t<'a> {
     pub(crate) caller: Caller<'a, crate::StoreData>,
+    /// A trap raised by a native host function with `wasmtime_caller_trap`.
+    pub(crate) trap: Option<Box<wasm_trap_t>>,
+}
+
+impl<'a> wasmtime_caller_t<'a> {
+    pub(crate) fn new(caller: Caller<'a, crate::StoreData>) -> Self {
+        wasmtime_caller_t { caller, trap: None }
+    }
 }
 
 pub type wasmtime_func_callback_t = extern "C" fn(
@@ -257,7 +269,7 @@ pub(crate) unsafe fn c_callback_to_rust_fn(
         let (params, out_results) = vals.split_at_mut(params.len());
 
         // Invoke the C function pointer, getting the results.
-        let mut caller = wasmtime_caller_t { caller };
+        let mut caller = wasmtime_caller_t::new(caller);
         let out = callback(
             foreign.data,
             &mut caller,
@@ -306,7 +318,7 @@ pub(crate) unsafe fn c_unchecked_callback_to_rust_fn(
     let foreign = crate::ForeignData { data, finalizer };
     move |caller, values| {
         let _ = &foreign; // move entire foreign into this closure
-        let mut caller = wasmtime_caller_t { caller };
+        let mut caller = wasmtime_caller_t::new(caller);
         match callback(foreign.data, &mut caller, values.as_mut_ptr(), values.len()) {
             None => Ok(()),
             Some(trap) => Err(trap.error),
@@ -314,6 +326,168 @@ pub(crate) unsafe fn c_unchecked_callback_to_rust_fn(
     }
 }
 
+/// A host function with a native signature, see `wasmtime_func_new_native`.
+pub type wasmtime_func_native_callback_t = unsafe extern "C" fn();
+
+/// The maximum number of parameters of a native host function.
+const MAX_NATIVE_PARAMS: usize = 4;
+
+pub(crate) struct NativeHost {
+    pub(crate) callback: wasmtime_func_native_callback_t,
+    pub(crate) foreign: crate::ForeignData,
+}
+
+/// Where a native host function gets defined, either a store or a linker.
+trait NativeSink {
+    type Output;
+    fn wrap<Params, Results>(
+        self,
+        func: impl IntoFunc<crate::StoreData, Params, Results>,
+    ) -> Result<Self::Output>;
+}
+
+impl<'a> NativeSink for CStoreContextMut<'a> {
+    type Output = Func;
+    fn wrap<Params, Results>(
+        self,
+        func: impl IntoFunc<crate::StoreData, Params, Results>,
+    ) -> Result<Func> {
+        Ok(Func::wrap(self, func))
+    }
+}
+
+pub(crate) struct LinkerSink<'a> {
+    pub(crate) linker: &'a mut Linker<crate::StoreData>,
+    pub(crate) module: &'a str,
+    pub(crate) name: &'a str,
+}
+
+impl NativeSink for LinkerSink<'_> {
+    type Output = ();
+    fn wrap<Params, Results>(
+        self,
+        func: impl IntoFunc<crate::StoreData, Params, Results>,
+    ) -> Result<()> {
+        self.linker.func_wrap(self.module, self.name, func)?;
+        Ok(())
+    }
+}
+
+/// Defines a native host function for the signature `ty` in `sink`.
+///
+/// Each supported signature is a separate instantiation of `IntoFunc`, with
+/// its own trampolines, so the signatures are limited to keep their number
+/// down: up to `MAX_NATIVE_PARAMS` parameters which are each `i32` or `i64`,
+/// and at most one `i32` or `i64` result. That's 93 signatures, which cover
+/// the common shapes of host calls, such as a pair of pointer and length
+/// arguments. Supporting `f32` and `f64` as well would take 1023.
+///
+/// The closures wrapped for each signature don't depend on the sink, so the
+/// store and linker share their instantiations.
+fn define_native<S: NativeSink>(sink: S, ty: &FuncType, host: NativeHost) -> Result<S::Output> {
+    let params = ty.params().collect::<Vec<_>>();
+    match ty.results().collect::<Vec<_>>()[..] {
+        [] => native_params0::<S, ()>(sink, host, &params),
+        [ValType::I32] => native_params0::<S, i32>(sink, host, &params),
+        [ValType::I64] => native_params0::<S, i64>(sink, host, &params),
+        _ => bail!("native host functions return at most one `i32` or `i64`"),
+    }
+}
+
+macro_rules! native_params {
+    (@closure $closure:ident ($($args:ident)*)) => {
+        #[allow(non_snake_case)]
+        fn $closure<R: WasmRet, $($args: WasmTy,)*>(
+            host: NativeHost,
+        ) -> impl Fn(Caller<'_, crate::StoreData>, $($args),*) -> Result<R> + Send + Sync + 'static
+        {
+            move |caller: Caller<'_, crate::StoreData>, $($args: $args),*| -> Result<R> {
+                let _ = &host; // move entire host into this closure
+                let callback: unsafe extern "C" fn(
+                    *mut c_void,
+                    *mut wasmtime_caller_t,
+                    $($args),*
+                ) -> R = unsafe { mem::transmute(host.callback) };
+                let mut caller = wasmtime_caller_t::new(caller);
+                let ret = unsafe { callback(host.foreign.data, &mut caller, $($args),*) };
+                match caller.trap {
+                    Some(trap) => Err(trap.error),
+                    None => Ok(ret),
+                }
+            }
+        }
+    };
+
+    ($name:ident $closure:ident => $next:ident ($($args:ident)*)) => {
+        native_params!(@closure $closure ($($args)*));
+
+        fn $name<S: NativeSink, R: WasmRet, $($args: WasmTy,)*>(
+            sink: S,
+            host: NativeHost,
+            params: &[ValType],
+        ) -> Result<S::Output> {
+            match params {
+                [] => sink.wrap($closure::<R, $($args),*>(host)),
+                [ValType::I32, rest @ ..] => $next::<S, R, $($args,)* i32>(sink, host, rest),
+                [ValType::I64, rest @ ..] => $next::<S, R, $($args,)* i64>(sink, host, rest),
+                _ => bail!("native host functions only take `i32` and `i64` parameters"),
+            }
+        }
+    };
+
+    // The last level, which takes `MAX_NATIVE_PARAMS` parameters.
+    ($name:ident $closure:ident ($($args:ident)*)) => {
+        native_params!(@closure $closure ($($args)*));
+
+        fn $name<S: NativeSink, R: WasmRet, $($args: WasmTy,)*>(
+            sink: S,
+            host: NativeHost,
+            params: &[ValType],
+        ) -> Result<S::Output> {
+            match params {
+                [] => sink.wrap($closure::<R, $($args),*>(host)),
+                _ => bail!("native host functions take at most {MAX_NATIVE_PARAMS} parameters"),
+            }
+        }
+    };
+}
+
+native_params!(native_params0 native_closure0 => native_params1 ());
+native_params!(native_params1 native_closure1 => native_params2 (A1));
+native_params!(native_params2 native_closure2 => native_params3 (A1 A2));
+native_params!(native_params3 native_closure3 => native_params4 (A1 A2 A3));
+native_params!(native_params4 native_closure4 (A1 A2 A3 A4));
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_func_new_native(
+    store: CStoreContextMut<'_>,
+    ty: &wasm_functype_t,
+    callback: wasmtime_func_native_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut std::ffi::c_void)>,
+    func: &mut Func,
+) -> Option<Box<wasmtime_error_t>> {
+    let ty = ty.ty().ty.clone();
+    let host = NativeHost {
+        callback,
+        foreign: crate::ForeignData { data, finalizer },
+    };
+    handle_result(define_native(store, &ty, host), |f| *func = f)
+}
+
+pub(crate) fn linker_define_native(
+    sink: LinkerSink<'_>,
+    ty: &FuncType,
+    host: NativeHost,
+) -> Result<()> {
+    define_native(sink, ty, host)
+}
+
+#[no_mangle]
+pub extern "C" fn wasmtime_caller_trap(caller: &mut wasmtime_caller_t, trap: Box<wasm_trap_t>) {
+    caller.trap = Some(trap);
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_func_call(
     mut store: CStoreContextMut<'_>,
@@ -417,6 +591,20 @@ pub unsafe extern "C" fn wasmtime_caller_export_get(
     true
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_caller_export_get_by_index(
+    caller: &mut wasmtime_caller_t,
+    export: &crate::wasmtime_module_export_t,
+    item: &mut MaybeUninit<wasmtime_extern_t>,
+) -> bool {
+    let which = match caller.caller.get_module_export(&export.export) {
+        Some(item) => item,
+        None => return false,
+    };
+    crate::initialize(item, which.into());
+    true
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_func_from_raw(
     store: CStoreContextMut<'_>,
@@ -433,3 +621,140 @@ pub unsafe extern "C" fn wasmtime_func_to_raw(
 ) -> *mut c_void {
     func.to_raw(store)
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{wasm_engine_new, wasmtime_linker_new, wasmtime_store_new, ForeignData};
+    use std::sync::atomic::{AtomicUsize, Ordering::SeqCst};
+
+    extern "C" fn finalize(data: *mut c_void) {
+        unsafe { (*data.cast::<AtomicUsize>()).fetch_add(1, SeqCst) };
+    }
+
+    fn host(callback: *const (), finalized: &AtomicUsize) -> NativeHost {
+        NativeHost {
+            callback: unsafe { mem::transmute(callback) },
+            foreign: ForeignData {
+                data: finalized as *const AtomicUsize as *mut c_void,
+                finalizer: Some(finalize),
+            },
+        }
+    }
+
+    fn functype(params: &[ValType], results: &[ValType]) -> wasm_functype_t {
+        wasm_functype_t::new(FuncType::new(
+            params.iter().cloned(),
+            results.iter().cloned(),
+        ))
+    }
+
+    unsafe extern "C" fn sub(_: *mut c_void, _: *mut wasmtime_caller_t, a: i32, b: i64) -> i64 {
+        i64::from(a) - b
+    }
+
+    unsafe extern "C" fn trap(_: *mut c_void, caller: *mut wasmtime_caller_t, a: i32) -> i32 {
+        let msg = "native trap";
+        wasmtime_caller_trap(&mut *caller, wasmtime_trap_new(msg.as_ptr(), msg.len()));
+        a
+    }
+
+    #[test]
+    fn calls_native_host_functions() -> Result<()> {
+        let engine = wasm_engine_new();
+        let mut store = wasmtime_store_new(&engine, ptr::null_mut(), None);
+        let finalized = AtomicUsize::new(0);
+
+        let ty = FuncType::new([ValType::I32, ValType::I64], [ValType::I64]);
+        let func = define_native(
+            store.store.as_context_mut(),
+            &ty,
+            host(sub as *const (), &finalized),
+        )?;
+        let func = func.typed::<(i32, i64), i64>(&store.store)?;
+        assert_eq!(func.call(&mut store.store, (5, 7))?, -2);
+
+        let ty = FuncType::new([ValType::I32], [ValType::I32]);
+        let func = define_native(
+            store.store.as_context_mut(),
+            &ty,
+            host(trap as *const (), &finalized),
+        )?;
+        let func = func.typed::<i32, i32>(&store.store)?;
+        let err = func.call(&mut store.store, 1).unwrap_err();
+        assert!(format!("{err:?}").contains("native trap"), "{err:?}");
+
+        drop(store);
+        assert_eq!(finalized.load(SeqCst), 2);
+        Ok(())
+    }
+
+    #[test]
+    fn unsupported_signatures_run_finalizer() {
+        let engine = wasm_engine_new();
+        let mut store = wasmtime_store_new(&engine, ptr::null_mut(), None);
+        let finalized = AtomicUsize::new(0);
+
+        for ty in [
+            FuncType::new([ValType::F32], []),
+            FuncType::new([], [ValType::F64]),
+            FuncType::new([], [ValType::I32, ValType::I32]),
+            FuncType::new(vec![ValType::I32; MAX_NATIVE_PARAMS + 1], []),
+        ] {
+            let host = host(sub as *const (), &finalized);
+            assert!(define_native(store.store.as_context_mut(), &ty, host).is_err());
+        }
+        assert_eq!(finalized.load(SeqCst), 4);
+
+        // The last level of `native_params!` reports too many parameters.
+        let ty = FuncType::new(vec![ValType::I64; MAX_NATIVE_PARAMS + 1], []);
+        let host = host(sub as *const (), &finalized);
+        let err = define_native(store.store.as_context_mut(), &ty, host).unwrap_err();
+        assert!(err.to_string().contains("at most"), "{err}");
+        assert_eq!(finalized.load(SeqCst), 5);
+    }
+
+    #[test]
+    fn linker_define_runs_finalizer_on_error() {
+        let engine = wasm_engine_new();
+        let mut linker = wasmtime_linker_new(&engine);
+        let finalized = AtomicUsize::new(0);
+        let data = &finalized as *const AtomicUsize as *mut c_void;
+        let callback: wasmtime_func_native_callback_t = unsafe { mem::transmute(sub as *const ()) };
+        let ty = functype(&[ValType::I32, ValType::I64], &[ValType::I64]);
+
+        let bad = b"\xff";
+        let err = unsafe {
+            crate::wasmtime_linker_define_func_native(
+                &mut linker,
+                b"m".as_ptr(),
+                1,
+                bad.as_ptr(),
+                bad.len(),
+                &ty,
+                callback,
+                data,
+                Some(finalize),
+            )
+        };
+        assert!(err.is_some());
+        assert_eq!(finalized.load(SeqCst), 1);
+
+        let ty = functype(&[ValType::F32], &[]);
+        let err = unsafe {
+            crate::wasmtime_linker_define_func_native(
+                &mut linker,
+                b"m".as_ptr(),
+                1,
+                b"f".as_ptr(),
+                1,
+                &ty,
+                callback,
+                data,
+                Some(finalize),
+            )
+        };
+        assert!(err.is_some());
+        assert_eq!(finalized.load(SeqCst), 2);
+    }
+}
@@ -1,6 +1,7 @@
 use crate::{
     wasm_extern_t, wasm_extern_vec_t, wasm_module_t, wasm_store_t, wasm_trap_t, wasmtime_error_t,
-    wasmtime_extern_t, wasmtime_module_t, CStoreContextMut, StoreData, StoreRef,
+    wasmtime_extern_t, wasmtime_module_export_t, wasmtime_module_t, CStoreContextMut, StoreData,
+    StoreRef,
 };
 use std::mem::MaybeUninit;
 use wasmtime::{Instance, InstancePre, Trap};
@@ -131,6 +132,22 @@ pub unsafe extern "C" fn wasmtime_instance_export_get(
     }
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_instance_export_get_by_index(
+    store: CStoreContextMut<'_>,
+    instance: &Instance,
+    export: &wasmtime_module_export_t,
+    item: &mut MaybeUninit<wasmtime_extern_t>,
+) -> bool {
+    match instance.get_module_export(store, &export.export) {
+        Some(e) => {
+            crate::initialize(item, e.into());
+            true
+        }
+        None => false,
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasmtime_instance_export_nth(
     store: CStoreContextMut<'_>,
@@ -54,6 +54,10 @@ pub use crate::vec::*;
 mod r#async;
 #[cfg(feature = "async")]
 pub use crate::r#async::*;
+#[cfg(feature = "async")]
+mod executor;
+#[cfg(feature = "async")]
+pub use crate::executor::*;
 
 #[cfg(feature = "wasi")]
 mod wasi;
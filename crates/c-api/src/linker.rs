@@ -98,6 +98,35 @@ pub unsafe extern "C" fn wasmtime_linker_define_func_unchecked(
     )
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_linker_define_func_native(
+    linker: &mut wasmtime_linker_t,
+    module: *const u8,
+    module_len: usize,
+    name: *const u8,
+    name_len: usize,
+    ty: &wasm_functype_t,
+    callback: crate::wasmtime_func_native_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut std::ffi::c_void)>,
+) -> Option<Box<wasmtime_error_t>> {
+    let ty = ty.ty().ty.clone();
+    // Created first so that `finalizer` runs on every error path, including
+    // invalid names.
+    let host = crate::func::NativeHost {
+        callback,
+        foreign: crate::ForeignData { data, finalizer },
+    };
+    let module = to_str!(module, module_len);
+    let name = to_str!(name, name_len);
+    let sink = crate::func::LinkerSink {
+        linker: &mut linker.linker,
+        module,
+        name,
+    };
+    handle_result(crate::func::linker_define_native(sink, &ty, host), |()| ())
+}
+
 #[cfg(feature = "wasi")]
 #[no_mangle]
 pub extern "C" fn wasmtime_linker_define_wasi(
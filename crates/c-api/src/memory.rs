@@ -2,8 +2,9 @@ use crate::{
     handle_result, wasm_extern_t, wasm_memorytype_t, wasm_store_t, wasmtime_error_t, CStoreContext,
     CStoreContextMut,
 };
+use anyhow::Result;
 use std::convert::TryFrom;
-use wasmtime::{Extern, Memory};
+use wasmtime::{Extern, Memory, Trap};
 
 #[derive(Clone)]
 #[repr(transparent)]
@@ -127,3 +128,153 @@ pub extern "C" fn wasmtime_memory_grow(
 ) -> Option<Box<wasmtime_error_t>> {
     handle_result(mem.grow(store, delta), |prev| *prev_size = prev)
 }
+
+/// A host view of a region of linear memory, layout-compatible with POSIX
+/// `struct iovec`.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct wasmtime_iovec_t {
+    pub base: *mut u8,
+    pub len: usize,
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_memory_iovecs(
+    store: CStoreContext<'_>,
+    mem: &Memory,
+    iovs: u64,
+    count: usize,
+    out: *mut wasmtime_iovec_t,
+) -> Option<Box<wasmtime_error_t>> {
+    let out = crate::slice_from_raw_parts_mut(out, count);
+    let base = mem.data_ptr(&store);
+    handle_result(guest_iovecs(mem.data(&store), base, iovs, out), |()| {})
+}
+
+/// Decodes the array of `out.len()` WASI-style iovecs, each a pair of
+/// little-endian `u32` pointer and length, located at `iovs` within `data`.
+fn guest_iovecs(data: &[u8], base: *mut u8, iovs: u64, out: &mut [wasmtime_iovec_t]) -> Result<()> {
+    const GUEST_IOVEC_SIZE: usize = 8;
+    let raw = usize::try_from(iovs)
+        .ok()
+        .and_then(|start| {
+            let end = out
+                .len()
+                .checked_mul(GUEST_IOVEC_SIZE)?
+                .checked_add(start)?;
+            data.get(start..end)
+        })
+        .ok_or(Trap::MemoryOutOfBounds)?;
+
+    for (raw, out) in raw.chunks_exact(GUEST_IOVEC_SIZE).zip(out) {
+        let buf = u32::from_le_bytes(raw[..4].try_into().unwrap()) as usize;
+        let buf_len = u32::from_le_bytes(raw[4..].try_into().unwrap()) as usize;
+        match buf.checked_add(buf_len) {
+            Some(end) if end <= data.len() => {}
+            _ => return Err(Trap::MemoryOutOfBounds.into()),
+        }
+        *out = wasmtime_iovec_t {
+            base: base.wrapping_add(buf),
+            len: buf_len,
+        };
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Returns 64 bytes of memory with the guest iovecs `iovs` at `at`.
+    fn memory(at: usize, iovs: &[(u32, u32)]) -> Vec<u8> {
+        let mut data = vec![0; 64];
+        for (i, (buf, buf_len)) in iovs.iter().enumerate() {
+            let raw = &mut data[at + i * 8..][..8];
+            raw[..4].copy_from_slice(&buf.to_le_bytes());
+            raw[4..].copy_from_slice(&buf_len.to_le_bytes());
+        }
+        data
+    }
+
+    fn empty() -> wasmtime_iovec_t {
+        wasmtime_iovec_t {
+            base: std::ptr::null_mut(),
+            len: 0,
+        }
+    }
+
+    fn is_out_of_bounds(result: Result<()>) -> bool {
+        matches!(
+            result.unwrap_err().downcast_ref::<Trap>(),
+            Some(Trap::MemoryOutOfBounds)
+        )
+    }
+
+    #[test]
+    fn decodes_iovecs() {
+        let mut data = memory(16, &[(0, 4), (40, 24), (64, 0)]);
+        let base = data.as_mut_ptr();
+        let mut out = [empty(); 3];
+        guest_iovecs(&data, base, 16, &mut out).unwrap();
+        let out = out.map(|iov| (iov.base as usize - base as usize, iov.len));
+        assert_eq!(out, [(0, 4), (40, 24), (64, 0)]);
+    }
+
+    #[test]
+    fn no_iovecs() {
+        let mut data = memory(0, &[]);
+        let base = data.as_mut_ptr();
+        guest_iovecs(&data, base, 64, &mut []).unwrap();
+    }
+
+    #[test]
+    fn iovec_array_out_of_bounds() {
+        let mut data = memory(48, &[(0, 1), (0, 1)]);
+        let base = data.as_mut_ptr();
+        // The third iovec would end 8 bytes past the end of memory.
+        let mut out = [empty(); 3];
+        assert!(is_out_of_bounds(guest_iovecs(&data, base, 48, &mut out)));
+        let mut out = [empty(); 1];
+        assert!(is_out_of_bounds(guest_iovecs(&data, base, 60, &mut out)));
+    }
+
+    #[test]
+    fn iovec_buffer_out_of_bounds() {
+        for iov in [(60, 5), (65, 0), (u32::MAX, 1), (1, u32::MAX)] {
+            let mut data = memory(0, &[(0, 1), iov]);
+            let base = data.as_mut_ptr();
+            let mut out = [empty(); 2];
+            assert!(is_out_of_bounds(guest_iovecs(&data, base, 0, &mut out)));
+        }
+    }
+
+    #[test]
+    fn iovec_buffer_end_overflows() {
+        // `buf + buf_len` overflows a `u32`, and a `usize` on 32-bit hosts.
+        let mut data = memory(0, &[(u32::MAX, u32::MAX)]);
+        let base = data.as_mut_ptr();
+        let mut out = [empty(); 1];
+        assert!(is_out_of_bounds(guest_iovecs(&data, base, 0, &mut out)));
+    }
+
+    #[test]
+    fn iovec_array_address_overflows() {
+        let mut data = memory(0, &[]);
+        let base = data.as_mut_ptr();
+        let mut out = [empty(); 1];
+        // Beyond `usize` on 32-bit hosts, and overflows the end of the array
+        // on 64-bit hosts.
+        assert!(is_out_of_bounds(guest_iovecs(
+            &data,
+            base,
+            u64::MAX,
+            &mut out
+        )));
+        assert!(is_out_of_bounds(guest_iovecs(
+            &data,
+            base,
+            u64::from(u32::MAX) + 1,
+            &mut out
+        )));
+    }
+}
@@ -5,7 +5,7 @@ use crate::{
 use anyhow::Context;
 use std::ffi::CStr;
 use std::os::raw::c_char;
-use wasmtime::{Engine, Module};
+use wasmtime::{Engine, Module, ModuleExport};
 
 #[derive(Clone)]
 pub struct wasm_module_t {
@@ -157,6 +157,23 @@ pub extern "C" fn wasmtime_module_exports(
     fill_exports(&module.module, out);
 }
 
+pub struct wasmtime_module_export_t {
+    pub(crate) export: ModuleExport,
+}
+
+wasmtime_c_api_macros::declare_own!(wasmtime_module_export_t);
+
+#[no_mangle]
+pub unsafe extern "C" fn wasmtime_module_export_index(
+    module: &wasmtime_module_t,
+    name: *const u8,
+    name_len: usize,
+) -> Option<Box<wasmtime_module_export_t>> {
+    let name = std::str::from_utf8(crate::slice_from_raw_parts(name, name_len)).ok()?;
+    let export = module.module.get_export_index(name)?;
+    Some(Box::new(wasmtime_module_export_t { export }))
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_module_imports(
     module: &wasmtime_module_t,
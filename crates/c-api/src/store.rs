@@ -83,6 +83,11 @@ pub struct StoreData {
 
     /// Limits for the store.
     pub store_limits: StoreLimits,
+
+    /// Incremented each time a linear memory in this store grows, read by
+    /// hosts through the pointer returned from
+    /// `wasmtime_context_memory_generation`.
+    pub memory_generation: u64,
 }
 
 #[no_mangle]
@@ -91,19 +96,20 @@ pub extern "C" fn wasmtime_store_new(
     data: *mut c_void,
     finalizer: Option<extern "C" fn(*mut c_void)>,
 ) -> Box<wasmtime_store_t> {
-    Box::new(wasmtime_store_t {
-        store: Store::new(
-            &engine.engine,
-            StoreData {
-                foreign: ForeignData { data, finalizer },
-                #[cfg(feature = "wasi")]
-                wasi: None,
-                hostcall_val_storage: Vec::new(),
-                wasm_val_storage: Vec::new(),
-                store_limits: StoreLimits::default(),
-            },
-        ),
-    })
+    let mut store = Store::new(
+        &engine.engine,
+        StoreData {
+            foreign: ForeignData { data, finalizer },
+            #[cfg(feature = "wasi")]
+            wasi: None,
+            hostcall_val_storage: Vec::new(),
+            wasm_val_storage: Vec::new(),
+            store_limits: StoreLimits::default(),
+            memory_generation: 0,
+        },
+    );
+    store.memory_grow_hook(|data| data.memory_generation += 1);
+    Box::new(wasmtime_store_t { store })
 }
 
 pub type wasmtime_update_deadline_kind_t = u8;
@@ -147,6 +153,23 @@ pub extern "C" fn wasmtime_store_epoch_deadline_callback(
     });
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_store_memory_grow_callback(
+    store: &mut wasmtime_store_t,
+    func: Option<extern "C" fn(*mut c_void)>,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    let foreign = crate::ForeignData { data, finalizer };
+    store.store.memory_grow_hook(move |data| {
+        let _ = &foreign; // Move foreign into this closure
+        data.memory_generation += 1;
+        if let Some(func) = func {
+            func(foreign.data);
+        }
+    });
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_store_context(store: &mut wasmtime_store_t) -> CStoreContextMut<'_> {
     store.store.as_context_mut()
@@ -191,6 +214,11 @@ pub extern "C" fn wasmtime_context_set_data(mut store: CStoreContextMut<'_>, dat
     store.data_mut().foreign.data = data;
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_context_memory_generation(store: CStoreContext<'_>) -> *const u64 {
+    &store.data().memory_generation
+}
+
 #[cfg(feature = "wasi")]
 #[no_mangle]
 pub extern "C" fn wasmtime_context_set_wasi(
@@ -202,11 +230,28 @@ pub extern "C" fn wasmtime_context_set_wasi(
     })
 }
 
+#[cfg(feature = "wasi")]
+#[no_mangle]
+pub extern "C" fn wasmtime_context_set_wasi_template(
+    mut context: CStoreContextMut<'_>,
+    template: &crate::wasi_ctx_template_t,
+) {
+    context.data_mut().wasi = Some(template.instantiate());
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_context_gc(mut context: CStoreContextMut<'_>) {
     context.gc();
 }
 
+#[no_mangle]
+pub extern "C" fn wasmtime_context_set_wasm_backtrace(
+    mut context: CStoreContextMut<'_>,
+    enable: bool,
+) {
+    context.set_wasm_backtrace(enable);
+}
+
 #[no_mangle]
 pub extern "C" fn wasmtime_context_set_fuel(
     mut store: CStoreContextMut<'_>,
@@ -197,3 +197,49 @@ pub extern "C" fn wasm_frame_module_offset(frame: &wasm_frame_t<'_>) -> usize {
 pub extern "C" fn wasm_frame_copy<'a>(frame: &wasm_frame_t<'a>) -> Box<wasm_frame_t<'a>> {
     Box::new(frame.clone())
 }
+
+#[no_mangle]
+#[cfg(feature = "coredump")]
+pub unsafe extern "C" fn wasmtime_trap_coredump_write(
+    trap: &wasm_trap_t,
+    store: crate::CStoreContextMut<'_>,
+    name: *const u8,
+    name_len: usize,
+    fd: std::os::raw::c_int,
+) -> Option<Box<crate::wasmtime_error_t>> {
+    let result = (|| {
+        let name = std::str::from_utf8(crate::slice_from_raw_parts(name, name_len))?;
+        let core_dump = trap
+            .error
+            .downcast_ref::<wasmtime::WasmCoreDump>()
+            .ok_or_else(|| anyhow!("trap does not have a core dump attached"))?;
+        write_core_dump(core_dump, store, name, fd)
+    })();
+    crate::handle_result(result, |()| {})
+}
+
+#[cfg(all(feature = "coredump", unix))]
+unsafe fn write_core_dump(
+    core_dump: &wasmtime::WasmCoreDump,
+    store: crate::CStoreContextMut<'_>,
+    name: &str,
+    fd: std::os::raw::c_int,
+) -> anyhow::Result<()> {
+    use std::os::unix::prelude::*;
+
+    // The descriptor is borrowed from the caller, so it must not be closed
+    // here.
+    let file = std::mem::ManuallyDrop::new(std::fs::File::from_raw_fd(fd));
+    core_dump.serialize_to(store, name, std::io::BufWriter::new(&*file))?;
+    Ok(())
+}
+
+#[cfg(all(feature = "coredump", not(unix)))]
+unsafe fn write_core_dump(
+    _core_dump: &wasmtime::WasmCoreDump,
+    _store: crate::CStoreContextMut<'_>,
+    _name: &str,
+    _fd: std::os::raw::c_int,
+) -> anyhow::Result<()> {
+    anyhow::bail!("writing core dumps to a file descriptor is not supported on this platform")
+}
@@ -3,13 +3,15 @@
 use crate::wasm_byte_vec_t;
 use anyhow::Result;
 use cap_std::ambient_authority;
-use std::collections::HashMap;
-use std::ffi::CStr;
+use std::collections::{HashMap, VecDeque};
+use std::ffi::{c_void, CStr};
 use std::fs::File;
+use std::io::{self, Read, Write};
 use std::os::raw::{c_char, c_int};
 use std::path::{Path, PathBuf};
 use std::slice;
-use wasi_common::pipe::ReadPipe;
+use std::sync::{Arc, Mutex};
+use wasi_common::pipe::{ReadPipe, WritePipe};
 use wasmtime_wasi::{
     sync::{Dir, TcpListener, WasiCtxBuilder},
     WasiCtx,
@@ -53,6 +55,56 @@ pub enum WasiConfigReadPipe {
     Inherit,
     File(File),
     Bytes(Vec<u8>),
+    Callback(InputCallback),
+    Span(BorrowedSpan),
+}
+
+pub type wasi_input_callback_t = extern "C" fn(*mut c_void, *mut u8, usize) -> isize;
+
+/// Guest input which is pulled from a C callback as the guest reads it.
+pub struct InputCallback {
+    callback: wasi_input_callback_t,
+    foreign: crate::ForeignData,
+}
+
+impl Read for InputCallback {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        match (self.callback)(self.foreign.data, buf.as_mut_ptr(), buf.len()) {
+            n if n < 0 => Err(io::Error::new(
+                io::ErrorKind::Other,
+                "stdin callback reported an error",
+            )),
+            n => Ok((n as usize).min(buf.len())),
+        }
+    }
+}
+
+/// Memory owned by the embedder which is released through the finalizer once
+/// nothing can read it any more.
+pub struct Span {
+    ptr: *const u8,
+    len: usize,
+    _foreign: crate::ForeignData,
+}
+
+// The span is required to remain valid and unmodified until it's released,
+// so it may be read from any thread.
+unsafe impl Send for Span {}
+unsafe impl Sync for Span {}
+
+/// Guest input read directly out of a [`Span`].
+pub struct BorrowedSpan {
+    span: Arc<Span>,
+    pos: usize,
+}
+
+impl Read for BorrowedSpan {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        let data = unsafe { crate::slice_from_raw_parts(self.span.ptr, self.span.len) };
+        let n = (&data[self.pos..]).read(buf)?;
+        self.pos += n;
+        Ok(n)
+    }
 }
 
 #[repr(C)]
@@ -62,6 +114,61 @@ pub enum WasiConfigWritePipe {
     None,
     Inherit,
     File(File),
+    Callback(OutputCallback),
+    RingBuffer(Arc<Mutex<RingBuffer>>),
+}
+
+pub type wasi_output_callback_t = extern "C" fn(*mut c_void, *const u8, usize);
+
+/// Guest output which is handed to a C callback as it's written.
+pub struct OutputCallback {
+    callback: wasi_output_callback_t,
+    foreign: crate::ForeignData,
+}
+
+impl Write for OutputCallback {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        (self.callback)(self.foreign.data, buf.as_ptr(), buf.len());
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        Ok(())
+    }
+}
+
+/// A bounded buffer of guest output which keeps the most recently written
+/// bytes, discarding the oldest ones once it's full.
+pub struct RingBuffer {
+    data: VecDeque<u8>,
+    capacity: usize,
+    overwritten: u64,
+}
+
+impl RingBuffer {
+    fn push(&mut self, mut buf: &[u8]) {
+        if buf.len() > self.capacity {
+            self.overwritten += (buf.len() - self.capacity) as u64;
+            buf = &buf[buf.len() - self.capacity..];
+        }
+        let excess = (self.data.len() + buf.len()).saturating_sub(self.capacity);
+        self.data.drain(..excess);
+        self.overwritten += excess as u64;
+        self.data.extend(buf);
+    }
+}
+
+struct RingBufferWriter(Arc<Mutex<RingBuffer>>);
+
+impl Write for RingBufferWriter {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        self.0.lock().unwrap().push(buf);
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        Ok(())
+    }
 }
 
 wasmtime_c_api_macros::declare_own!(wasi_config_t);
@@ -107,6 +214,12 @@ impl wasi_config_t {
                 let binary = ReadPipe::from(binary);
                 builder.stdin(Box::new(binary));
             }
+            WasiConfigReadPipe::Callback(callback) => {
+                builder.stdin(Box::new(ReadPipe::new(callback)));
+            }
+            WasiConfigReadPipe::Span(span) => {
+                builder.stdin(Box::new(ReadPipe::new(span)));
+            }
         };
         match self.stdout {
             WasiConfigWritePipe::None => {}
@@ -118,6 +231,12 @@ impl wasi_config_t {
                 let file = wasi_cap_std_sync::file::File::from_cap_std(file);
                 builder.stdout(Box::new(file));
             }
+            WasiConfigWritePipe::Callback(callback) => {
+                builder.stdout(Box::new(WritePipe::new(callback)));
+            }
+            WasiConfigWritePipe::RingBuffer(buffer) => {
+                builder.stdout(Box::new(WritePipe::new(RingBufferWriter(buffer))));
+            }
         };
         match self.stderr {
             WasiConfigWritePipe::None => {}
@@ -129,6 +248,12 @@ impl wasi_config_t {
                 let file = wasi_cap_std_sync::file::File::from_cap_std(file);
                 builder.stderr(Box::new(file));
             }
+            WasiConfigWritePipe::Callback(callback) => {
+                builder.stderr(Box::new(WritePipe::new(callback)));
+            }
+            WasiConfigWritePipe::RingBuffer(buffer) => {
+                builder.stderr(Box::new(WritePipe::new(RingBufferWriter(buffer))));
+            }
         };
         for (dir, path) in self.preopen_dirs {
             builder.preopened_dir(dir, path)?;
@@ -140,6 +265,62 @@ impl wasi_config_t {
     }
 }
 
+/// A WASI context which is set up once and then forked into a new context for
+/// each store, sharing its already-opened descriptors.
+pub struct wasi_ctx_template_t {
+    ctx: WasiCtx,
+    // Stdin read out of memory is given a fresh reader for each store, rather
+    // than being shared, so that every store sees the whole input.
+    stdin: Option<TemplateStdin>,
+}
+
+wasmtime_c_api_macros::declare_own!(wasi_ctx_template_t);
+
+enum TemplateStdin {
+    Bytes(Arc<[u8]>),
+    Span(Arc<Span>),
+}
+
+impl wasi_config_t {
+    pub fn into_wasi_ctx_template(mut self) -> Result<wasi_ctx_template_t> {
+        let stdin = match std::mem::take(&mut self.stdin) {
+            WasiConfigReadPipe::Bytes(binary) => Some(TemplateStdin::Bytes(binary.into())),
+            WasiConfigReadPipe::Span(span) => Some(TemplateStdin::Span(span.span)),
+            other => {
+                self.stdin = other;
+                None
+            }
+        };
+        Ok(wasi_ctx_template_t {
+            ctx: self.into_wasi_ctx()?,
+            stdin,
+        })
+    }
+}
+
+impl wasi_ctx_template_t {
+    pub fn instantiate(&self) -> WasiCtx {
+        let ctx = self.ctx.fork(
+            wasmtime_wasi::sync::random_ctx(),
+            wasmtime_wasi::sync::clocks_ctx(),
+            wasmtime_wasi::sync::sched_ctx(),
+        );
+        match &self.stdin {
+            None => {}
+            Some(TemplateStdin::Bytes(binary)) => {
+                ctx.set_stdin(Box::new(ReadPipe::new(io::Cursor::new(binary.clone()))));
+            }
+            Some(TemplateStdin::Span(span)) => {
+                ctx.set_stdin(Box::new(ReadPipe::new(BorrowedSpan {
+                    span: span.clone(),
+                    pos: 0,
+                })));
+            }
+        }
+        ctx
+    }
+}
+
 #[no_mangle]
 pub extern "C" fn wasi_config_new() -> Box<wasi_config_t> {
     Box::new(wasi_config_t::default())
@@ -217,6 +398,37 @@ pub unsafe extern "C" fn wasi_config_set_stdin_bytes(
     config.stdin = WasiConfigReadPipe::Bytes(binary);
 }
 
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stdin_callback(
+    config: &mut wasi_config_t,
+    callback: wasi_input_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    config.stdin = WasiConfigReadPipe::Callback(InputCallback {
+        callback,
+        foreign: crate::ForeignData { data, finalizer },
+    });
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stdin_span(
+    config: &mut wasi_config_t,
+    ptr: *const u8,
+    len: usize,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    config.stdin = WasiConfigReadPipe::Span(BorrowedSpan {
+        span: Arc::new(Span {
+            ptr,
+            len,
+            _foreign: crate::ForeignData { data, finalizer },
+        }),
+        pos: 0,
+    });
+}
+
 #[no_mangle]
 pub extern "C" fn wasi_config_inherit_stdin(config: &mut wasi_config_t) {
     config.stdin = WasiConfigReadPipe::Inherit;
@@ -262,6 +474,85 @@ pub extern "C" fn wasi_config_inherit_stderr(config: &mut wasi_config_t) {
     config.stderr = WasiConfigWritePipe::Inherit;
 }
 
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stdout_callback(
+    config: &mut wasi_config_t,
+    callback: wasi_output_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    config.stdout = WasiConfigWritePipe::Callback(OutputCallback {
+        callback,
+        foreign: crate::ForeignData { data, finalizer },
+    });
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stderr_callback(
+    config: &mut wasi_config_t,
+    callback: wasi_output_callback_t,
+    data: *mut c_void,
+    finalizer: Option<extern "C" fn(*mut c_void)>,
+) {
+    config.stderr = WasiConfigWritePipe::Callback(OutputCallback {
+        callback,
+        foreign: crate::ForeignData { data, finalizer },
+    });
+}
+
+pub struct wasi_ring_buffer_t {
+    buffer: Arc<Mutex<RingBuffer>>,
+}
+
+wasmtime_c_api_macros::declare_own!(wasi_ring_buffer_t);
+
+#[no_mangle]
+pub extern "C" fn wasi_ring_buffer_new(capacity: usize) -> Box<wasi_ring_buffer_t> {
+    Box::new(wasi_ring_buffer_t {
+        buffer: Arc::new(Mutex::new(RingBuffer {
+            data: VecDeque::with_capacity(capacity),
+            capacity,
+            overwritten: 0,
+        })),
+    })
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn wasi_ring_buffer_read(
+    buffer: &wasi_ring_buffer_t,
+    buf: *mut u8,
+    len: usize,
+) -> usize {
+    let buf = crate::slice_from_raw_parts_mut(buf, len);
+    let mut buffer = buffer.buffer.lock().unwrap();
+    let n = len.min(buffer.data.len());
+    for (dst, src) in buf.iter_mut().zip(buffer.data.drain(..n)) {
+        *dst = src;
+    }
+    n
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_ring_buffer_overwritten(buffer: &wasi_ring_buffer_t) -> u64 {
+    buffer.buffer.lock().unwrap().overwritten
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stdout_ring_buffer(
+    config: &mut wasi_config_t,
+    buffer: &wasi_ring_buffer_t,
+) {
+    config.stdout = WasiConfigWritePipe::RingBuffer(buffer.buffer.clone());
+}
+
+#[no_mangle]
+pub extern "C" fn wasi_config_set_stderr_ring_buffer(
+    config: &mut wasi_config_t,
+    buffer: &wasi_ring_buffer_t,
+) {
+    config.stderr = WasiConfigWritePipe::RingBuffer(buffer.buffer.clone());
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn wasi_config_preopen_dir(
     config: &mut wasi_config_t,
@@ -316,3 +607,148 @@ pub unsafe extern "C" fn wasi_config_preopen_socket(
 
     true
 }
+
+#[no_mangle]
+pub extern "C" fn wasi_ctx_template_new(
+    config: Box<wasi_config_t>,
+    out: &mut *mut wasi_ctx_template_t,
+) -> Option<Box<crate::wasmtime_error_t>> {
+    crate::handle_result(config.into_wasi_ctx_template(), |template| {
+        *out = Box::into_raw(Box::new(template));
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicUsize, Ordering::SeqCst};
+
+    extern "C" fn finalize(data: *mut c_void) {
+        unsafe { (*data.cast::<AtomicUsize>()).fetch_add(1, SeqCst) };
+    }
+
+    fn foreign(finalized: &AtomicUsize) -> crate::ForeignData {
+        crate::ForeignData {
+            data: finalized as *const AtomicUsize as *mut c_void,
+            finalizer: Some(finalize),
+        }
+    }
+
+    fn read_ring_buffer(buffer: &wasi_ring_buffer_t, len: usize) -> Vec<u8> {
+        let mut buf = vec![0; len];
+        let n = unsafe { wasi_ring_buffer_read(buffer, buf.as_mut_ptr(), len) };
+        buf.truncate(n);
+        buf
+    }
+
+    #[test]
+    fn ring_buffer_wraps_around() {
+        let buffer = wasi_ring_buffer_new(4);
+        let mut writer = RingBufferWriter(buffer.buffer.clone());
+
+        writer.write_all(b"ab").unwrap();
+        assert_eq!(wasi_ring_buffer_overwritten(&buffer), 0);
+        writer.write_all(b"cde").unwrap();
+        assert_eq!(wasi_ring_buffer_overwritten(&buffer), 1);
+        assert_eq!(read_ring_buffer(&buffer, 3), b"bcd");
+
+        // Reading frees up space, so this fits without overwriting.
+        writer.write_all(b"fgh").unwrap();
+        assert_eq!(wasi_ring_buffer_overwritten(&buffer), 1);
+        assert_eq!(read_ring_buffer(&buffer, 10), b"efgh");
+        assert_eq!(read_ring_buffer(&buffer, 10), b"");
+    }
+
+    #[test]
+    fn ring_buffer_counts_overwritten_bytes() {
+        let buffer = wasi_ring_buffer_new(4);
+        let mut writer = RingBufferWriter(buffer.buffer.clone());
+
+        // A write larger than the buffer keeps only its tail, and also
+        // displaces everything already buffered.
+        writer.write_all(b"xy").unwrap();
+        writer.write_all(b"abcdef").unwrap();
+        assert_eq!(wasi_ring_buffer_overwritten(&buffer), 4);
+        assert_eq!(read_ring_buffer(&buffer, 10), b"cdef");
+
+        let empty = wasi_ring_buffer_new(0);
+        let mut writer = RingBufferWriter(empty.buffer.clone());
+        writer.write_all(b"abc").unwrap();
+        assert_eq!(wasi_ring_buffer_overwritten(&empty), 3);
+        assert_eq!(read_ring_buffer(&empty, 10), b"");
+    }
+
+    #[test]
+    fn span_reads_to_eof_and_finalizes_once() {
+        let finalized = AtomicUsize::new(0);
+        let data = b"hello span";
+        let span = Arc::new(Span {
+            ptr: data.as_ptr(),
+            len: data.len(),
+            _foreign: foreign(&finalized),
+        });
+
+        // Every reader sees the whole span, as each store does.
+        for _ in 0..2 {
+            let mut reader = BorrowedSpan {
+                span: span.clone(),
+                pos: 0,
+            };
+            let mut buf = [0; 4];
+            assert_eq!(reader.read(&mut buf).unwrap(), 4);
+            assert_eq!(&buf, b"hell");
+            let mut rest = Vec::new();
+            reader.read_to_end(&mut rest).unwrap();
+            assert_eq!(rest, b"o span");
+            assert_eq!(reader.read(&mut buf).unwrap(), 0);
+        }
+
+        assert_eq!(finalized.load(SeqCst), 0);
+        drop(span);
+        assert_eq!(finalized.load(SeqCst), 1);
+    }
+
+    /// Returns the next value of the `VecDeque<isize>` at `data`, after
+    /// filling that many bytes of the buffer with `x`.
+    extern "C" fn scripted_input(data: *mut c_void, buf: *mut u8, len: usize) -> isize {
+        let script = unsafe { &mut *data.cast::<VecDeque<isize>>() };
+        let ret = script.pop_front().unwrap_or(0);
+        let n = usize::try_from(ret).unwrap_or(0).min(len);
+        unsafe { std::ptr::write_bytes(buf, b'x', n) };
+        ret
+    }
+
+    #[test]
+    fn input_callback_maps_eof_and_errors() {
+        let mut script = VecDeque::from([3, 100, -1, 0]);
+        let mut input = InputCallback {
+            callback: scripted_input,
+            foreign: crate::ForeignData {
+                data: &mut script as *mut VecDeque<isize> as *mut c_void,
+                finalizer: None,
+            },
+        };
+        let mut buf = [0; 8];
+        assert_eq!(input.read(&mut buf).unwrap(), 3);
+        // Counts larger than the buffer are clamped to it.
+        assert_eq!(input.read(&mut buf).unwrap(), 8);
+        let err = input.read(&mut buf).unwrap_err();
+        assert_eq!(err.kind(), io::ErrorKind::Other);
+        assert_eq!(input.read(&mut buf).unwrap(), 0);
+    }
+
+    #[test]
+    fn input_callback_finalizes_on_drop() {
+        let finalized = AtomicUsize::new(0);
+        let mut config = wasi_config_new();
+        wasi_config_set_stdin_callback(
+            &mut config,
+            scripted_input,
+            &finalized as *const AtomicUsize as *mut c_void,
+            Some(finalize),
+        );
+        assert_eq!(finalized.load(SeqCst), 0);
+        drop(config);
+        assert_eq!(finalized.load(SeqCst), 1);
+    }
+}
@@ -59,6 +59,10 @@ wasmtime_option_group! {
         /// memories.
         pub dynamic_memory_reserved_for_growth: Option<u64>,
 
+        /// Whether the reservation for growth of dynamic memories scales with
+        /// their size when they're relocated (default: no).
+        pub dynamic_memory_growth_geometric: Option<bool>,
+
         /// Enable the pooling allocator, in place of the on-demand allocator.
         pub pooling_allocator: Option<bool>,
 
@@ -265,6 +269,9 @@ wasmtime_option_group! {
         pub udp: Option<bool>,
         /// Allows imports from the `wasi_unstable` core wasm module.
         pub preview0: Option<bool>,
+        /// Coalesce the guest's writes to stdout and stderr in a buffer of
+        /// this many bytes, written out at least every 100ms (preview2 only).
+        pub stdio_buffer: Option<usize>,
     }
 
     enum Wasi {
@@ -490,6 +497,9 @@ impl CommonOptions {
         if let Some(size) = self.opts.dynamic_memory_reserved_for_growth {
             config.dynamic_memory_reserved_for_growth(size);
         }
+        if let Some(enable) = self.opts.dynamic_memory_growth_geometric {
+            config.dynamic_memory_growth_geometric(enable);
+        }
 
         // If fuel has been configured, set the `consume fuel` flag on the config.
         if self.wasm.fuel.is_some() {
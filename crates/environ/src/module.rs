@@ -17,6 +17,9 @@ pub enum MemoryStyle {
     Dynamic {
         /// Extra space to reserve when a memory must be moved due to growth.
         reserve: u64,
+        /// Whether the reservation made when a memory is moved due to growth
+        /// should also be at least as large as the memory's new size.
+        reserve_geometrically: bool,
     },
     /// Address space is allocated up front.
     Static {
@@ -62,6 +65,7 @@ impl MemoryStyle {
         (
             Self::Dynamic {
                 reserve: tunables.dynamic_memory_growth_reserve,
+                reserve_geometrically: tunables.dynamic_memory_growth_geometric,
             },
             tunables.dynamic_memory_offset_guard_size,
         )
@@ -19,6 +19,11 @@ pub struct Tunables {
     /// space not in use to grow into.
     pub dynamic_memory_growth_reserve: u64,
 
+    /// Whether the growth reservation of a "dynamic" memory scales with the
+    /// size of the memory when it's relocated, in addition to
+    /// `dynamic_memory_growth_reserve`.
+    pub dynamic_memory_growth_geometric: bool,
+
     /// Whether or not to generate native DWARF debug information.
     pub generate_native_debuginfo: bool,
 
@@ -102,6 +107,7 @@ impl Default for Tunables {
                 panic!("unsupported target_pointer_width");
             },
 
+            dynamic_memory_growth_geometric: false,
             generate_native_debuginfo: false,
             parse_wasm_debuginfo: true,
             consume_fuel: false,
@@ -160,6 +160,20 @@ impl<'a, Resume, Yield, Return> Fiber<'a, Resume, Yield, Return> {
     pub fn stack(&self) -> &FiberStack {
         &self.stack
     }
+
+    /// Consumes this fiber, returning the stack it executed on so that the
+    /// stack may be reused for another fiber.
+    ///
+    /// Like dropping a fiber, this should only be done once the fiber has
+    /// finished executing.
+    pub fn into_stack(self) -> FiberStack {
+        debug_assert!(self.done(), "fiber stack reclaimed without finishing");
+        let mut fiber = std::mem::ManuallyDrop::new(self);
+        unsafe {
+            std::ptr::drop_in_place(&mut fiber.inner);
+            std::ptr::read(&fiber.stack)
+        }
+    }
 }
 
 impl<Resume, Yield, Return> Suspend<Resume, Yield, Return> {
@@ -232,6 +246,21 @@ mod tests {
         assert!(hit.get());
     }
 
+    #[test]
+    fn reuse_stack() {
+        let mut stack = FiberStack::new(1024 * 1024).unwrap();
+        for i in 0..3 {
+            let fiber = Fiber::<i32, (), i32>::new(stack, |x, s| {
+                s.suspend(());
+                x + 1
+            })
+            .unwrap();
+            assert!(fiber.resume(i).is_err());
+            assert_eq!(fiber.resume(0).unwrap(), i + 1);
+            stack = fiber.into_stack();
+        }
+    }
+
     #[test]
     fn suspend_and_resume() {
         let hit = Rc::new(Cell::new(false));
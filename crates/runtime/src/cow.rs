@@ -837,7 +837,10 @@ mod test {
     #[test]
     #[cfg(target_os = "linux")]
     fn dynamic() {
-        let plan = dummy_memory_plan(MemoryStyle::Dynamic { reserve: 200 });
+        let plan = dummy_memory_plan(MemoryStyle::Dynamic {
+            reserve: 200,
+            reserve_geometrically: false,
+        });
 
         let mut mmap = Mmap::accessible_reserved(0, 4 << 20).unwrap();
         let mut memfd = MemoryImageSlot::create(mmap.as_mut_ptr() as *mut _, 0, 4 << 20);
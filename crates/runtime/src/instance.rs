@@ -12,8 +12,8 @@ use crate::vmcontext::{
     VMTableDefinition, VMTableImport,
 };
 use crate::{
-    ExportFunction, ExportGlobal, ExportMemory, ExportTable, Imports, ModuleRuntimeInfo,
-    SendSyncPtr, Store, VMFunctionBody, VMSharedSignatureIndex, WasmFault,
+    CompiledModuleId, ExportFunction, ExportGlobal, ExportMemory, ExportTable, Imports,
+    ModuleRuntimeInfo, SendSyncPtr, Store, VMFunctionBody, VMSharedSignatureIndex, WasmFault,
 };
 use anyhow::Error;
 use anyhow::Result;
@@ -618,13 +618,16 @@ impl Instance {
         let store = unsafe { &mut *self.store() };
         let memory = &mut self.memories[idx].1;
 
-        let result = unsafe { memory.grow(delta, Some(store)) };
+        let result = unsafe { memory.grow(delta, Some(&mut *store)) };
 
         // Update the state used by a non-shared Wasm memory in case the base
         // pointer and/or the length changed.
         if memory.as_shared_memory().is_none() {
             let vmmemory = memory.vmmemory();
             self.set_memory(idx, vmmemory);
+            if delta > 0 && matches!(result, Ok(Some(_))) {
+                store.memory_grown();
+            }
         }
 
         result
@@ -1313,6 +1316,11 @@ impl InstanceHandle {
         self.instance().module()
     }
 
+    /// Returns the unique id of the module this is an instance of, if any.
+    pub fn module_id(&self) -> Option<CompiledModuleId> {
+        self.instance().runtime_info.unique_id()
+    }
+
     /// Lookup a function by index.
     pub fn get_exported_func(&mut self, export: FuncIndex) -> ExportFunction {
         self.instance_mut().get_exported_func(export)
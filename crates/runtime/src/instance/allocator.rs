@@ -19,6 +19,8 @@ use wasmtime_environ::{
 };
 
 mod on_demand;
+#[cfg(feature = "async")]
+pub use self::on_demand::FiberStackCacheConfig;
 pub use self::on_demand::OnDemandInstanceAllocator;
 
 #[cfg(feature = "pooling-allocator")]
@@ -264,7 +266,7 @@ pub unsafe trait InstanceAllocatorImpl {
     /// The provided stack is required to have been allocated with
     /// `allocate_fiber_stack`.
     #[cfg(feature = "async")]
-    unsafe fn deallocate_fiber_stack(&self, stack: &wasmtime_fiber::FiberStack);
+    unsafe fn deallocate_fiber_stack(&self, stack: wasmtime_fiber::FiberStack);
 
     /// Purges all lingering resources related to `module` from within this
     /// allocator.
@@ -2,7 +2,7 @@ use super::{
     InstanceAllocationRequest, InstanceAllocatorImpl, MemoryAllocationIndex, TableAllocationIndex,
 };
 use crate::instance::RuntimeMemoryCreator;
-use crate::memory::{DefaultMemoryCreator, Memory};
+use crate::memory::{DefaultMemoryCreator, Memory, MmapReservationCache};
 use crate::mpk::ProtectionKey;
 use crate::table::Table;
 use crate::CompiledModuleId;
@@ -12,6 +12,8 @@ use wasmtime_environ::{
     DefinedMemoryIndex, DefinedTableIndex, HostPtr, MemoryPlan, Module, TablePlan, VMOffsets,
 };
 
+#[cfg(feature = "async")]
+use std::sync::Mutex;
 #[cfg(feature = "async")]
 use wasmtime_fiber::RuntimeFiberStackCreator;
 
@@ -25,10 +27,103 @@ use wasmtime_environ::{
 #[derive(Clone)]
 pub struct OnDemandInstanceAllocator {
     mem_creator: Option<Arc<dyn RuntimeMemoryCreator>>,
+    reservation_cache: Option<MmapReservationCache>,
     #[cfg(feature = "async")]
     stack_creator: Option<Arc<dyn RuntimeFiberStackCreator>>,
     #[cfg(feature = "async")]
     stack_size: usize,
+    #[cfg(feature = "async")]
+    stack_cache: Option<Arc<StackCache>>,
+}
+
+/// Configuration of the cache of fiber stacks kept by an
+/// [`OnDemandInstanceAllocator`] to avoid mapping a new stack for each async
+/// call.
+#[cfg(feature = "async")]
+#[derive(Copy, Clone, Debug, Default)]
+pub struct FiberStackCacheConfig {
+    /// The maximum number of unused stacks kept for reuse.
+    pub max_stacks: usize,
+    /// Whether stacks are reset to zero before being reused.
+    pub async_stack_zeroing: bool,
+    /// How many bytes at the top of each stack are zeroed manually, and kept
+    /// resident, when `async_stack_zeroing` is enabled. The rest of the stack
+    /// is decommitted.
+    pub async_stack_keep_resident: usize,
+}
+
+/// Unused fiber stacks shared by all clones of an allocator.
+#[cfg(feature = "async")]
+struct StackCache {
+    stacks: Mutex<Vec<CachedStack>>,
+    config: FiberStackCacheConfig,
+}
+
+/// A fiber stack which isn't being used by any fiber.
+#[cfg(feature = "async")]
+struct CachedStack(wasmtime_fiber::FiberStack);
+
+// Safety: stacks in the cache aren't in use, so nothing references the memory
+// they point to.
+#[cfg(feature = "async")]
+unsafe impl Send for CachedStack {}
+
+#[cfg(feature = "async")]
+impl StackCache {
+    fn pop(&self) -> Option<wasmtime_fiber::FiberStack> {
+        self.stacks.lock().unwrap().pop().map(|s| s.0)
+    }
+
+    fn push(&self, stack: wasmtime_fiber::FiberStack) {
+        if self.stacks.lock().unwrap().len() >= self.config.max_stacks {
+            return;
+        }
+        // Only stacks which know where they live in memory can be reset;
+        // others, such as Windows' native fiber stacks, are freed instead.
+        let range = match stack.range() {
+            Some(range) => range,
+            None => return,
+        };
+        if self.config.async_stack_zeroing
+            && !Self::zero_stack(range, self.config.async_stack_keep_resident)
+        {
+            return;
+        }
+        let mut stacks = self.stacks.lock().unwrap();
+        if stacks.len() < self.config.max_stacks {
+            stacks.push(CachedStack(stack));
+        }
+    }
+
+    /// Resets the usable portion of the stack in `range` to zero, returning
+    /// whether this was successful.
+    fn zero_stack(range: std::ops::Range<usize>, keep_resident: usize) -> bool {
+        cfg_if::cfg_if! {
+            if #[cfg(all(unix, not(miri)))] {
+                // Skip the guard page at the bottom of the stack, then, as
+                // the pooling allocator does, manually zero the top of the
+                // stack to keep it resident and leave the rest to the system.
+                let bottom = range.start + crate::page_size();
+                let size = range.end.saturating_sub(bottom);
+                let size_to_memset = size.min(keep_resident);
+                unsafe {
+                    std::ptr::write_bytes(
+                        (bottom + size - size_to_memset) as *mut u8,
+                        0,
+                        size_to_memset,
+                    );
+                    crate::sys::vm::reset_stack_pages_to_zero(
+                        bottom as _,
+                        size - size_to_memset,
+                    )
+                    .is_ok()
+                }
+            } else {
+                let _ = (range, keep_resident);
+                false
+            }
+        }
+    }
 }
 
 impl OnDemandInstanceAllocator {
@@ -37,28 +132,62 @@ impl OnDemandInstanceAllocator {
         let _ = stack_size; // suppress warnings when async feature is disabled.
         Self {
             mem_creator,
+            reservation_cache: None,
             #[cfg(feature = "async")]
             stack_creator: None,
             #[cfg(feature = "async")]
             stack_size,
+            #[cfg(feature = "async")]
+            stack_cache: None,
         }
     }
 
+    /// Keep the address space reservations of up to `max_reservations`
+    /// dropped linear memories for reuse by later memories.
+    ///
+    /// This has no effect when a custom memory creator is in use.
+    pub fn set_memory_reservation_cache(&mut self, max_reservations: usize) {
+        self.reservation_cache = if max_reservations == 0 {
+            None
+        } else {
+            Some(MmapReservationCache::new(max_reservations))
+        };
+    }
+
     /// Set the stack creator.
     #[cfg(feature = "async")]
     pub fn set_stack_creator(&mut self, stack_creator: Arc<dyn RuntimeFiberStackCreator>) {
         self.stack_creator = Some(stack_creator);
     }
+
+    /// Keep up to `config.max_stacks` fiber stacks around after async calls
+    /// complete so that later calls can reuse them.
+    ///
+    /// Stacks from a custom stack creator are never cached.
+    #[cfg(feature = "async")]
+    pub fn set_stack_cache(&mut self, config: FiberStackCacheConfig) {
+        self.stack_cache = if config.max_stacks == 0 {
+            None
+        } else {
+            Some(Arc::new(StackCache {
+                stacks: Mutex::new(Vec::new()),
+                config,
+            }))
+        };
+    }
 }
 
 impl Default for OnDemandInstanceAllocator {
     fn default() -> Self {
         Self {
             mem_creator: None,
+            reservation_cache: None,
             #[cfg(feature = "async")]
             stack_creator: None,
             #[cfg(feature = "async")]
             stack_size: 0,
+            #[cfg(feature = "async")]
+            stack_cache: None,
         }
     }
 }
@@ -96,10 +225,12 @@ unsafe impl InstanceAllocatorImpl for OnDemandInstanceAllocator {
         memory_plan: &MemoryPlan,
         memory_index: DefinedMemoryIndex,
     ) -> Result<(MemoryAllocationIndex, Memory)> {
-        let creator = self
-            .mem_creator
-            .as_deref()
-            .unwrap_or_else(|| &DefaultMemoryCreator);
+        let creator: &dyn RuntimeMemoryCreator = match (&self.mem_creator, &self.reservation_cache)
+        {
+            (Some(creator), _) => &**creator,
+            (None, Some(cache)) => cache,
+            (None, None) => &DefaultMemoryCreator,
+        };
         let image = request.runtime_info.memory_image(memory_index)?;
         let allocation_index = MemoryAllocationIndex::default();
         let memory = Memory::new_dynamic(
@@ -161,14 +292,22 @@ unsafe impl InstanceAllocatorImpl for OnDemandInstanceAllocator {
                 let stack = stack_creator.new_stack(self.stack_size)?;
                 wasmtime_fiber::FiberStack::from_custom(stack)
             }
-            None => wasmtime_fiber::FiberStack::new(self.stack_size),
+            None => {
+                if let Some(stack) = self.stack_cache.as_ref().and_then(|c| c.pop()) {
+                    return Ok(stack);
+                }
+                wasmtime_fiber::FiberStack::new(self.stack_size)
+            }
         }?;
         Ok(stack)
     }
 
     #[cfg(feature = "async")]
-    unsafe fn deallocate_fiber_stack(&self, _stack: &wasmtime_fiber::FiberStack) {
-        // The on-demand allocator has no further bookkeeping for fiber stacks
+    unsafe fn deallocate_fiber_stack(&self, stack: wasmtime_fiber::FiberStack) {
+        // Stacks which aren't cached are unmapped when dropped.
+        if let (None, Some(cache)) = (&self.stack_creator, &self.stack_cache) {
+            cache.push(stack);
+        }
     }
 
     fn purge_module(&self, _: CompiledModuleId) {}
@@ -526,13 +526,13 @@ unsafe impl InstanceAllocatorImpl for PoolingInstanceAllocator {
     }
 
     #[cfg(feature = "async")]
-    unsafe fn deallocate_fiber_stack(&self, stack: &wasmtime_fiber::FiberStack) {
+    unsafe fn deallocate_fiber_stack(&self, stack: wasmtime_fiber::FiberStack) {
         cfg_if::cfg_if! {
             if #[cfg(miri)] {
                 let _ = stack;
                 unimplemented!()
             } else if #[cfg(unix)] {
-                self.stacks.deallocate(stack);
+                self.stacks.deallocate(&stack);
             } else if #[cfg(windows)] {
                 self.live_stacks.fetch_sub(1, Ordering::AcqRel);
                 // A no-op as we don't own the fiber stack on Windows.
@@ -615,7 +615,7 @@ mod test {
                 assert_eq!(*addr, 0);
                 *addr = 1;
 
-                allocator.deallocate_fiber_stack(&stack);
+                allocator.deallocate_fiber_stack(stack);
             }
         }
 
@@ -649,7 +649,7 @@ mod test {
                 assert_eq!(*addr, i);
                 *addr = i + 1;
 
-                allocator.deallocate_fiber_stack(&stack);
+                allocator.deallocate_fiber_stack(stack);
             }
         }
 
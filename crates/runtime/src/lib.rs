@@ -40,6 +40,8 @@ pub use crate::arch::{get_stack_pointer, V128Abi};
 pub use crate::export::*;
 pub use crate::externref::*;
 pub use crate::imports::Imports;
+#[cfg(feature = "async")]
+pub use crate::instance::FiberStackCacheConfig;
 pub use crate::instance::{
     Instance, InstanceAllocationRequest, InstanceAllocator, InstanceAllocatorImpl, InstanceHandle,
     MemoryAllocationIndex, OnDemandInstanceAllocator, StorePtr, TableAllocationIndex,
@@ -49,7 +51,8 @@ pub use crate::instance::{
     InstanceLimits, PoolingInstanceAllocator, PoolingInstanceAllocatorConfig,
 };
 pub use crate::memory::{
-    DefaultMemoryCreator, Memory, RuntimeLinearMemory, RuntimeMemoryCreator, SharedMemory,
+    DefaultMemoryCreator, Memory, MmapReservationCache, RuntimeLinearMemory, RuntimeMemoryCreator,
+    SharedMemory,
 };
 pub use crate::mmap::Mmap;
 pub use crate::mmap_vec::MmapVec;
@@ -123,6 +126,12 @@ pub unsafe trait Store {
     ///
     /// Note that this is not invoked if `memory_growing` returns an error.
     fn memory_grow_failed(&mut self, error: Error) -> Result<()>;
+    /// Callback invoked after a memory grow operation by a nonzero number of
+    /// pages has succeeded and the memory's new base pointer and length are
+    /// visible through its `VMMemoryDefinition`.
+    ///
+    /// Note that this is not invoked for growth of shared memories.
+    fn memory_grown(&mut self);
     /// Callback invoked to allow the store's resource limiter to reject a
     /// table grow operation.
     fn table_growing(
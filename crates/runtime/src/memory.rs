@@ -9,11 +9,12 @@ use crate::{MemoryImage, MemoryImageSlot, SendSyncPtr, Store, WaitResult};
 use anyhow::Error;
 use anyhow::{bail, format_err, Result};
 use std::cell::RefCell;
+use std::collections::HashMap;
 use std::convert::TryFrom;
 use std::ops::Range;
 use std::ptr::NonNull;
 use std::sync::atomic::{AtomicU32, AtomicU64, Ordering};
-use std::sync::{Arc, RwLock};
+use std::sync::{Arc, Mutex, RwLock};
 use std::time::Instant;
 use wasmtime_environ::{MemoryPlan, MemoryStyle, Trap, WASM32_MAX_PAGES, WASM64_MAX_PAGES};
 
@@ -54,6 +55,114 @@ impl RuntimeMemoryCreator for DefaultMemoryCreator {
     }
 }
 
+/// A memory allocator which creates the same memories as
+/// [`DefaultMemoryCreator`] but keeps the address space reservations of
+/// dropped memories for reuse.
+///
+/// Linear memories typically reserve multi-GiB regions of address space,
+/// and creating and releasing these mappings contends on process-wide locks
+/// in the kernel and requires TLB shootdowns. Reservations returned to this
+/// cache have their accessible pages decommitted but are otherwise left
+/// mapped, and are handed out again to memories which need a reservation of
+/// exactly the same size.
+#[derive(Clone)]
+pub struct MmapReservationCache(Arc<ReservationCacheInner>);
+
+struct ReservationCacheInner {
+    max_reservations: usize,
+    reservations: Mutex<Reservations>,
+}
+
+#[derive(Default)]
+struct Reservations {
+    by_size: HashMap<usize, Vec<Mmap>>,
+    count: usize,
+}
+
+impl MmapReservationCache {
+    /// Creates a cache which holds at most `max_reservations` unused
+    /// reservations at a time.
+    pub fn new(max_reservations: usize) -> Self {
+        Self(Arc::new(ReservationCacheInner {
+            max_reservations,
+            reservations: Mutex::new(Reservations::default()),
+        }))
+    }
+
+    /// Returns the number of unused reservations currently in this cache.
+    pub fn len(&self) -> usize {
+        self.0.reservations.lock().unwrap().count
+    }
+
+    /// Returns a completely inaccessible reservation of `size` bytes, reusing
+    /// a cached one if possible.
+    fn reserve(&self, size: usize) -> Result<Mmap> {
+        let cached = {
+            let mut reservations = self.0.reservations.lock().unwrap();
+            let mmap = reservations.by_size.get_mut(&size).and_then(|v| v.pop());
+            if mmap.is_some() {
+                reservations.count -= 1;
+                if reservations.by_size[&size].is_empty() {
+                    reservations.by_size.remove(&size);
+                }
+            }
+            mmap
+        };
+        match cached {
+            Some(mmap) => Ok(mmap),
+            None => Mmap::accessible_reserved(0, size),
+        }
+    }
+
+    /// Returns `mmap` to this cache after making the `accessible` range of it
+    /// inaccessible again. The reservation is unmapped instead if the cache
+    /// is full.
+    ///
+    /// # Safety
+    ///
+    /// Nothing may reference the memory in `mmap`, and all of it outside of
+    /// `accessible` must already be inaccessible.
+    unsafe fn recycle(&self, mut mmap: Mmap, accessible: Range<usize>) {
+        if mmap.is_empty() || mmap.original_file().is_some() {
+            return;
+        }
+        if self.len() >= self.0.max_reservations {
+            return;
+        }
+        if let Err(e) = mmap.make_inaccessible(accessible.start, accessible.len()) {
+            log::trace!("failed to recycle memory reservation: {e:?}");
+            return;
+        }
+        let mut reservations = self.0.reservations.lock().unwrap();
+        if reservations.count < self.0.max_reservations {
+            reservations.count += 1;
+            reservations
+                .by_size
+                .entry(mmap.len())
+                .or_default()
+                .push(mmap);
+        }
+    }
+}
+
+impl RuntimeMemoryCreator for MmapReservationCache {
+    fn new_memory(
+        &self,
+        plan: &MemoryPlan,
+        minimum: usize,
+        maximum: Option<usize>,
+        memory_image: Option<&Arc<MemoryImage>>,
+    ) -> Result<Box<dyn RuntimeLinearMemory>> {
+        Ok(Box::new(MmapMemory::new_with_cache(
+            plan,
+            minimum,
+            maximum,
+            memory_image,
+            Some(self),
+        )?))
+    }
+}
+
 /// A linear memory
 pub trait RuntimeLinearMemory: Send + Sync {
     /// Returns the number of allocated bytes.
@@ -185,6 +294,10 @@ pub struct MmapMemory {
     // specified so that the cost of repeated growth is amortized.
     extra_to_reserve_on_growth: usize,
 
+    // Whether to additionally reserve space proportional to the new size of
+    // memory whenever it's relocated due to growth.
+    reserve_geometrically: bool,
+
     // Size in bytes of extra guard pages before the start and after the end to
     // optimize loads and stores with constant offsets.
     pre_guard_size: usize,
@@ -193,16 +306,32 @@ pub struct MmapMemory {
     // An optional CoW mapping that provides the initial content of this
     // MmapMemory, if mapped.
     memory_image: Option<MemoryImageSlot>,
+
+    // Where to return `mmap` once it's no longer used, instead of unmapping
+    // it.
+    reservation_cache: Option<MmapReservationCache>,
 }
 
 impl MmapMemory {
     /// Create a new linear memory instance with specified minimum and maximum
     /// number of wasm pages.
     pub fn new(
+        plan: &MemoryPlan,
+        minimum: usize,
+        maximum: Option<usize>,
+        memory_image: Option<&Arc<MemoryImage>>,
+    ) -> Result<Self> {
+        Self::new_with_cache(plan, minimum, maximum, memory_image, None)
+    }
+
+    /// Same as [`MmapMemory::new`], but address space reservations are taken
+    /// from, and returned to, `reservation_cache` if provided.
+    pub fn new_with_cache(
         plan: &MemoryPlan,
         minimum: usize,
         mut maximum: Option<usize>,
         memory_image: Option<&Arc<MemoryImage>>,
+        reservation_cache: Option<&MmapReservationCache>,
     ) -> Result<Self> {
         // It's a programmer error for these two configuration values to exceed
         // the host available address space, so panic if such a configuration is
@@ -210,10 +339,17 @@ impl MmapMemory {
         let offset_guard_bytes = usize::try_from(plan.offset_guard_size).unwrap();
         let pre_guard_bytes = usize::try_from(plan.pre_guard_size).unwrap();
 
-        let (alloc_bytes, extra_to_reserve_on_growth) = match plan.style {
+        let (alloc_bytes, extra_to_reserve_on_growth, reserve_geometrically) = match plan.style {
             // Dynamic memories start with the minimum size plus the `reserve`
             // amount specified to grow into.
-            MemoryStyle::Dynamic { reserve } => (minimum, usize::try_from(reserve).unwrap()),
+            MemoryStyle::Dynamic {
+                reserve,
+                reserve_geometrically,
+            } => (
+                minimum,
+                usize::try_from(reserve).unwrap(),
+                reserve_geometrically,
+            ),
 
             // Static memories will never move in memory and consequently get
             // their entire allocation up-front with no extra room to grow into.
@@ -225,7 +361,7 @@ impl MmapMemory {
                 let bound_bytes =
                     usize::try_from(bound.checked_mul(WASM_PAGE_SIZE_U64).unwrap()).unwrap();
                 maximum = Some(bound_bytes.min(maximum.unwrap_or(usize::MAX)));
-                (bound_bytes, 0)
+                (bound_bytes, 0, false)
             }
         };
 
@@ -234,7 +370,10 @@ impl MmapMemory {
             .and_then(|i| i.checked_add(extra_to_reserve_on_growth))
             .and_then(|i| i.checked_add(offset_guard_bytes))
             .ok_or_else(|| format_err!("cannot allocate {} with guard regions", minimum))?;
-        let mut mmap = Mmap::accessible_reserved(0, request_bytes)?;
+        let mut mmap = match reservation_cache {
+            Some(cache) => cache.reserve(request_bytes)?,
+            None => Mmap::accessible_reserved(0, request_bytes)?,
+        };
 
         if minimum > 0 {
             mmap.make_accessible(pre_guard_bytes, minimum)?;
@@ -267,9 +406,29 @@ impl MmapMemory {
             pre_guard_size: pre_guard_bytes,
             offset_guard_size: offset_guard_bytes,
             extra_to_reserve_on_growth,
+            reserve_geometrically,
             memory_image,
+            reservation_cache: reservation_cache.cloned(),
         })
     }
+
+    fn accessible_range(&self) -> Range<usize> {
+        self.pre_guard_size..self.pre_guard_size + self.accessible
+    }
+}
+
+impl Drop for MmapMemory {
+    fn drop(&mut self) {
+        if let Some(cache) = &self.reservation_cache {
+            // Any CoW mapping lies within the accessible range, which is reset
+            // when the reservation is recycled.
+            drop(self.memory_image.take());
+            let mmap = std::mem::replace(&mut self.mmap, Mmap::new_empty());
+            unsafe {
+                cache.recycle(mmap, self.accessible_range());
+            }
+        }
+    }
 }
 
 impl RuntimeLinearMemory for MmapMemory {
@@ -286,35 +445,80 @@ impl RuntimeLinearMemory for MmapMemory {
             // If the new size of this heap exceeds the current size of the
             // allocation we have, then this must be a dynamic heap. Use
             // `new_size` to calculate a new size of an allocation, allocate it,
-            // and then copy over the memory from before.
+            // and then move over the memory from before.
+            let extra_to_reserve_on_growth = if self.reserve_geometrically {
+                // Reserve at least as much again as the new size so the
+                // number of relocations is logarithmic in the final size,
+                // but never beyond what the maximum permits.
+                let max_extra = match self.maximum {
+                    Some(max) => max.saturating_sub(new_size),
+                    None => usize::MAX,
+                };
+                self.extra_to_reserve_on_growth.max(new_size.min(max_extra))
+            } else {
+                self.extra_to_reserve_on_growth
+            };
             let request_bytes = self
                 .pre_guard_size
                 .checked_add(new_size)
-                .and_then(|s| s.checked_add(self.extra_to_reserve_on_growth))
+                .and_then(|s| s.checked_add(extra_to_reserve_on_growth))
                 .and_then(|s| s.checked_add(self.offset_guard_size))
                 .ok_or_else(|| format_err!("overflow calculating size of memory allocation"))?;
 
-            let mut new_mmap = Mmap::accessible_reserved(0, request_bytes)?;
-            new_mmap.make_accessible(self.pre_guard_size, new_size)?;
+            let mut new_mmap = match &self.reservation_cache {
+                Some(cache) => cache.reserve(request_bytes)?,
+                None => Mmap::accessible_reserved(0, request_bytes)?,
+            };
+            let range = self.accessible_range();
 
+            // Where supported, move the existing pages into the new mapping
+            // rather than copying them, which avoids both the copy itself and
+            // having two copies of the heap resident at once.
+            //
             // This method has an exclusive reference to `self.mmap` and just
-            // created `new_mmap` so it should be safe to acquire references
-            // into both of them and copy between them.
-            unsafe {
-                let range = self.pre_guard_size..self.pre_guard_size + self.accessible;
-                let src = self.mmap.slice(range.clone());
-                let dst = new_mmap.slice_mut(range);
-                dst.copy_from_slice(src);
+            // created `new_mmap` so nothing else can be referencing either.
+            let moved = self.accessible > 0
+                && match unsafe { self.mmap.move_pages_into(range.clone(), &mut new_mmap) } {
+                    Ok(moved) => moved,
+                    Err(e) => {
+                        // A failed move may have left a hole in `new_mmap`, so
+                        // start over with a fresh reservation and copy instead.
+                        log::trace!("falling back to copying memory on growth: {e:?}");
+                        new_mmap = Mmap::accessible_reserved(0, request_bytes)?;
+                        false
+                    }
+                };
+
+            if moved {
+                new_mmap.make_accessible(
+                    self.pre_guard_size + self.accessible,
+                    new_size - self.accessible,
+                )?;
+            } else {
+                new_mmap.make_accessible(self.pre_guard_size, new_size)?;
+
+                // See above for why it's safe to acquire references into both
+                // `self.mmap` and `new_mmap` here.
+                unsafe {
+                    let src = self.mmap.slice(range.clone());
+                    let dst = new_mmap.slice_mut(range);
+                    dst.copy_from_slice(src);
+                }
             }
 
             // Now drop the MemoryImageSlot, if any. We've lost the CoW
-            // advantages by explicitly copying all data, but we have
-            // preserved all of its content; so we no longer need the
+            // advantages by explicitly moving or copying all data, but we
+            // have preserved all of its content; so we no longer need the
             // mapping. We need to do this before we (implicitly) drop the
             // `mmap` field by overwriting it below.
             drop(self.memory_image.take());
 
-            self.mmap = new_mmap;
+            let old_mmap = std::mem::replace(&mut self.mmap, new_mmap);
+            if let Some(cache) = &self.reservation_cache {
+                unsafe {
+                    cache.recycle(old_mmap, self.accessible_range());
+                }
+            }
         } else if let Some(image) = self.memory_image.as_mut() {
             // MemoryImageSlot has its own growth mechanisms; defer to its
             // implementation.
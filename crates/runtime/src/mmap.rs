@@ -17,6 +17,14 @@ pub struct Mmap {
 }
 
 impl Mmap {
+    /// Create a new `Mmap` which doesn't map any memory.
+    pub fn new_empty() -> Self {
+        Mmap {
+            sys: mmap::Mmap::new_empty(),
+            file: None,
+        }
+    }
+
     /// Create a new `Mmap` pointing to at least `size` bytes of page-aligned
     /// accessible memory.
     pub fn with_at_least(size: usize) -> Result<Self> {
@@ -57,10 +65,7 @@ impl Mmap {
         assert_eq!(accessible_size & (page_size - 1), 0);
 
         if mapping_size == 0 {
-            Ok(Mmap {
-                sys: mmap::Mmap::new_empty(),
-                file: None,
-            })
+            Ok(Mmap::new_empty())
         } else if accessible_size == mapping_size {
             Ok(Mmap {
                 sys: mmap::Mmap::new(mapping_size)
@@ -100,6 +105,68 @@ impl Mmap {
         self.sys.make_accessible(start, len)
     }
 
+    /// Makes the memory starting at `start` and extending for `len` bytes
+    /// inaccessible again, discarding its contents so that it reads as zero
+    /// if it's later made accessible. The range remains reserved.
+    ///
+    /// # Safety
+    ///
+    /// The caller must ensure that nothing else is referencing the pages in
+    /// the range.
+    ///
+    /// # Panics
+    ///
+    /// This function will panic if `start` or `len` is not page aligned or if
+    /// either are outside the bounds of this mapping.
+    pub unsafe fn make_inaccessible(&mut self, start: usize, len: usize) -> Result<()> {
+        let page_size = crate::page_size();
+        assert_eq!(start & (page_size - 1), 0);
+        assert_eq!(len & (page_size - 1), 0);
+        assert!(len <= self.len());
+        assert!(start <= self.len() - len);
+
+        if len == 0 {
+            return Ok(());
+        }
+        crate::sys::vm::erase_existing_mapping(self.as_mut_ptr().add(start), len)
+            .context("failed to make memory inaccessible")
+    }
+
+    /// Moves the pages backing `range` of this mapping to the same offsets
+    /// within `dst` without copying their contents.
+    ///
+    /// Returns `Ok(false)` if the platform has no support for moving pages, in
+    /// which case neither mapping has been modified. After a successful move
+    /// the pages in `range` of `self` remain mapped but are no longer
+    /// accessible with their previous contents.
+    ///
+    /// # Errors
+    ///
+    /// If an error is returned then `dst` may no longer have a mapping for
+    /// `range` and must be discarded. The contents of `self` are unchanged.
+    ///
+    /// # Safety
+    ///
+    /// The caller must ensure that nothing else is referencing the pages in
+    /// `range` of either mapping.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `range` is not page-aligned or is outside of the limits of
+    /// either mapping.
+    pub unsafe fn move_pages_into(&mut self, range: Range<usize>, dst: &mut Mmap) -> Result<bool> {
+        let page_size = crate::page_size();
+        assert!(range.start <= range.end);
+        assert!(range.end <= self.len());
+        assert!(range.end <= dst.len());
+        assert_eq!(range.start & (page_size - 1), 0);
+        assert_eq!(range.end & (page_size - 1), 0);
+
+        self.sys
+            .move_pages_into(range, &mut dst.sys)
+            .context("failed to move pages between mappings")
+    }
+
     /// Return the allocated memory as a slice of u8.
     ///
     /// # Safety
@@ -56,6 +56,14 @@ impl Mmap {
         Ok(())
     }
 
+    pub unsafe fn move_pages_into(
+        &mut self,
+        _range: Range<usize>,
+        _dst: &mut Mmap,
+    ) -> Result<bool> {
+        Ok(false)
+    }
+
     pub fn as_ptr(&self) -> *const u8 {
         self.memory.as_ptr() as *const u8
     }
@@ -84,6 +84,37 @@ impl Mmap {
         Ok(())
     }
 
+    #[cfg(target_os = "linux")]
+    pub unsafe fn move_pages_into(&mut self, range: Range<usize>, dst: &mut Mmap) -> Result<bool> {
+        use rustix::mm::MremapFlags;
+
+        // `MREMAP_DONTUNMAP` leaves the source range mapped (but empty) so no
+        // hole is left in this reservation for an unrelated `mmap` to land in
+        // before this mapping is dropped. It's only available on Linux 5.7+
+        // and older kernels will return an error here, so callers fall back
+        // to copying.
+        let len = range.end - range.start;
+        let src = self.memory.as_ptr().cast::<u8>().add(range.start);
+        let dst = dst.memory.as_ptr().cast::<u8>().add(range.start);
+        rustix::mm::mremap_fixed(
+            src.cast(),
+            len,
+            len,
+            MremapFlags::MAYMOVE | MremapFlags::DONTUNMAP,
+            dst.cast(),
+        )?;
+        Ok(true)
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    pub unsafe fn move_pages_into(
+        &mut self,
+        _range: Range<usize>,
+        _dst: &mut Mmap,
+    ) -> Result<bool> {
+        Ok(false)
+    }
+
     #[inline]
     pub fn as_ptr(&self) -> *const u8 {
         self.memory.as_ptr() as *const u8
@@ -25,7 +25,7 @@ pub unsafe fn erase_existing_mapping(ptr: *mut u8, len: usize) -> io::Result<()>
     Ok(())
 }
 
-#[cfg(feature = "pooling-allocator")]
+#[cfg(any(feature = "pooling-allocator", feature = "async"))]
 unsafe fn decommit(addr: *mut u8, len: usize) -> io::Result<()> {
     if len == 0 {
         return Ok(());
@@ -76,7 +76,7 @@ pub unsafe fn commit_stack_pages(_addr: *mut u8, _len: usize) -> io::Result<()>
     Ok(())
 }
 
-#[cfg(all(feature = "pooling-allocator", feature = "async"))]
+#[cfg(feature = "async")]
 pub unsafe fn reset_stack_pages_to_zero(addr: *mut u8, len: usize) -> io::Result<()> {
     decommit(addr, len)
 }
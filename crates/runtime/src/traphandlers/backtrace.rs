@@ -25,11 +25,20 @@ use crate::{
     traphandlers::{tls, CallThreadState},
     VMRuntimeLimits,
 };
+use smallvec::SmallVec;
 use std::ops::ControlFlow;
 
 /// A WebAssembly stack trace.
+///
+/// Only the raw PC and FP of each frame are recorded, and shallow traces are
+/// stored inline without allocating, so that traps are cheap to capture.
+/// Translating frames to functions and source locations is left to users of
+/// the trace.
 #[derive(Debug)]
-pub struct Backtrace(Vec<Frame>);
+pub struct Backtrace(SmallVec<[Frame; INLINE_FRAMES]>);
+
+/// The number of frames stored without a heap allocation.
+const INLINE_FRAMES: usize = 16;
 
 /// A stack frame within a Wasm stack trace.
 #[derive(Debug)]
@@ -53,14 +62,14 @@ impl Frame {
 impl Backtrace {
     /// Returns an empty backtrace
     pub fn empty() -> Backtrace {
-        Backtrace(Vec::new())
+        Backtrace(SmallVec::new())
     }
 
     /// Capture the current Wasm stack in a backtrace.
     pub fn new(limits: *const VMRuntimeLimits) -> Backtrace {
         tls::with(|state| match state {
             Some(state) => unsafe { Self::new_with_trap_state(limits, state, None) },
-            None => Backtrace(vec![]),
+            None => Backtrace::empty(),
         })
     }
 
@@ -74,7 +83,7 @@ impl Backtrace {
         state: &CallThreadState,
         trap_pc_and_fp: Option<(usize, usize)>,
     ) -> Backtrace {
-        let mut frames = vec![];
+        let mut frames = SmallVec::new();
         Self::trace_with_trap_state(limits, state, trap_pc_and_fp, |frame| {
             frames.push(frame);
             ControlFlow::Continue(())
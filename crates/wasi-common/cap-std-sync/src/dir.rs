@@ -87,7 +87,45 @@ impl Dir {
             }
         }
 
-        let mut f = self.0.open_with(Path::new(path), &opts)?;
+        // On Linux try opening the file with a single `openat2`, with the
+        // final flags, before going through cap-std.
+        #[cfg(target_os = "linux")]
+        let fast = {
+            use rustix::fs::OFlags as O;
+            // Match the access mode cap-std is given above.
+            let mut flags = match (read || !write, write || oflags.contains(OFlags::CREATE)) {
+                (true, true) => O::RDWR,
+                (false, true) => O::WRONLY,
+                _ => O::RDONLY,
+            };
+            if oflags.contains(OFlags::CREATE) {
+                flags |= O::CREATE;
+                if oflags.contains(OFlags::EXCLUSIVE) {
+                    flags |= O::EXCL;
+                }
+            }
+            if oflags.contains(OFlags::TRUNCATE) {
+                flags |= O::TRUNC;
+            }
+            if fdflags.contains(FdFlags::APPEND) {
+                flags |= O::APPEND;
+            }
+            if fdflags.contains(FdFlags::NONBLOCK) {
+                flags |= O::NONBLOCK;
+            }
+            if !symlink_follow {
+                flags |= O::NOFOLLOW;
+            }
+            wasi_common::dir::open_beneath(&self.0, path, flags)
+        };
+        #[cfg(not(target_os = "linux"))]
+        let fast: Option<std::io::Result<fs::File>> = None;
+
+        let nonblock_set = fast.is_some();
+        let mut f = match fast {
+            Some(result) => result?,
+            None => self.0.open_with(Path::new(path), &opts)?,
+        };
         if f.metadata()?.is_dir() {
             Ok(OpenResult::Dir(Dir::from_cap_std(fs::Dir::from_std_file(
                 f.into_std(),
@@ -96,7 +134,7 @@ impl Dir {
             Err(Error::not_dir().context("expected directory but got file"))
         } else {
             // NONBLOCK does not have an OpenOption either, but we can patch that on with set_fd_flags:
-            if fdflags.contains(wasi_common::file::FdFlags::NONBLOCK) {
+            if fdflags.contains(wasi_common::file::FdFlags::NONBLOCK) && !nonblock_set {
                 let set_fd_flags = f.new_set_fd_flags(system_interface::fs::FdFlags::NONBLOCK)?;
                 f.set_fd_flags(set_fd_flags)?;
             }
@@ -362,6 +400,35 @@ mod test {
         .expect("open the same directory via WasiDir abstraction");
     }
 
+    #[test]
+    fn truncate_without_write() {
+        let tempdir = tempfile::Builder::new()
+            .prefix("cap-std-sync")
+            .tempdir()
+            .expect("create temporary dir");
+        std::fs::write(tempdir.path().join("file"), b"contents").expect("write file");
+        let preopen_dir = cap_std::fs::Dir::open_ambient_dir(tempdir.path(), ambient_authority())
+            .expect("open ambient temporary dir");
+        let preopen_dir = Dir::from_cap_std(preopen_dir);
+
+        // Truncating requires write access on every platform, even where the
+        // OS would truncate a file opened read-only.
+        assert!(preopen_dir
+            .open_file_(
+                false,
+                "file",
+                OFlags::TRUNCATE,
+                true,
+                false,
+                FdFlags::empty()
+            )
+            .is_err());
+        assert_eq!(
+            std::fs::read(tempdir.path().join("file")).expect("read file"),
+            b"contents"
+        );
+    }
+
     // Readdir does not work on windows, so we won't test it there.
     #[cfg(not(windows))]
     #[test]
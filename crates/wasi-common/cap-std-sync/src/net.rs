@@ -105,6 +105,9 @@ macro_rules! wasi_listen_write_impl {
                 Ok(fdflags)
             }
             async fn set_fdflags(&mut self, fdflags: FdFlags) -> Result<(), Error> {
+                self.set_fdflags_shared(fdflags).await
+            }
+            async fn set_fdflags_shared(&self, fdflags: FdFlags) -> Result<(), Error> {
                 if fdflags == wasi_common::file::FdFlags::NONBLOCK {
                     self.0.set_nonblocking(true)?;
                 } else if fdflags.is_empty() {
@@ -192,6 +195,9 @@ macro_rules! wasi_stream_write_impl {
                 Ok(fdflags)
             }
             async fn set_fdflags(&mut self, fdflags: FdFlags) -> Result<(), Error> {
+                self.set_fdflags_shared(fdflags).await
+            }
+            async fn set_fdflags_shared(&self, fdflags: FdFlags) -> Result<(), Error> {
                 if fdflags == wasi_common::file::FdFlags::NONBLOCK {
                     self.0.set_nonblocking(true)?;
                 } else if fdflags.is_empty() {
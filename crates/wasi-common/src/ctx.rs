@@ -51,6 +51,32 @@ impl WasiCtx {
         s
     }
 
+    /// Creates a new context with the same arguments, environment, and
+    /// descriptors as this one, much like a forked process.
+    ///
+    /// Open files and directories are shared with this context rather than
+    /// reopened, but the new context has its own descriptor table, so
+    /// descriptors opened or closed in one context aren't visible in the other.
+    /// As with forked processes, changing the flags of a shared descriptor,
+    /// such as making a socket non-blocking, changes them for every context
+    /// sharing it; files which can't do that without exclusive access return
+    /// `EBADF` from `fd_fdstat_set_flags` instead.
+    pub fn fork(
+        &self,
+        random: Box<dyn RngCore + Send + Sync>,
+        clocks: WasiClocks,
+        sched: Box<dyn WasiSched>,
+    ) -> Self {
+        WasiCtx(Arc::new(WasiCtxInner {
+            args: self.args.clone(),
+            env: self.env.clone(),
+            random: Mutex::new(random),
+            clocks,
+            sched,
+            table: self.table.share(),
+        }))
+    }
+
     pub fn insert_file(&self, fd: u32, file: Box<dyn WasiFile>, access_mode: FileAccessMode) {
         self.table()
             .insert_at(fd, Arc::new(FileEntry::new(file, access_mode)));
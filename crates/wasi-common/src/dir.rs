@@ -138,3 +138,54 @@ impl From<ReaddirCursor> for u64 {
         c.0
     }
 }
+
+/// Opens `path` beneath `dir` with a single `openat2` call.
+///
+/// cap-std confines lookups with `openat2` too where it's available, but it
+/// translates its own `OpenOptions` and leaves flags such as `O_NONBLOCK` to
+/// be set with further syscalls. Calling `openat2` directly with the final
+/// flags avoids those. `None` is returned when `openat2` is unsupported, or
+/// when it can't give a definitive answer, such as for paths which would
+/// escape `dir`. In that case the caller falls back to cap-std, which
+/// produces the appropriate error.
+///
+/// This is shared by `wasi-cap-std-sync` and `wasmtime-wasi`'s preview 2
+/// implementation.
+#[cfg(target_os = "linux")]
+pub fn open_beneath(
+    dir: &cap_std::fs::Dir,
+    path: &str,
+    flags: rustix::fs::OFlags,
+) -> Option<std::io::Result<cap_std::fs::File>> {
+    use rustix::fs::{Mode, OFlags, ResolveFlags};
+    use rustix::io::Errno;
+    use std::sync::atomic::{AtomicBool, Ordering};
+
+    // Linux creates or truncates files opened read-only, where cap-std
+    // rejects that with `EINVAL`, so leave those to cap-std.
+    if flags.intersects(OFlags::CREATE | OFlags::TRUNC)
+        && !flags.intersects(OFlags::WRONLY | OFlags::RDWR)
+    {
+        return None;
+    }
+
+    static UNSUPPORTED: AtomicBool = AtomicBool::new(false);
+    if UNSUPPORTED.load(Ordering::Relaxed) {
+        return None;
+    }
+    match rustix::fs::openat2(
+        dir,
+        path,
+        flags | OFlags::CLOEXEC | OFlags::NOCTTY,
+        Mode::from_bits_truncate(0o666),
+        ResolveFlags::BENEATH | ResolveFlags::NO_MAGICLINKS,
+    ) {
+        Ok(fd) => Some(Ok(cap_std::fs::File::from_std(fd.into()))),
+        Err(Errno::NOSYS) => {
+            UNSUPPORTED.store(true, Ordering::Relaxed);
+            None
+        }
+        Err(Errno::AGAIN) | Err(Errno::XDEV) => None,
+        Err(e) => Some(Err(e.into())),
+    }
+}
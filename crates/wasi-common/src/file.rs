@@ -62,6 +62,17 @@ pub trait WasiFile: Send + Sync {
         Err(Error::badf())
     }
 
+    /// Same as `set_fdflags`, but for a file which may be shared with other
+    /// contexts, such as those created by [`WasiCtx::fork`](crate::WasiCtx::fork),
+    /// in which case the flags change for all of them, as they would for a
+    /// descriptor shared by forked processes.
+    ///
+    /// Only files which can change their flags without exclusive access
+    /// support this.
+    async fn set_fdflags_shared(&self, _flags: FdFlags) -> Result<(), Error> {
+        Err(Error::badf())
+    }
+
     async fn get_filestat(&self) -> Result<Filestat, Error> {
         Ok(Filestat {
             device_id: 0,
@@ -192,16 +192,21 @@ impl wasi_snapshot_preview1::WasiSnapshotPreview1 for WasiCtx {
         fd: types::Fd,
         flags: types::Fdflags,
     ) -> Result<(), Error> {
+        let fd = u32::from(fd);
+        let flags = FdFlags::from(flags);
         if let Some(table) = self.table_mut() {
-            table
-                .get_file_mut(u32::from(fd))?
-                .file
-                .set_fdflags(FdFlags::from(flags))
-                .await
-        } else {
-            log::warn!("`fd_fdstat_set_flags` does not work with wasi-threads enabled; see https://github.com/bytecodealliance/wasmtime/issues/5643");
-            Err(Error::not_supported())
+            if let Ok(entry) = table.get_file_mut(fd) {
+                return entry.file.set_fdflags(flags).await;
+            }
         }
+        // The table is shared when wasi-threads is enabled, and files are
+        // shared with forked contexts, in which case only files which can
+        // change their flags without exclusive access support this.
+        self.table()
+            .get_file(fd)?
+            .file
+            .set_fdflags_shared(flags)
+            .await
     }
 
     async fn fd_fdstat_set_rights(
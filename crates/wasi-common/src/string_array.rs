@@ -1,8 +1,12 @@
 use crate::{Error, ErrorExt};
+use std::sync::Arc;
 use wiggle::GuestPtr;
 
+/// An array of strings, such as arguments or environment variables, which is
+/// cheap to clone: clones share their elements until one of them is modified.
+#[derive(Clone)]
 pub struct StringArray {
-    elems: Vec<String>,
+    elems: Arc<Vec<String>>,
 }
 
 #[derive(Debug, thiserror::Error)]
@@ -17,7 +21,9 @@ pub enum StringArrayError {
 
 impl StringArray {
     pub fn new() -> Self {
-        StringArray { elems: Vec::new() }
+        StringArray {
+            elems: Arc::new(Vec::new()),
+        }
     }
 
     pub fn push(&mut self, elem: String) -> Result<(), StringArrayError> {
@@ -30,7 +36,7 @@ impl StringArray {
         if self.cumulative_size() as usize + elem.as_bytes().len() + 1 > std::u32::MAX as usize {
             return Err(StringArrayError::CumulativeSize);
         }
-        self.elems.push(elem);
+        Arc::make_mut(&mut self.elems).push(elem);
         Ok(())
     }
 
@@ -26,6 +26,17 @@ impl Table {
         }))
     }
 
+    /// Create a new table holding the same resources, at the same indices, as
+    /// this one. The resources themselves are shared rather than copied, so
+    /// this only bumps their reference counts.
+    pub fn share(&self) -> Self {
+        let inner = self.0.read().unwrap();
+        Table(RwLock::new(Inner {
+            map: inner.map.clone(),
+            next_key: inner.next_key,
+        }))
+    }
+
     /// Insert a resource at a certain index.
     pub fn insert_at<T: Any + Send + Sync>(&self, key: u32, a: Arc<T>) {
         self.0.write().unwrap().map.insert(key, a);
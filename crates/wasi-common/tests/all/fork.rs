@@ -0,0 +1,69 @@
+use super::*;
+use wasi_common::WasiCtx;
+use wasmtime_wasi::sync::{add_to_linker, TcpListener, WasiCtxBuilder};
+
+const ERRNO_SUCCESS: i32 = 0;
+const ERRNO_BADF: i32 = 8;
+const FDFLAGS_NONBLOCK: i32 = 4;
+
+/// Calls `fd_fdstat_set_flags` from a guest running with `ctx`.
+fn set_flags(ctx: WasiCtx, fd: i32, flags: i32) -> Result<i32> {
+    let engine = Engine::default();
+    let mut linker = Linker::new(&engine);
+    add_to_linker(&mut linker, |cx| cx)?;
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (import "wasi_snapshot_preview1" "fd_fdstat_set_flags"
+                    (func $set_flags (param i32 i32) (result i32)))
+                (memory (export "memory") 1)
+                (func (export "run") (param i32 i32) (result i32)
+                    (call $set_flags (local.get 0) (local.get 1)))
+            )
+        "#,
+    )?;
+    let mut store = Store::new(&engine, ctx);
+    let instance = linker.instantiate(&mut store, &module)?;
+    let run = instance.get_typed_func::<(i32, i32), i32>(&mut store, "run")?;
+    run.call(&mut store, (fd, flags))
+}
+
+fn ctx_with_socket() -> Result<WasiCtx> {
+    let listener = std::net::TcpListener::bind("127.0.0.1:0")?;
+    Ok(WasiCtxBuilder::new()
+        .preopened_socket(3, TcpListener::from_std(listener))?
+        .build())
+}
+
+fn fork(ctx: &WasiCtx) -> WasiCtx {
+    ctx.fork(
+        wasmtime_wasi::sync::random_ctx(),
+        wasmtime_wasi::sync::clocks_ctx(),
+        wasmtime_wasi::sync::sched_ctx(),
+    )
+}
+
+#[test]
+fn set_flags_on_preopened_socket() -> Result<()> {
+    let ctx = ctx_with_socket()?;
+    assert_eq!(set_flags(ctx, 3, FDFLAGS_NONBLOCK)?, ERRNO_SUCCESS);
+    Ok(())
+}
+
+#[test]
+fn set_flags_on_socket_shared_with_fork() -> Result<()> {
+    let template = ctx_with_socket()?;
+
+    // Each fork shares the socket with the template, so neither can borrow
+    // it exclusively.
+    for _ in 0..2 {
+        assert_eq!(
+            set_flags(fork(&template), 3, FDFLAGS_NONBLOCK)?,
+            ERRNO_SUCCESS
+        );
+        assert_eq!(set_flags(fork(&template), 3, 0)?, ERRNO_SUCCESS);
+    }
+    assert_eq!(set_flags(fork(&template), 4, 0)?, ERRNO_BADF);
+    Ok(())
+}
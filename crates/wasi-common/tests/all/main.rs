@@ -18,4 +18,5 @@ macro_rules! assert_test_exists {
 }
 
 mod async_;
+mod fork;
 mod sync;
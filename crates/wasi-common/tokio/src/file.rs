@@ -118,6 +118,9 @@ macro_rules! wasi_file_impl {
             async fn set_fdflags(&mut self, fdflags: FdFlags) -> Result<(), Error> {
                 block_on_dummy_executor(|| self.0.set_fdflags(fdflags))
             }
+            async fn set_fdflags_shared(&self, fdflags: FdFlags) -> Result<(), Error> {
+                block_on_dummy_executor(|| self.0.set_fdflags_shared(fdflags))
+            }
             async fn get_filestat(&self) -> Result<Filestat, Error> {
                 block_on_dummy_executor(|| self.0.get_filestat())
             }
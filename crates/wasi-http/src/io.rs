@@ -1,5 +1,5 @@
 use hyper::rt::{Read, ReadBufCursor, Write};
-use std::io::Error;
+use std::io::{Error, IoSlice};
 use std::marker::Unpin;
 use std::pin::Pin;
 use std::task::{Context, Poll};
@@ -40,6 +40,21 @@ impl<T: AsyncWrite + Unpin> Write for TokioIo<T> {
         Pin::new(&mut self.inner).poll_write(cx, buf)
     }
 
+    // Without these hyper copies every body frame into its own write buffer
+    // before writing it out, rather than queueing the frames and writing them
+    // out as they are.
+    fn poll_write_vectored(
+        mut self: Pin<&mut Self>,
+        cx: &mut Context<'_>,
+        bufs: &[IoSlice<'_>],
+    ) -> Poll<Result<usize, Error>> {
+        Pin::new(&mut self.inner).poll_write_vectored(cx, bufs)
+    }
+
+    fn is_write_vectored(&self) -> bool {
+        self.inner.is_write_vectored()
+    }
+
     fn poll_flush(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Result<(), Error>> {
         Pin::new(&mut self.inner).poll_flush(cx)
     }
@@ -3,6 +3,7 @@ pub use crate::types::{WasiHttpCtx, WasiHttpView};
 pub mod body;
 pub mod http_impl;
 pub mod io;
+pub mod pool;
 pub mod proxy;
 pub mod types;
 pub mod types_impl;
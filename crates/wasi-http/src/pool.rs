@@ -0,0 +1,695 @@
+//! Connections to origin servers for outgoing requests, and pooling of them
+//! so they can be reused across requests.
+
+use crate::bindings::http::types::ErrorCode;
+use crate::body::HyperOutgoingBody;
+use crate::io::TokioIo;
+use crate::{dns_error, hyper_request_error};
+use hyper::client::conn::{http1, http2};
+use std::collections::HashMap;
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex, OnceLock, Weak};
+use std::time::{Duration, Instant};
+use tokio::net::TcpStream;
+use tokio::sync::Notify;
+use tokio::time::timeout;
+use wasmtime_wasi::preview2::{self, AbortOnDropJoinHandle};
+
+/// An established connection to an origin server.
+pub(crate) struct Connection {
+    sender: Sender,
+    /// The task driving the connection, which stops when this is dropped.
+    pub(crate) worker: Arc<AbortOnDropJoinHandle<()>>,
+}
+
+enum Sender {
+    Http1(http1::SendRequest<HyperOutgoingBody>),
+    Http2(http2::SendRequest<HyperOutgoingBody>),
+}
+
+impl Connection {
+    /// Sends `request`, returning the response once its head has arrived.
+    pub(crate) async fn send_request(
+        &mut self,
+        request: hyper::Request<HyperOutgoingBody>,
+        first_byte_timeout: Duration,
+    ) -> Result<hyper::Response<hyper::body::Incoming>, ErrorCode> {
+        match &mut self.sender {
+            Sender::Http1(sender) => send_http1(sender, request, first_byte_timeout).await,
+            // HTTP/2 carries the scheme and authority in pseudo-headers, which
+            // hyper takes from the URI, so the request is sent as it is.
+            Sender::Http2(sender) => timeout(first_byte_timeout, sender.send_request(request))
+                .await
+                .map_err(|_| ErrorCode::ConnectionReadTimeout)?
+                .map_err(hyper_request_error),
+        }
+    }
+}
+
+async fn send_http1(
+    sender: &mut http1::SendRequest<HyperOutgoingBody>,
+    mut request: hyper::Request<HyperOutgoingBody>,
+    first_byte_timeout: Duration,
+) -> Result<hyper::Response<hyper::body::Incoming>, ErrorCode> {
+    // at this point, the request contains the scheme and the authority, but
+    // the http packet should only include those if addressing a proxy, so
+    // remove them here, since SendRequest::send_request does not do it for us
+    *request.uri_mut() = http::Uri::builder()
+        .path_and_query(
+            request
+                .uri()
+                .path_and_query()
+                .map(|p| p.as_str())
+                .unwrap_or("/"),
+        )
+        .build()
+        .expect("comes from valid request");
+
+    timeout(first_byte_timeout, sender.send_request(request))
+        .await
+        .map_err(|_| ErrorCode::ConnectionReadTimeout)?
+        .map_err(hyper_request_error)
+}
+
+/// Opens a connection to `authority`, negotiating HTTP/2 if `http2` is set
+/// and the server supports it over TLS, and HTTP/1.1 otherwise.
+pub(crate) async fn connect(
+    authority: &str,
+    use_tls: bool,
+    connect_timeout: Duration,
+    http2: bool,
+) -> Result<Connection, ErrorCode> {
+    let tcp_stream = TcpStream::connect(authority)
+        .await
+        .map_err(|e| match e.kind() {
+            std::io::ErrorKind::AddrNotAvailable => {
+                dns_error("address not available".to_string(), 0)
+            }
+
+            _ => {
+                if e.to_string()
+                    .starts_with("failed to lookup address information")
+                {
+                    dns_error("address not available".to_string(), 0)
+                } else {
+                    ErrorCode::ConnectionRefused
+                }
+            }
+        })?;
+
+    if use_tls {
+        #[cfg(any(target_arch = "riscv64", target_arch = "s390x"))]
+        {
+            let _ = http2;
+            return Err(ErrorCode::InternalError(Some(
+                "unsupported architecture for SSL".to_string(),
+            )));
+        }
+
+        #[cfg(not(any(target_arch = "riscv64", target_arch = "s390x")))]
+        {
+            let connector = tokio_rustls::TlsConnector::from(tls_config(http2));
+            let mut parts = authority.split(":");
+            let host = parts.next().unwrap_or(authority);
+            let domain = rustls::ServerName::try_from(host).map_err(|e| {
+                tracing::warn!("dns lookup error: {e:?}");
+                dns_error("invalid dns name".to_string(), 0)
+            })?;
+            let stream = connector.connect(domain, tcp_stream).await.map_err(|e| {
+                tracing::warn!("tls protocol error: {e:?}");
+                ErrorCode::TlsProtocolError
+            })?;
+            let negotiated_http2 = stream.get_ref().1.alpn_protocol() == Some(b"h2");
+            handshake(TokioIo::new(stream), connect_timeout, negotiated_http2).await
+        }
+    } else {
+        handshake(TokioIo::new(tcp_stream), connect_timeout, false).await
+    }
+}
+
+/// Returns the TLS configuration for outgoing connections, which is built
+/// once as loading the root certificates isn't free.
+#[cfg(not(any(target_arch = "riscv64", target_arch = "s390x")))]
+fn tls_config(http2: bool) -> Arc<rustls::ClientConfig> {
+    use tokio_rustls::rustls::OwnedTrustAnchor;
+
+    static HTTP1: OnceLock<Arc<rustls::ClientConfig>> = OnceLock::new();
+    static HTTP2: OnceLock<Arc<rustls::ClientConfig>> = OnceLock::new();
+
+    let config = if http2 { &HTTP2 } else { &HTTP1 };
+    config
+        .get_or_init(|| {
+            // derived from https://github.com/tokio-rs/tls/blob/master/tokio-rustls/examples/client/src/main.rs
+            let mut root_cert_store = rustls::RootCertStore::empty();
+            root_cert_store.add_trust_anchors(webpki_roots::TLS_SERVER_ROOTS.iter().map(|ta| {
+                OwnedTrustAnchor::from_subject_spki_name_constraints(
+                    ta.subject,
+                    ta.spki,
+                    ta.name_constraints,
+                )
+            }));
+            let mut config = rustls::ClientConfig::builder()
+                .with_safe_defaults()
+                .with_root_certificates(root_cert_store)
+                .with_no_client_auth();
+            if http2 {
+                config.alpn_protocols = vec![b"h2".to_vec(), b"http/1.1".to_vec()];
+            }
+            Arc::new(config)
+        })
+        .clone()
+}
+
+async fn handshake<T>(
+    io: T,
+    connect_timeout: Duration,
+    use_http2: bool,
+) -> Result<Connection, ErrorCode>
+where
+    T: hyper::rt::Read + hyper::rt::Write + Send + Unpin + 'static,
+{
+    if use_http2 {
+        let (sender, conn) = timeout(connect_timeout, http2::handshake(TokioExecutor, io))
+            .await
+            .map_err(|_| ErrorCode::ConnectionTimeout)?
+            .map_err(hyper_request_error)?;
+        Ok(Connection {
+            sender: Sender::Http2(sender),
+            worker: Arc::new(spawn_worker(conn)),
+        })
+    } else {
+        let (sender, conn) = timeout(
+            connect_timeout,
+            // TODO: we should plumb the builder through the http context, and use it here
+            http1::handshake(io),
+        )
+        .await
+        .map_err(|_| ErrorCode::ConnectionTimeout)?
+        .map_err(hyper_request_error)?;
+        Ok(Connection {
+            sender: Sender::Http1(sender),
+            worker: Arc::new(spawn_worker(conn)),
+        })
+    }
+}
+
+fn spawn_worker<F>(conn: F) -> AbortOnDropJoinHandle<()>
+where
+    F: Future<Output = hyper::Result<()>> + Send + 'static,
+{
+    preview2::spawn(async move {
+        match conn.await {
+            Ok(()) => {}
+            // TODO: shouldn't throw away this error and ideally should
+            // surface somewhere.
+            Err(e) => tracing::warn!("dropping error {e}"),
+        }
+    })
+}
+
+#[derive(Clone, Copy)]
+struct TokioExecutor;
+
+impl<F> hyper::rt::Executor<F> for TokioExecutor
+where
+    F: Future + Send + 'static,
+    F::Output: Send + 'static,
+{
+    fn execute(&self, fut: F) {
+        tokio::task::spawn(fut);
+    }
+}
+
+/// Configuration for a [`ConnectionPool`].
+#[derive(Debug, Clone)]
+pub struct ConnectionPoolConfig {
+    /// How long a connection may sit unused before it's closed.
+    pub idle_timeout: Duration,
+    /// The most connections open to each origin at once. Requests wait for a
+    /// connection to become available beyond this, up to their connect
+    /// timeout.
+    pub max_connections_per_host: usize,
+    /// Whether to negotiate HTTP/2 with servers which support it over TLS,
+    /// multiplexing all requests to an origin over a single connection.
+    pub http2: bool,
+}
+
+impl Default for ConnectionPoolConfig {
+    fn default() -> Self {
+        Self {
+            idle_timeout: Duration::from_secs(90),
+            max_connections_per_host: 32,
+            http2: false,
+        }
+    }
+}
+
+/// Counters describing how well a [`ConnectionPool`] is doing.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ConnectionPoolStats {
+    /// Requests which were sent on an existing connection.
+    pub hits: u64,
+    /// Requests which had to open a new connection.
+    pub misses: u64,
+    /// Connections currently waiting to be reused.
+    pub idle: usize,
+}
+
+impl ConnectionPoolStats {
+    /// Returns the fraction of requests which reused a connection.
+    pub fn hit_rate(&self) -> f64 {
+        match self.hits + self.misses {
+            0 => 0.0,
+            total => self.hits as f64 / total as f64,
+        }
+    }
+}
+
+/// A pool of connections for outgoing requests, keyed by scheme and
+/// authority.
+///
+/// Clones of a pool share its connections, so a single pool can be shared
+/// by every store created from an engine or linker by returning it from
+/// [`WasiHttpView::connection_pool`](crate::WasiHttpView::connection_pool).
+#[derive(Clone)]
+pub struct ConnectionPool {
+    inner: Arc<Inner>,
+}
+
+struct Inner {
+    config: ConnectionPoolConfig,
+    hosts: Mutex<HashMap<Key, Host>>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    /// The task closing idle connections, started when the first connection
+    /// goes idle and stopped when the pool is dropped.
+    reaper: OnceLock<AbortOnDropJoinHandle<()>>,
+    /// Opens connections, which is `connect_to` outside of tests.
+    connect: Connect,
+}
+
+type Connect =
+    fn(Key, Duration, bool) -> Pin<Box<dyn Future<Output = Result<Connection, ErrorCode>> + Send>>;
+
+fn connect_to(
+    key: Key,
+    connect_timeout: Duration,
+    http2: bool,
+) -> Pin<Box<dyn Future<Output = Result<Connection, ErrorCode>> + Send>> {
+    Box::pin(async move { connect(&key.authority, key.use_tls, connect_timeout, http2).await })
+}
+
+#[derive(Clone, PartialEq, Eq, Hash)]
+struct Key {
+    use_tls: bool,
+    authority: String,
+}
+
+#[derive(Default)]
+struct Host {
+    /// HTTP/1.1 connections ready for another request, most recently used
+    /// last.
+    idle: Vec<Idle>,
+    /// A multiplexed connection shared by all requests to this host.
+    http2: Option<(
+        http2::SendRequest<HyperOutgoingBody>,
+        Arc<AbortOnDropJoinHandle<()>>,
+        Slot,
+    )>,
+    /// Set once a connection to this host has come up as HTTP/1.1 with
+    /// `http2` configured, meaning the host doesn't do HTTP/2.
+    http1_only: bool,
+    /// Held while opening a connection which may turn out to be HTTP/2, so
+    /// that concurrent requests wait to share it rather than each opening
+    /// their own.
+    connecting: Arc<tokio::sync::Mutex<()>>,
+    slots: Arc<Slots>,
+}
+
+#[derive(Default)]
+struct Slots {
+    /// Connections which are open, whether idle or in use.
+    open: AtomicUsize,
+    /// Notified when a connection is closed or becomes idle.
+    available: Notify,
+}
+
+/// A connection's place in its host's limit, given up when dropped.
+struct Slot(Arc<Slots>);
+
+impl Drop for Slot {
+    fn drop(&mut self) {
+        self.0.open.fetch_sub(1, Ordering::AcqRel);
+        self.0.available.notify_one();
+    }
+}
+
+/// An HTTP/1.1 connection, which carries one request at a time.
+struct Pooled {
+    sender: http1::SendRequest<HyperOutgoingBody>,
+    worker: Arc<AbortOnDropJoinHandle<()>>,
+    slot: Slot,
+}
+
+struct Idle {
+    pooled: Pooled,
+    since: Instant,
+}
+
+impl Idle {
+    fn is_usable(&self, idle_timeout: Duration) -> bool {
+        self.pooled.sender.is_ready() && self.since.elapsed() < idle_timeout
+    }
+}
+
+impl ConnectionPool {
+    pub fn new(config: ConnectionPoolConfig) -> Self {
+        Self::with_connect(config, connect_to)
+    }
+
+    fn with_connect(config: ConnectionPoolConfig, connect: Connect) -> Self {
+        Self {
+            inner: Arc::new(Inner {
+                config,
+                hosts: Mutex::new(HashMap::new()),
+                hits: AtomicU64::new(0),
+                misses: AtomicU64::new(0),
+                reaper: OnceLock::new(),
+                connect,
+            }),
+        }
+    }
+
+    pub fn stats(&self) -> ConnectionPoolStats {
+        let hosts = self.inner.hosts.lock().unwrap();
+        ConnectionPoolStats {
+            hits: self.inner.hits.load(Ordering::Relaxed),
+            misses: self.inner.misses.load(Ordering::Relaxed),
+            idle: hosts.values().map(|h| h.idle.len()).sum(),
+        }
+    }
+
+    /// Sends `request` on a pooled connection to `authority`, returning the
+    /// response and the worker to keep alive while its body is read.
+    pub(crate) async fn send_request(
+        &self,
+        authority: String,
+        use_tls: bool,
+        connect_timeout: Duration,
+        first_byte_timeout: Duration,
+        request: hyper::Request<HyperOutgoingBody>,
+    ) -> Result<
+        (
+            hyper::Response<hyper::body::Incoming>,
+            Arc<AbortOnDropJoinHandle<()>>,
+        ),
+        ErrorCode,
+    > {
+        let key = Key { use_tls, authority };
+        let checkout = timeout(connect_timeout, self.checkout(&key, connect_timeout))
+            .await
+            .map_err(|_| ErrorCode::ConnectionTimeout)??;
+
+        match checkout {
+            Checkout::Http2(mut conn) => {
+                let resp = conn.send_request(request, first_byte_timeout).await?;
+                Ok((resp, conn.worker))
+            }
+            Checkout::Http1(mut pooled) => {
+                let resp = send_http1(&mut pooled.sender, request, first_byte_timeout).await?;
+                let worker = pooled.worker.clone();
+
+                // Put the connection back once the response has been read.
+                let pool = self.clone();
+                tokio::task::spawn(async move {
+                    if pooled.sender.ready().await.is_err() {
+                        return;
+                    }
+                    pool.put(&key, pooled);
+                });
+
+                Ok((resp, worker))
+            }
+        }
+    }
+
+    async fn checkout(&self, key: &Key, connect_timeout: Duration) -> Result<Checkout, ErrorCode> {
+        // Until a host is known not to do HTTP/2, only one connection to it is
+        // opened at a time, and the requests waiting behind it then find the
+        // HTTP/2 connection if that's what it turned out to be.
+        let connecting = if self.inner.config.http2 {
+            let mut hosts = self.inner.hosts.lock().unwrap();
+            let host = hosts.entry(key.clone()).or_default();
+            (!host.http1_only).then(|| host.connecting.clone())
+        } else {
+            None
+        };
+        let _connecting = match connecting {
+            Some(connecting) => Some(connecting.lock_owned().await),
+            None => None,
+        };
+
+        let slot = loop {
+            let slots = {
+                let mut hosts = self.inner.hosts.lock().unwrap();
+                let host = hosts.entry(key.clone()).or_default();
+
+                if let Some((sender, worker, _)) = &host.http2 {
+                    if !sender.is_closed() {
+                        self.inner.hits.fetch_add(1, Ordering::Relaxed);
+                        return Ok(Checkout::Http2(Connection {
+                            sender: Sender::Http2(sender.clone()),
+                            worker: worker.clone(),
+                        }));
+                    }
+                    host.http2 = None;
+                }
+
+                while let Some(idle) = host.idle.pop() {
+                    if idle.is_usable(self.inner.config.idle_timeout) {
+                        self.inner.hits.fetch_add(1, Ordering::Relaxed);
+                        return Ok(Checkout::Http1(idle.pooled));
+                    }
+                }
+
+                // Slots are only taken with the lock held, so this can't race
+                // with another checkout, only with connections closing.
+                if host.slots.open.load(Ordering::Acquire)
+                    < self.inner.config.max_connections_per_host
+                {
+                    host.slots.open.fetch_add(1, Ordering::AcqRel);
+                    self.inner.misses.fetch_add(1, Ordering::Relaxed);
+                    break Slot(host.slots.clone());
+                }
+                host.slots.clone()
+            };
+            slots.available.notified().await;
+        };
+
+        let conn =
+            (self.inner.connect)(key.clone(), connect_timeout, self.inner.config.http2).await?;
+
+        match conn.sender {
+            Sender::Http1(sender) => {
+                if self.inner.config.http2 {
+                    let mut hosts = self.inner.hosts.lock().unwrap();
+                    hosts.entry(key.clone()).or_default().http1_only = true;
+                }
+                Ok(Checkout::Http1(Pooled {
+                    sender,
+                    worker: conn.worker,
+                    slot,
+                }))
+            }
+            Sender::Http2(sender) => {
+                let mut hosts = self.inner.hosts.lock().unwrap();
+                hosts.entry(key.clone()).or_default().http2 =
+                    Some((sender.clone(), conn.worker.clone(), slot));
+                Ok(Checkout::Http2(Connection {
+                    sender: Sender::Http2(sender),
+                    worker: conn.worker,
+                }))
+            }
+        }
+    }
+
+    fn put(&self, key: &Key, pooled: Pooled) {
+        let slots = {
+            let mut hosts = self.inner.hosts.lock().unwrap();
+            let host = hosts.entry(key.clone()).or_default();
+            host.idle.push(Idle {
+                pooled,
+                since: Instant::now(),
+            });
+            host.slots.clone()
+        };
+        slots.available.notify_one();
+        self.inner
+            .reaper
+            .get_or_init(|| preview2::spawn(reap(Arc::downgrade(&self.inner))));
+    }
+}
+
+/// Periodically closes the idle connections in a pool which have been unused
+/// for too long or were closed by the server, until the pool is dropped.
+async fn reap(inner: Weak<Inner>) {
+    let Some(idle_timeout) = inner.upgrade().map(|i| i.config.idle_timeout) else {
+        return;
+    };
+    let mut interval = tokio::time::interval(idle_timeout.max(Duration::from_millis(10)));
+    interval.set_missed_tick_behavior(tokio::time::MissedTickBehavior::Delay);
+    loop {
+        interval.tick().await;
+        let Some(inner) = inner.upgrade() else {
+            return;
+        };
+        let mut hosts = inner.hosts.lock().unwrap();
+        for host in hosts.values_mut() {
+            host.idle.retain(|idle| idle.is_usable(idle_timeout));
+        }
+    }
+}
+
+enum Checkout {
+    Http1(Pooled),
+    Http2(Connection),
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use http_body_util::{BodyExt, Empty};
+    use hyper::service::service_fn;
+    use std::convert::Infallible;
+    use tokio::net::TcpListener;
+
+    /// Serves empty responses over HTTP/1.1 or HTTP/2, after `delay`, and
+    /// counts the connections accepted.
+    async fn serve(http2: bool, delay: Duration) -> (String, Arc<AtomicUsize>) {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let authority = listener.local_addr().unwrap().to_string();
+        let connections = Arc::new(AtomicUsize::new(0));
+        let accepted = connections.clone();
+        tokio::task::spawn(async move {
+            loop {
+                let (stream, _) = listener.accept().await.unwrap();
+                accepted.fetch_add(1, Ordering::SeqCst);
+                let service = service_fn(move |_| async move {
+                    tokio::time::sleep(delay).await;
+                    Ok::<_, Infallible>(hyper::Response::new(Empty::<bytes::Bytes>::new()))
+                });
+                let io = TokioIo::new(stream);
+                tokio::task::spawn(async move {
+                    let _ = if http2 {
+                        hyper::server::conn::http2::Builder::new(TokioExecutor)
+                            .serve_connection(io, service)
+                            .await
+                    } else {
+                        hyper::server::conn::http1::Builder::new()
+                            .serve_connection(io, service)
+                            .await
+                    };
+                });
+            }
+        });
+        (authority, connections)
+    }
+
+    /// Opens HTTP/2 connections without TLS, as a test server can't present
+    /// a certificate which `connect` would accept.
+    fn connect_http2(
+        key: Key,
+        connect_timeout: Duration,
+        _http2: bool,
+    ) -> Pin<Box<dyn Future<Output = Result<Connection, ErrorCode>> + Send>> {
+        Box::pin(async move {
+            let stream = TcpStream::connect(&key.authority)
+                .await
+                .map_err(|_| ErrorCode::ConnectionRefused)?;
+            handshake(TokioIo::new(stream), connect_timeout, true).await
+        })
+    }
+
+    /// Sends `count` concurrent requests to `authority` through `pool`.
+    async fn send_requests(pool: &ConnectionPool, authority: &str, count: usize) {
+        let requests = (0..count)
+            .map(|_| {
+                let pool = pool.clone();
+                let request = hyper::Request::get(format!("http://{authority}/"))
+                    .body(Empty::new().map_err(|_| unreachable!()).boxed())
+                    .unwrap();
+                let authority = authority.to_string();
+                tokio::task::spawn(async move {
+                    let timeout = Duration::from_secs(10);
+                    let (resp, _worker) = pool
+                        .send_request(authority, false, timeout, timeout, request)
+                        .await
+                        .unwrap();
+                    assert!(resp.status().is_success());
+                    resp.into_body().collect().await.unwrap();
+                })
+            })
+            .collect::<Vec<_>>();
+        for request in requests {
+            request.await.unwrap();
+        }
+    }
+
+    #[tokio::test]
+    async fn http2_connection_is_shared() {
+        let (authority, connections) = serve(true, Duration::from_millis(10)).await;
+        let config = ConnectionPoolConfig {
+            http2: true,
+            ..ConnectionPoolConfig::default()
+        };
+        let pool = ConnectionPool::with_connect(config, connect_http2);
+
+        // Concurrent requests made before the connection is up wait for it
+        // rather than each opening their own.
+        send_requests(&pool, &authority, 8).await;
+        send_requests(&pool, &authority, 8).await;
+
+        assert_eq!(connections.load(Ordering::SeqCst), 1);
+        let stats = pool.stats();
+        assert_eq!((stats.hits, stats.misses), (15, 1));
+    }
+
+    #[tokio::test]
+    async fn connections_per_host_are_limited() {
+        let (authority, connections) = serve(false, Duration::from_millis(50)).await;
+        let config = ConnectionPoolConfig {
+            max_connections_per_host: 2,
+            ..ConnectionPoolConfig::default()
+        };
+        let pool = ConnectionPool::new(config);
+
+        send_requests(&pool, &authority, 8).await;
+
+        assert_eq!(connections.load(Ordering::SeqCst), 2);
+        let stats = pool.stats();
+        assert_eq!((stats.hits, stats.misses), (6, 2));
+    }
+
+    #[tokio::test]
+    async fn idle_connections_are_closed() {
+        let (authority, _) = serve(false, Duration::ZERO).await;
+        let config = ConnectionPoolConfig {
+            idle_timeout: Duration::from_millis(50),
+            ..ConnectionPoolConfig::default()
+        };
+        let pool = ConnectionPool::new(config);
+
+        send_requests(&pool, &authority, 1).await;
+        let start = Instant::now();
+        while pool.stats().idle == 0 {
+            assert!(start.elapsed() < Duration::from_secs(10), "never pooled");
+            tokio::time::sleep(Duration::from_millis(1)).await;
+        }
+        while pool.stats().idle != 0 {
+            assert!(start.elapsed() < Duration::from_secs(10), "never closed");
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+    }
+}
@@ -1,19 +1,17 @@
 //! Implements the base structure (i.e. [WasiHttpCtx]) that will provide the
 //! implementation of the wasi-http API.
 
-use crate::io::TokioIo;
 use crate::{
     bindings::http::types::{self, Method, Scheme},
     body::{HostIncomingBody, HyperIncomingBody, HyperOutgoingBody},
-    dns_error, hyper_request_error,
+    hyper_request_error,
+    pool::{connect, ConnectionPool},
 };
 use http_body_util::BodyExt;
 use hyper::header::HeaderName;
 use std::any::Any;
 use std::sync::Arc;
 use std::time::Duration;
-use tokio::net::TcpStream;
-use tokio::time::timeout;
 use wasmtime::component::{Resource, ResourceTable};
 use wasmtime_wasi::preview2::{self, AbortOnDropJoinHandle, Subscribe};
 
@@ -73,6 +71,12 @@ pub trait WasiHttpView: Send {
     fn is_forbidden_header(&mut self, _name: &HeaderName) -> bool {
         false
     }
+
+    /// Returns the pool which [`default_send_request`] sends requests
+    /// through, or `None` to open a new connection for every request.
+    fn connection_pool(&mut self) -> Option<ConnectionPool> {
+        None
+    }
 }
 
 /// Returns `true` when the header is forbidden according to this [`WasiHttpView`] implementation.
@@ -121,8 +125,10 @@ pub fn default_send_request(
         between_bytes_timeout,
     }: OutgoingRequest,
 ) -> wasmtime::Result<Resource<HostFutureIncomingResponse>> {
+    let pool = view.connection_pool();
     let handle = preview2::spawn(async move {
         let resp = handler(
+            pool,
             authority,
             use_tls,
             connect_timeout,
@@ -140,133 +146,35 @@ pub fn default_send_request(
 }
 
 async fn handler(
+    pool: Option<ConnectionPool>,
     authority: String,
     use_tls: bool,
     connect_timeout: Duration,
     first_byte_timeout: Duration,
-    mut request: http::Request<HyperOutgoingBody>,
+    request: http::Request<HyperOutgoingBody>,
     between_bytes_timeout: Duration,
 ) -> Result<IncomingResponseInternal, types::ErrorCode> {
-    let tcp_stream = TcpStream::connect(authority.clone())
-        .await
-        .map_err(|e| match e.kind() {
-            std::io::ErrorKind::AddrNotAvailable => {
-                dns_error("address not available".to_string(), 0)
-            }
-
-            _ => {
-                if e.to_string()
-                    .starts_with("failed to lookup address information")
-                {
-                    dns_error("address not available".to_string(), 0)
-                } else {
-                    types::ErrorCode::ConnectionRefused
-                }
-            }
-        })?;
-
-    let (mut sender, worker) = if use_tls {
-        #[cfg(any(target_arch = "riscv64", target_arch = "s390x"))]
-        {
-            return Err(crate::bindings::http::types::ErrorCode::InternalError(
-                Some("unsupported architecture for SSL".to_string()),
-            ));
-        }
-
-        #[cfg(not(any(target_arch = "riscv64", target_arch = "s390x")))]
-        {
-            use tokio_rustls::rustls::OwnedTrustAnchor;
-
-            // derived from https://github.com/tokio-rs/tls/blob/master/tokio-rustls/examples/client/src/main.rs
-            let mut root_cert_store = rustls::RootCertStore::empty();
-            root_cert_store.add_trust_anchors(webpki_roots::TLS_SERVER_ROOTS.iter().map(|ta| {
-                OwnedTrustAnchor::from_subject_spki_name_constraints(
-                    ta.subject,
-                    ta.spki,
-                    ta.name_constraints,
-                )
-            }));
-            let config = rustls::ClientConfig::builder()
-                .with_safe_defaults()
-                .with_root_certificates(root_cert_store)
-                .with_no_client_auth();
-            let connector = tokio_rustls::TlsConnector::from(std::sync::Arc::new(config));
-            let mut parts = authority.split(":");
-            let host = parts.next().unwrap_or(&authority);
-            let domain = rustls::ServerName::try_from(host).map_err(|e| {
-                tracing::warn!("dns lookup error: {e:?}");
-                dns_error("invalid dns name".to_string(), 0)
-            })?;
-            let stream = connector.connect(domain, tcp_stream).await.map_err(|e| {
-                tracing::warn!("tls protocol error: {e:?}");
-                types::ErrorCode::TlsProtocolError
-            })?;
-            let stream = TokioIo::new(stream);
-
-            let (sender, conn) = timeout(
+    let (resp, worker) = match pool {
+        Some(pool) => {
+            pool.send_request(
+                authority,
+                use_tls,
                 connect_timeout,
-                hyper::client::conn::http1::handshake(stream),
+                first_byte_timeout,
+                request,
             )
-            .await
-            .map_err(|_| types::ErrorCode::ConnectionTimeout)?
-            .map_err(hyper_request_error)?;
-
-            let worker = preview2::spawn(async move {
-                match conn.await {
-                    Ok(()) => {}
-                    // TODO: shouldn't throw away this error and ideally should
-                    // surface somewhere.
-                    Err(e) => tracing::warn!("dropping error {e}"),
-                }
-            });
-
-            (sender, worker)
+            .await?
+        }
+        None => {
+            let mut conn = connect(&authority, use_tls, connect_timeout, false).await?;
+            let resp = conn.send_request(request, first_byte_timeout).await?;
+            (resp, conn.worker)
         }
-    } else {
-        let tcp_stream = TokioIo::new(tcp_stream);
-        let (sender, conn) = timeout(
-            connect_timeout,
-            // TODO: we should plumb the builder through the http context, and use it here
-            hyper::client::conn::http1::handshake(tcp_stream),
-        )
-        .await
-        .map_err(|_| types::ErrorCode::ConnectionTimeout)?
-        .map_err(hyper_request_error)?;
-
-        let worker = preview2::spawn(async move {
-            match conn.await {
-                Ok(()) => {}
-                // TODO: same as above, shouldn't throw this error away.
-                Err(e) => tracing::warn!("dropping error {e}"),
-            }
-        });
-
-        (sender, worker)
     };
 
-    // at this point, the request contains the scheme and the authority, but
-    // the http packet should only include those if addressing a proxy, so
-    // remove them here, since SendRequest::send_request does not do it for us
-    *request.uri_mut() = http::Uri::builder()
-        .path_and_query(
-            request
-                .uri()
-                .path_and_query()
-                .map(|p| p.as_str())
-                .unwrap_or("/"),
-        )
-        .build()
-        .expect("comes from valid request");
-
-    let resp = timeout(first_byte_timeout, sender.send_request(request))
-        .await
-        .map_err(|_| types::ErrorCode::ConnectionReadTimeout)?
-        .map_err(hyper_request_error)?
-        .map(|body| body.map_err(hyper_request_error).boxed());
-
     Ok(IncomingResponseInternal {
-        resp,
-        worker: Arc::new(worker),
+        resp: resp.map(|body| body.map_err(hyper_request_error).boxed()),
+        worker,
         between_bytes_timeout,
     })
 }
@@ -5,7 +5,15 @@ use http_body::Frame;
 use http_body_util::{combinators::BoxBody, Collected, Empty, StreamBody};
 use hyper::{body::Bytes, server::conn::http1, service::service_fn, Method, StatusCode};
 use sha2::{Digest, Sha256};
-use std::{collections::HashMap, iter, net::Ipv4Addr, str, sync::Arc};
+use std::{
+    collections::HashMap,
+    iter,
+    net::Ipv4Addr,
+    str,
+    sync::atomic::{AtomicUsize, Ordering},
+    sync::Arc,
+    time::Duration,
+};
 use tokio::task;
 use wasmtime::{
     component::{Component, Linker, Resource, ResourceTable},
@@ -16,6 +24,7 @@ use wasmtime_wasi_http::{
     bindings::http::types::ErrorCode,
     body::HyperIncomingBody,
     io::TokioIo,
+    pool::{ConnectionPool, ConnectionPoolConfig},
     types::{self, HostFutureIncomingResponse, IncomingResponseInternal, OutgoingRequest},
     WasiHttpCtx, WasiHttpView,
 };
@@ -35,6 +44,7 @@ struct Ctx {
     stdout: MemoryOutputPipe,
     stderr: MemoryOutputPipe,
     send_request: Option<RequestSender>,
+    connection_pool: Option<ConnectionPool>,
 }
 
 impl WasiView for Ctx {
@@ -75,6 +85,10 @@ impl WasiHttpView for Ctx {
     fn is_forbidden_header(&mut self, name: &hyper::header::HeaderName) -> bool {
         name.as_str() == "custom-forbidden-header"
     }
+
+    fn connection_pool(&mut self) -> Option<ConnectionPool> {
+        self.connection_pool.clone()
+    }
 }
 
 fn store(engine: &Engine, server: &Server) -> Store<Ctx> {
@@ -93,6 +107,7 @@ fn store(engine: &Engine, server: &Server) -> Store<Ctx> {
         stderr,
         stdout,
         send_request: None,
+        connection_pool: None,
     };
 
     Store::new(&engine, ctx)
@@ -152,6 +167,7 @@ async fn run_wasi_http(
         stderr,
         stdout,
         send_request,
+        connection_pool: None,
     };
     let mut store = Store::new(&engine, ctx);
 
@@ -489,6 +505,96 @@ async fn do_wasi_http_echo(uri: &str, url_header: Option<&str>) -> Result<()> {
     Ok(())
 }
 
+#[test_log::test(tokio::test)]
+async fn wasi_http_connection_pool() -> Result<()> {
+    use http_body_util::BodyExt;
+
+    let listener = tokio::net::TcpListener::bind((Ipv4Addr::new(127, 0, 0, 1), 0)).await?;
+    let authority = listener.local_addr()?.to_string();
+    let connections = Arc::new(AtomicUsize::new(0));
+
+    let server = {
+        let connections = connections.clone();
+        task::spawn(async move {
+            loop {
+                let (stream, _) = listener.accept().await?;
+                connections.fetch_add(1, Ordering::SeqCst);
+                task::spawn(async move {
+                    if let Err(e) = http1::Builder::new()
+                        .keep_alive(true)
+                        .serve_connection(
+                            TokioIo::new(stream),
+                            service_fn(|_| async {
+                                Ok::<_, anyhow::Error>(hyper::Response::new(body::full(
+                                    Bytes::from_static(b"pooled"),
+                                )))
+                            }),
+                        )
+                        .await
+                    {
+                        eprintln!("error serving connection: {e:?}");
+                    }
+                });
+
+                // Help rustc with type inference:
+                if false {
+                    return Ok::<_, anyhow::Error>(());
+                }
+            }
+        })
+    };
+
+    let pool = ConnectionPool::new(ConnectionPoolConfig::default());
+    let mut ctx = Ctx {
+        table: ResourceTable::new(),
+        wasi: WasiCtxBuilder::new().build(),
+        http: WasiHttpCtx,
+        stdout: MemoryOutputPipe::new(4096),
+        stderr: MemoryOutputPipe::new(4096),
+        send_request: None,
+        connection_pool: Some(pool.clone()),
+    };
+
+    for _ in 0..3 {
+        let request = hyper::Request::builder()
+            .uri(format!("http://{authority}/"))
+            .header(hyper::header::HOST, &authority)
+            .body(body::empty())?;
+        let response = ctx.send_request(OutgoingRequest {
+            use_tls: false,
+            authority: authority.clone(),
+            request,
+            connect_timeout: Duration::from_secs(10),
+            first_byte_timeout: Duration::from_secs(10),
+            between_bytes_timeout: Duration::from_secs(10),
+        })?;
+        let HostFutureIncomingResponse::Pending(handle) = ctx.table.delete(response)? else {
+            panic!("response should be pending");
+        };
+        let response = handle.await?.map_err(|e| anyhow!("{e:?}"))?;
+        let body = response
+            .resp
+            .into_body()
+            .collect()
+            .await
+            .map_err(|e| anyhow!("{e:?}"))?;
+        assert_eq!(body.to_bytes(), "pooled");
+
+        // The connection goes back into the pool in the background once the
+        // response has been read.
+        while pool.stats().idle == 0 {
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+    }
+
+    assert_eq!(connections.load(Ordering::SeqCst), 1);
+    let stats = pool.stats();
+    assert_eq!((stats.hits, stats.misses), (2, 1));
+
+    server.abort();
+    Ok(())
+}
+
 mod body {
     use http_body_util::{combinators::BoxBody, BodyExt, Empty, Full};
     use hyper::body::Bytes;
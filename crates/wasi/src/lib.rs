@@ -108,6 +108,7 @@ pub fn maybe_exit_on_error(e: anyhow::Error) -> anyhow::Error {
         .map(|e| e.0)
         .or_else(|| e.downcast_ref::<preview2::I32Exit>().map(|e| e.0));
     if let Some(exit) = code {
+        preview2::flush_stdio_buffers();
         // Print the error message in the usual way.
         // On Windows, exit status 3 indicates an abort (see below),
         // so return 1 indicating a non-zero status to avoid ambiguity.
@@ -121,6 +122,7 @@ pub fn maybe_exit_on_error(e: anyhow::Error) -> anyhow::Error {
     // to the outside environment indicating a more severe problem
     // than a simple failure.
     if e.is::<Trap>() {
+        preview2::flush_stdio_buffers();
         eprintln!("Error: {:?}", e);
 
         if cfg!(unix) {
@@ -11,6 +11,7 @@ use crate::preview2::{
 };
 use cap_rand::{Rng, RngCore, SeedableRng};
 use std::sync::Arc;
+use std::time::Duration;
 use std::{mem, net::SocketAddr};
 use wasmtime::component::ResourceTable;
 
@@ -113,6 +114,16 @@ impl WasiCtxBuilder {
         self.inherit_stdin().inherit_stdout().inherit_stderr()
     }
 
+    /// Like [`inherit_stdio`](Self::inherit_stdio), but coalesces the guest's
+    /// writes to stdout and stderr in a [`StdioBuffer`](stdio::StdioBuffer)
+    /// of `capacity` bytes which holds output for at most `max_delay`.
+    pub fn inherit_stdio_buffered(&mut self, capacity: usize, max_delay: Duration) -> &mut Self {
+        let buffer = stdio::StdioBuffer::new(capacity, max_delay);
+        self.inherit_stdin()
+            .stdout(buffer.stdout())
+            .stderr(buffer.stderr())
+    }
+
     pub fn envs(&mut self, env: &[(impl AsRef<str>, impl AsRef<str>)]) -> &mut Self {
         self.env.extend(
             env.iter()
@@ -143,14 +143,19 @@ impl FileInputStream {
 
     pub async fn read(&mut self, size: usize) -> Result<Bytes, StreamError> {
         use system_interface::fs::FileIoExt;
-        let f = Arc::clone(&self.file);
+        let mut buf = BytesMut::zeroed(size);
         let p = self.position;
-        let (r, mut buf) = spawn_blocking(move || {
-            let mut buf = BytesMut::zeroed(size);
-            let r = f.read_at(&mut buf, p);
-            (r, buf)
-        })
-        .await;
+        let (r, mut buf) = match read_nowait(&self.file, &mut buf, p) {
+            Some(r) => (r, buf),
+            None => {
+                let f = Arc::clone(&self.file);
+                spawn_blocking(move || {
+                    let r = f.read_at(&mut buf, p);
+                    (r, buf)
+                })
+                .await
+            }
+        };
         let n = read_result(r)?;
         buf.truncate(n);
         self.position += n as u64;
@@ -163,6 +168,57 @@ impl FileInputStream {
     }
 }
 
+/// Reads from `file` at `offset` on the current thread if that can be done
+/// without blocking, which avoids a round trip through the blocking thread
+/// pool for data which is already in the page cache.
+///
+/// On Linux this uses `preadv2` with `RWF_NOWAIT`, which fails with `EAGAIN`
+/// rather than waiting for the disk. `None` is returned when the read would
+/// block, when this isn't supported by the kernel or the file's filesystem,
+/// or when the arguments are rejected, in which case the read should be done
+/// on the blocking pool as usual.
+pub(crate) fn read_nowait(
+    file: &cap_std::fs::File,
+    buf: &mut [u8],
+    offset: u64,
+) -> Option<io::Result<usize>> {
+    #[cfg(target_os = "linux")]
+    {
+        use rustix::io::{Errno, ReadWriteFlags};
+        use std::sync::atomic::{AtomicBool, Ordering};
+
+        static UNSUPPORTED: AtomicBool = AtomicBool::new(false);
+        if buf.is_empty() || UNSUPPORTED.load(Ordering::Relaxed) {
+            return None;
+        }
+        match rustix::io::preadv2(
+            file,
+            &mut [io::IoSliceMut::new(buf)],
+            offset,
+            ReadWriteFlags::NOWAIT,
+        ) {
+            Ok(n) => Some(Ok(n)),
+            // Kernels without `preadv2`.
+            Err(Errno::NOSYS) => {
+                UNSUPPORTED.store(true, Ordering::Relaxed);
+                None
+            }
+            // `EOPNOTSUPP` comes from files whose filesystem doesn't support
+            // `RWF_NOWAIT`, such as FUSE or NFS, and `EINVAL` from arguments
+            // such as an offset too large for `off_t`. Other files may still
+            // support this, so only this read is left to the blocking pool,
+            // which reports the error if any.
+            Err(Errno::AGAIN) | Err(Errno::OPNOTSUPP) | Err(Errno::INVAL) => None,
+            Err(e) => Some(Err(e.into())),
+        }
+    }
+    #[cfg(not(target_os = "linux"))]
+    {
+        let _ = (file, buf, offset);
+        None
+    }
+}
+
 fn read_result(r: io::Result<usize>) -> Result<usize, StreamError> {
     match r {
         Ok(0) => Err(StreamError::Closed),
@@ -227,13 +227,18 @@ impl<T: WasiView> HostDescriptor for T {
             return Err(ErrorCode::NotPermitted.into());
         }
 
-        let (mut buffer, r) = f
-            .spawn_blocking(move |f| {
-                let mut buffer = vec![0; len.try_into().unwrap_or(usize::MAX)];
-                let r = f.read_vectored_at(&mut [IoSliceMut::new(&mut buffer)], offset);
-                (buffer, r)
-            })
-            .await;
+        let mut buffer = vec![0; len.try_into().unwrap_or(usize::MAX)];
+        let (mut buffer, r) =
+            match crate::preview2::filesystem::read_nowait(&f.file, &mut buffer, offset) {
+                Some(r) => (buffer, r),
+                None => {
+                    f.spawn_blocking(move |f| {
+                        let r = f.read_vectored_at(&mut [IoSliceMut::new(&mut buffer)], offset);
+                        (buffer, r)
+                    })
+                    .await
+                }
+            };
 
         let (bytes_read, state) = match r? {
             0 => (0, true),
@@ -562,9 +567,48 @@ impl<T: WasiView> HostDescriptor for T {
             NotDir,
         }
 
+        // On Linux try opening the file with a single `openat2`, with the
+        // final flags, before going through cap-std.
+        #[cfg(target_os = "linux")]
+        let fast_flags = {
+            use rustix::fs::OFlags as O;
+            // Match the access mode cap-std is given above.
+            let read =
+                flags.contains(DescriptorFlags::READ) || !flags.contains(DescriptorFlags::WRITE);
+            let write =
+                flags.contains(DescriptorFlags::WRITE) || oflags.contains(OpenFlags::CREATE);
+            let mut fast_flags = match (read, write) {
+                (true, true) => O::RDWR,
+                (false, true) => O::WRONLY,
+                _ => O::RDONLY,
+            };
+            if oflags.contains(OpenFlags::CREATE) {
+                fast_flags |= O::CREATE;
+                if oflags.contains(OpenFlags::EXCLUSIVE) {
+                    fast_flags |= O::EXCL;
+                }
+            }
+            if oflags.contains(OpenFlags::TRUNCATE) {
+                fast_flags |= O::TRUNC;
+            }
+            if !symlink_follow(path_flags) {
+                fast_flags |= O::NOFOLLOW;
+            }
+            fast_flags | O::NONBLOCK
+        };
+
         let opened = d
             .spawn_blocking::<_, std::io::Result<OpenResult>>(move |d| {
-                let mut opened = d.open_with(&path, &opts)?;
+                #[cfg(target_os = "linux")]
+                let fast = wasi_common::dir::open_beneath(d, &path, fast_flags);
+                #[cfg(not(target_os = "linux"))]
+                let fast: Option<std::io::Result<cap_std::fs::File>> = None;
+
+                let nonblock_set = fast.is_some();
+                let mut opened = match fast {
+                    Some(result) => result?,
+                    None => d.open_with(&path, &opts)?,
+                };
                 if opened.metadata()?.is_dir() {
                     Ok(OpenResult::Dir(cap_std::fs::Dir::from_std_file(
                         opened.into_std(),
@@ -574,8 +618,10 @@ impl<T: WasiView> HostDescriptor for T {
                 } else {
                     // FIXME cap-std needs a nonblocking open option so that files reads and writes
                     // are nonblocking. Instead we set it after opening here:
-                    let set_fd_flags = opened.new_set_fd_flags(FdFlags::NONBLOCK)?;
-                    opened.set_fd_flags(set_fd_flags)?;
+                    if !nonblock_set {
+                        let set_fd_flags = opened.new_set_fd_flags(FdFlags::NONBLOCK)?;
+                        opened.set_fd_flags(set_fd_flags)?;
+                    }
                     Ok(OpenResult::File(opened))
                 }
             })
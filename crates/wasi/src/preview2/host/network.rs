@@ -622,4 +622,164 @@ pub(crate) mod util {
             r => r,
         }
     }
+
+    /// The most datagrams received or sent with a single `recvmmsg` or
+    /// `sendmmsg` call.
+    #[cfg(target_os = "linux")]
+    pub const UDP_BATCH_SIZE: usize = 16;
+
+    /// Receives datagrams with a single `recvmmsg` call, into consecutive
+    /// `slot_size` chunks of `buf`. Returns the length and sender of each
+    /// datagram received, in order.
+    #[cfg(target_os = "linux")]
+    pub fn udp_recv_batch<Fd: AsFd>(
+        sockfd: Fd,
+        buf: &mut [u8],
+        slot_size: usize,
+    ) -> std::io::Result<Vec<(usize, SocketAddr)>> {
+        use std::os::fd::AsRawFd;
+
+        let n = buf.len() / slot_size;
+        assert!(n <= UDP_BATCH_SIZE);
+        unsafe {
+            let mut addrs: [libc::sockaddr_storage; UDP_BATCH_SIZE] = std::mem::zeroed();
+            let mut iovecs: [libc::iovec; UDP_BATCH_SIZE] = std::mem::zeroed();
+            let mut msgs: [libc::mmsghdr; UDP_BATCH_SIZE] = std::mem::zeroed();
+            for (i, slot) in buf.chunks_exact_mut(slot_size).enumerate() {
+                iovecs[i] = libc::iovec {
+                    iov_base: slot.as_mut_ptr().cast(),
+                    iov_len: slot.len(),
+                };
+                let hdr = &mut msgs[i].msg_hdr;
+                hdr.msg_name = addrs.as_mut_ptr().add(i).cast();
+                hdr.msg_namelen = std::mem::size_of::<libc::sockaddr_storage>() as _;
+                hdr.msg_iov = iovecs.as_mut_ptr().add(i);
+                hdr.msg_iovlen = 1;
+            }
+            let received = libc::recvmmsg(
+                sockfd.as_fd().as_raw_fd(),
+                msgs.as_mut_ptr(),
+                n as _,
+                libc::MSG_DONTWAIT,
+                std::ptr::null_mut(),
+            );
+            if received < 0 {
+                return Err(std::io::Error::last_os_error());
+            }
+            msgs[..received as usize]
+                .iter()
+                .zip(&addrs)
+                .map(|(msg, addr)| Ok((msg.msg_len as usize, from_sockaddr(addr)?)))
+                .collect()
+        }
+    }
+
+    /// Sends datagrams, each to the given address or to the connected peer
+    /// if there isn't one, with as few `sendmmsg` calls as possible. Returns
+    /// how many were sent, and only fails if none were.
+    #[cfg(target_os = "linux")]
+    pub fn udp_send_batch<Fd: AsFd>(
+        sockfd: Fd,
+        datagrams: &[(&[u8], Option<SocketAddr>)],
+    ) -> std::io::Result<usize> {
+        use std::os::fd::AsRawFd;
+
+        let mut total = 0;
+        for chunk in datagrams.chunks(UDP_BATCH_SIZE) {
+            let sent = unsafe {
+                let mut addrs: [libc::sockaddr_storage; UDP_BATCH_SIZE] = std::mem::zeroed();
+                let mut iovecs: [libc::iovec; UDP_BATCH_SIZE] = std::mem::zeroed();
+                let mut msgs: [libc::mmsghdr; UDP_BATCH_SIZE] = std::mem::zeroed();
+                for (i, (data, addr)) in chunk.iter().enumerate() {
+                    iovecs[i] = libc::iovec {
+                        iov_base: data.as_ptr() as *mut _,
+                        iov_len: data.len(),
+                    };
+                    let hdr = &mut msgs[i].msg_hdr;
+                    if let Some(addr) = addr {
+                        hdr.msg_namelen = to_sockaddr(addr, &mut addrs[i]);
+                        hdr.msg_name = addrs.as_mut_ptr().add(i).cast();
+                    }
+                    hdr.msg_iov = iovecs.as_mut_ptr().add(i);
+                    hdr.msg_iovlen = 1;
+                }
+                libc::sendmmsg(
+                    sockfd.as_fd().as_raw_fd(),
+                    msgs.as_mut_ptr(),
+                    chunk.len() as _,
+                    libc::MSG_DONTWAIT,
+                )
+            };
+            if sent < 0 {
+                if total > 0 {
+                    break;
+                }
+                return Err(std::io::Error::last_os_error());
+            }
+            total += sent as usize;
+            if (sent as usize) < chunk.len() {
+                break;
+            }
+        }
+        Ok(total)
+    }
+
+    #[cfg(target_os = "linux")]
+    fn from_sockaddr(addr: &libc::sockaddr_storage) -> std::io::Result<SocketAddr> {
+        use std::net::{Ipv4Addr, SocketAddrV4, SocketAddrV6};
+
+        match addr.ss_family as libc::c_int {
+            libc::AF_INET => {
+                let addr = unsafe { &*(addr as *const _ as *const libc::sockaddr_in) };
+                Ok(SocketAddr::V4(SocketAddrV4::new(
+                    Ipv4Addr::from(u32::from_be(addr.sin_addr.s_addr)),
+                    u16::from_be(addr.sin_port),
+                )))
+            }
+            libc::AF_INET6 => {
+                let addr = unsafe { &*(addr as *const _ as *const libc::sockaddr_in6) };
+                Ok(SocketAddr::V6(SocketAddrV6::new(
+                    Ipv6Addr::from(addr.sin6_addr.s6_addr),
+                    u16::from_be(addr.sin6_port),
+                    addr.sin6_flowinfo,
+                    addr.sin6_scope_id,
+                )))
+            }
+            _ => Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "unexpected address family",
+            )),
+        }
+    }
+
+    #[cfg(target_os = "linux")]
+    fn to_sockaddr(addr: &SocketAddr, storage: &mut libc::sockaddr_storage) -> libc::socklen_t {
+        match addr {
+            SocketAddr::V4(addr) => {
+                let sin = libc::sockaddr_in {
+                    sin_family: libc::AF_INET as libc::sa_family_t,
+                    sin_port: addr.port().to_be(),
+                    sin_addr: libc::in_addr {
+                        s_addr: u32::from(*addr.ip()).to_be(),
+                    },
+                    sin_zero: [0; 8],
+                };
+                unsafe { std::ptr::write(storage as *mut _ as *mut libc::sockaddr_in, sin) };
+                std::mem::size_of::<libc::sockaddr_in>() as libc::socklen_t
+            }
+            SocketAddr::V6(addr) => {
+                let sin6 = libc::sockaddr_in6 {
+                    sin6_family: libc::AF_INET6 as libc::sa_family_t,
+                    sin6_port: addr.port().to_be(),
+                    sin6_flowinfo: addr.flowinfo(),
+                    sin6_addr: libc::in6_addr {
+                        s6_addr: addr.ip().octets(),
+                    },
+                    sin6_scope_id: addr.scope_id(),
+                };
+                unsafe { std::ptr::write(storage as *mut _ as *mut libc::sockaddr_in6, sin6) };
+                std::mem::size_of::<libc::sockaddr_in6>() as libc::socklen_t
+            }
+        }
+    }
 }
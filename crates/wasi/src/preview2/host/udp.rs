@@ -23,6 +23,14 @@ use wasmtime::component::Resource;
 /// In practice, datagrams are typically less than 1500 bytes.
 const MAX_UDP_DATAGRAM_SIZE: usize = u16::MAX as usize;
 
+#[cfg(target_os = "linux")]
+thread_local! {
+    /// Space for receiving a batch of datagrams at once. It's shared by all
+    /// the streams on a thread rather than kept in each of them, as guests
+    /// may hold many sockets, and grows to the largest batch received so far.
+    static RECV_BUFFER: std::cell::RefCell<Vec<u8>> = std::cell::RefCell::new(Vec::new());
+}
+
 impl<T: WasiView> udp::Host for T {}
 
 impl<T: WasiView> udp::HostUdpSocket for T {
@@ -336,6 +344,7 @@ impl<T: WasiView> udp::HostIncomingDatagramStream for T {
         max_results: u64,
     ) -> SocketResult<Vec<udp::IncomingDatagram>> {
         // Returns Ok(None) when the message was dropped.
+        #[cfg(not(target_os = "linux"))]
         fn recv_one(
             stream: &IncomingDatagramStream,
         ) -> SocketResult<Option<udp::IncomingDatagram>> {
@@ -357,8 +366,8 @@ impl<T: WasiView> udp::HostIncomingDatagramStream for T {
             }))
         }
 
-        let table = self.table();
-        let stream = table.get(&this)?;
+        let table = self.table_mut();
+        let stream = table.get_mut(&this)?;
         let max_results: usize = max_results.try_into().unwrap_or(usize::MAX);
 
         if max_results == 0 {
@@ -367,6 +376,54 @@ impl<T: WasiView> udp::HostIncomingDatagramStream for T {
 
         let mut datagrams = vec![];
 
+        // On Linux receive up to a batch of datagrams per syscall.
+        #[cfg(target_os = "linux")]
+        RECV_BUFFER.with(|recv_buffer| -> SocketResult<()> {
+            let IncomingDatagramStream {
+                inner,
+                remote_address,
+            } = stream;
+            let mut recv_buffer = recv_buffer.borrow_mut();
+            let len = max_results.min(util::UDP_BATCH_SIZE) * MAX_UDP_DATAGRAM_SIZE;
+            if recv_buffer.len() < len {
+                recv_buffer.resize(len, 0);
+            }
+
+            while datagrams.len() < max_results {
+                let batch = (max_results - datagrams.len()).min(util::UDP_BATCH_SIZE);
+                let buf = &mut recv_buffer[..batch * MAX_UDP_DATAGRAM_SIZE];
+                let received = match inner.try_io(Interest::READABLE, || {
+                    util::udp_recv_batch(&**inner, buf, MAX_UDP_DATAGRAM_SIZE)
+                }) {
+                    Ok(received) => received,
+                    Err(_) if datagrams.len() > 0 => return Ok(()),
+                    Err(e) if e.kind() == std::io::ErrorKind::WouldBlock => return Ok(()),
+                    Err(e) => return Err(e.into()),
+                };
+
+                let count = received.len();
+                for (i, (size, received_addr)) in received.into_iter().enumerate() {
+                    match remote_address {
+                        // Normally, this should have already been checked for us by the OS.
+                        Some(connected_addr) if *connected_addr != received_addr => continue,
+                        _ => {}
+                    }
+                    let start = i * MAX_UDP_DATAGRAM_SIZE;
+                    datagrams.push(udp::IncomingDatagram {
+                        data: recv_buffer[start..start + size].into(),
+                        remote_address: received_addr.into(),
+                    });
+                }
+
+                // A short batch means nothing else is queued right now.
+                if count < batch {
+                    break;
+                }
+            }
+            Ok(())
+        })?;
+
+        #[cfg(not(target_os = "linux"))]
         while datagrams.len() < max_results {
             match recv_one(stream) {
                 Ok(Some(datagram)) => {
@@ -443,10 +500,12 @@ impl<T: WasiView> udp::HostOutgoingDatagramStream for T {
         this: Resource<udp::OutgoingDatagramStream>,
         datagrams: Vec<udp::OutgoingDatagram>,
     ) -> SocketResult<u64> {
-        fn send_one(
+        // Validates a datagram, returning the address to send it to, or
+        // `None` to send it to the connected peer.
+        fn destination(
             stream: &OutgoingDatagramStream,
             datagram: &udp::OutgoingDatagram,
-        ) -> SocketResult<()> {
+        ) -> SocketResult<Option<SocketAddr>> {
             if datagram.data.len() > MAX_UDP_DATAGRAM_SIZE {
                 return Err(ErrorCode::DatagramTooLarge.into());
             }
@@ -471,12 +530,89 @@ impl<T: WasiView> udp::HostOutgoingDatagramStream for T {
             util::validate_address_family(&addr, &stream.family)?;
 
             if stream.remote_address == Some(addr) {
-                stream.inner.try_send(&datagram.data)?;
+                Ok(None)
             } else {
-                stream.inner.try_send_to(&datagram.data, addr)?;
+                Ok(Some(addr))
             }
+        }
 
-            Ok(())
+        // Sends the valid datagrams, up to the first invalid one, with as few
+        // syscalls as possible.
+        #[cfg(target_os = "linux")]
+        fn send_all(
+            stream: &mut OutgoingDatagramStream,
+            datagrams: Vec<udp::OutgoingDatagram>,
+        ) -> SocketResult<u64> {
+            let mut batch = Vec::with_capacity(datagrams.len());
+            let mut invalid = None;
+            for datagram in datagrams.iter() {
+                match destination(stream, datagram) {
+                    Ok(addr) => batch.push((&datagram.data[..], addr)),
+                    Err(e) => {
+                        invalid = Some(e);
+                        break;
+                    }
+                }
+            }
+
+            let count = if batch.is_empty() {
+                0
+            } else {
+                match stream.inner.try_io(Interest::WRITABLE, || {
+                    util::udp_send_batch(&*stream.inner, &batch)
+                }) {
+                    Ok(count) => count,
+                    Err(e) if e.kind() == std::io::ErrorKind::WouldBlock => {
+                        stream.send_state = SendState::Waiting;
+                        return Ok(0);
+                    }
+                    Err(e) => return Err(e.into()),
+                }
+            };
+
+            match invalid {
+                // WIT: "If at least one datagram has been sent successfully, this function never returns an error."
+                Some(e) if count == 0 => Err(e),
+                _ => Ok(count as u64),
+            }
+        }
+
+        #[cfg(not(target_os = "linux"))]
+        fn send_all(
+            stream: &mut OutgoingDatagramStream,
+            datagrams: Vec<udp::OutgoingDatagram>,
+        ) -> SocketResult<u64> {
+            fn send_one(
+                stream: &OutgoingDatagramStream,
+                datagram: &udp::OutgoingDatagram,
+            ) -> SocketResult<()> {
+                match destination(stream, datagram)? {
+                    None => stream.inner.try_send(&datagram.data)?,
+                    Some(addr) => stream.inner.try_send_to(&datagram.data, addr)?,
+                };
+                Ok(())
+            }
+
+            let mut count = 0;
+
+            for datagram in datagrams {
+                match send_one(stream, &datagram) {
+                    Ok(_) => count += 1,
+                    Err(_) if count > 0 => {
+                        // WIT: "If at least one datagram has been sent successfully, this function never returns an error."
+                        return Ok(count);
+                    }
+                    Err(e) if matches!(e.downcast_ref(), Some(ErrorCode::WouldBlock)) => {
+                        stream.send_state = SendState::Waiting;
+                        return Ok(count);
+                    }
+                    Err(e) => {
+                        return Err(e);
+                    }
+                }
+            }
+
+            Ok(count)
         }
 
         let table = self.table_mut();
@@ -502,26 +638,7 @@ impl<T: WasiView> udp::HostOutgoingDatagramStream for T {
             return Ok(0);
         }
 
-        let mut count = 0;
-
-        for datagram in datagrams {
-            match send_one(stream, &datagram) {
-                Ok(_) => count += 1,
-                Err(_) if count > 0 => {
-                    // WIT: "If at least one datagram has been sent successfully, this function never returns an error."
-                    return Ok(count);
-                }
-                Err(e) if matches!(e.downcast_ref(), Some(ErrorCode::WouldBlock)) => {
-                    stream.send_state = SendState::Waiting;
-                    return Ok(count);
-                }
-                Err(e) => {
-                    return Err(e);
-                }
-            }
-        }
-
-        Ok(count)
+        send_all(stream, datagrams)
     }
 
     fn subscribe(
@@ -1,5 +1,7 @@
 use crate::preview2::{bindings::io::poll, WasiView};
 use anyhow::Result;
+use futures::stream::FuturesUnordered;
+use futures::{FutureExt, StreamExt};
 use std::any::Any;
 use std::collections::HashMap;
 use std::future::Future;
@@ -82,34 +84,35 @@ impl<T: WasiView> poll::Host for T {
             list.push(ix);
         }
 
-        let mut futures: Vec<(PollableFuture<'_>, Vec<ReadylistIndex>)> = Vec::new();
+        let mut futures = FuturesUnordered::new();
         for (entry, (make_future, readylist_indices)) in table.iter_entries(table_futures) {
             let entry = entry?;
-            futures.push((make_future(entry), readylist_indices));
+            futures.push(make_future(entry).map(move |()| readylist_indices));
         }
 
-        struct PollList<'a> {
-            futures: Vec<(PollableFuture<'a>, Vec<ReadylistIndex>)>,
+        // Every future is polled once to subscribe it, but after that only the
+        // futures which have been woken are polled again. This keeps each
+        // wakeup proportional to the number of pollables it concerns rather
+        // than to the size of the list, which matters when a guest is waiting
+        // on thousands of mostly idle pollables.
+        struct PollList<F> {
+            futures: FuturesUnordered<F>,
         }
-        impl<'a> Future for PollList<'a> {
+        impl<F> Future for PollList<F>
+        where
+            F: Future<Output = Vec<ReadylistIndex>> + Unpin,
+        {
             type Output = Vec<u32>;
 
             fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
-                let mut any_ready = false;
                 let mut results = Vec::new();
-                for (fut, readylist_indicies) in self.futures.iter_mut() {
-                    match fut.as_mut().poll(cx) {
-                        Poll::Ready(()) => {
-                            results.extend_from_slice(readylist_indicies);
-                            any_ready = true;
-                        }
-                        Poll::Pending => {}
-                    }
+                while let Poll::Ready(Some(readylist_indices)) = self.futures.poll_next_unpin(cx) {
+                    results.extend(readylist_indices);
                 }
-                if any_ready {
-                    Poll::Ready(results)
-                } else {
+                if results.is_empty() {
                     Poll::Pending
+                } else {
+                    Poll::Ready(results)
                 }
             }
         }
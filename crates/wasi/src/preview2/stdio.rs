@@ -59,6 +59,9 @@ impl StdinStream for pipe::ClosedInputStream {
 mod worker_thread_stdin;
 pub use self::worker_thread_stdin::{stdin, Stdin};
 
+mod buffered;
+pub use self::buffered::{flush_stdio_buffers, BufferedStderr, BufferedStdout, StdioBuffer};
+
 /// Similar to [`StdinStream`], except for output.
 pub trait StdoutStream: Send + Sync {
     /// Returns a fresh new stream which can write to this output stream.
@@ -0,0 +1,432 @@
+//! Coalescing of small writes to the host's stdout and stderr.
+//!
+//! Guests which print a lot tend to do so a line at a time, and without
+//! buffering each line becomes its own `write` syscall. The buffer here
+//! collects output from both streams and writes it out in larger chunks.
+//!
+//! * Stdout and stderr share a buffer, and output is written out in the order
+//!   it was buffered, so the two stay correctly interleaved when they go to
+//!   the same place, such as a terminal.
+//!
+//! * Output which sits in the buffer for too long is written out by a helper
+//!   thread. A timer on a Tokio runtime wouldn't do here, as in synchronous
+//!   mode the runtime only runs while the guest is calling into the host.
+//!
+//! * The process may exit without dropping the buffers, for example when the
+//!   guest calls `exit`, so [`flush_stdio_buffers`] is provided to write out
+//!   everything before that happens.
+
+use crate::preview2::poll::Subscribe;
+use crate::preview2::stdio::StdoutStream;
+use crate::preview2::{HostOutputStream, StreamError, StreamResult};
+use bytes::Bytes;
+use std::io::{self, IsTerminal, Write};
+use std::sync::mpsc::{self, RecvTimeoutError};
+use std::sync::{Arc, Mutex, Weak};
+use std::time::{Duration, Instant};
+
+/// A buffer which coalesces writes to the host's stdout and stderr.
+///
+/// Buffered output is written out when the buffer fills up, when the guest
+/// flushes either stream, once it has been buffered for `max_delay`, when the
+/// buffer is dropped, or by [`flush_stdio_buffers`]. Writes larger than the
+/// buffer bypass it.
+///
+/// Use [`StdioBuffer::stdout`] and [`StdioBuffer::stderr`] with
+/// [`WasiCtxBuilder::stdout`](crate::preview2::WasiCtxBuilder::stdout) and
+/// [`WasiCtxBuilder::stderr`](crate::preview2::WasiCtxBuilder::stderr), or
+/// [`WasiCtxBuilder::inherit_stdio_buffered`](crate::preview2::WasiCtxBuilder::inherit_stdio_buffered).
+#[derive(Clone)]
+pub struct StdioBuffer(Arc<Shared>);
+
+struct Shared {
+    capacity: usize,
+    max_delay: Duration,
+    state: Mutex<State>,
+    /// Where output is written out to, which is `write_to` outside of tests.
+    output: Output,
+}
+
+type Output = Box<dyn Fn(Dest, &[u8]) -> io::Result<()> + Send + Sync>;
+
+#[derive(Default)]
+struct State {
+    data: Vec<u8>,
+    /// Where each consecutive run of `data` goes, and where it ends.
+    runs: Vec<(Dest, usize)>,
+    /// An error from writing out the buffer in the background, reported by
+    /// the next write or flush.
+    error: Option<io::Error>,
+}
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+enum Dest {
+    Stdout,
+    Stderr,
+}
+
+/// Every buffer, so they can all be flushed before the process exits.
+static BUFFERS: Mutex<Vec<Weak<Shared>>> = Mutex::new(Vec::new());
+
+/// Buffers which have had output waiting since the given time, sent to the
+/// thread which writes it out once it's been waiting too long.
+static FLUSHER: once_cell::sync::Lazy<mpsc::Sender<(Instant, Weak<Shared>)>> =
+    once_cell::sync::Lazy::new(|| {
+        let (tx, rx) = mpsc::channel();
+        std::thread::Builder::new()
+            .name("wasi-stdio-flush".to_string())
+            .spawn(move || flusher(rx))
+            .expect("failed to spawn stdio flush thread");
+        tx
+    });
+
+impl StdioBuffer {
+    /// Creates a buffer of `capacity` bytes, which holds output for at most
+    /// `max_delay`.
+    pub fn new(capacity: usize, max_delay: Duration) -> StdioBuffer {
+        StdioBuffer::with_output(capacity, max_delay, Box::new(write_to))
+    }
+
+    fn with_output(capacity: usize, max_delay: Duration, output: Output) -> StdioBuffer {
+        let shared = Arc::new(Shared {
+            capacity,
+            max_delay,
+            state: Mutex::new(State::default()),
+            output,
+        });
+        let mut buffers = BUFFERS.lock().unwrap();
+        buffers.retain(|b| b.strong_count() > 0);
+        buffers.push(Arc::downgrade(&shared));
+        StdioBuffer(shared)
+    }
+
+    /// Returns a [`StdoutStream`] which writes to the host's stdout through
+    /// this buffer.
+    pub fn stdout(&self) -> BufferedStdout {
+        BufferedStdout(self.0.clone())
+    }
+
+    /// Returns a [`StdoutStream`] which writes to the host's stderr through
+    /// this buffer.
+    pub fn stderr(&self) -> BufferedStderr {
+        BufferedStderr(self.0.clone())
+    }
+
+    /// Writes out everything in the buffer.
+    pub fn flush(&self) -> io::Result<()> {
+        self.0.flush()
+    }
+}
+
+/// Writes out the contents of every [`StdioBuffer`] in the process.
+///
+/// This should be called before exiting the process without dropping the
+/// buffers, as otherwise the output in them is lost.
+pub fn flush_stdio_buffers() {
+    let buffers = BUFFERS.lock().unwrap().clone();
+    for buffer in buffers.iter().filter_map(|b| b.upgrade()) {
+        let _ = buffer.flush();
+    }
+}
+
+impl Shared {
+    fn write(self: &Arc<Self>, dest: Dest, bytes: &[u8]) -> io::Result<()> {
+        let mut state = self.state.lock().unwrap();
+        if let Some(e) = state.error.take() {
+            return Err(e);
+        }
+        if state.data.len() + bytes.len() > self.capacity {
+            state.write_out(&self.output)?;
+            if bytes.len() > self.capacity {
+                return (self.output)(dest, bytes);
+            }
+        }
+        if bytes.is_empty() {
+            return Ok(());
+        }
+
+        let was_empty = state.data.is_empty();
+        state.data.extend_from_slice(bytes);
+        let end = state.data.len();
+        match state.runs.last_mut() {
+            Some((last, last_end)) if *last == dest => *last_end = end,
+            _ => state.runs.push((dest, end)),
+        }
+        drop(state);
+
+        if was_empty {
+            let _ = FLUSHER.send((Instant::now() + self.max_delay, Arc::downgrade(self)));
+        }
+        Ok(())
+    }
+
+    fn flush(&self) -> io::Result<()> {
+        let mut state = self.state.lock().unwrap();
+        if let Some(e) = state.error.take() {
+            return Err(e);
+        }
+        state.write_out(&self.output)
+    }
+}
+
+impl Drop for Shared {
+    fn drop(&mut self) {
+        let _ = self.state.get_mut().unwrap().write_out(&self.output);
+    }
+}
+
+impl State {
+    fn write_out(&mut self, output: &Output) -> io::Result<()> {
+        let mut start = 0;
+        let result = self.runs.iter().try_for_each(|&(dest, end)| {
+            let run = &self.data[start..end];
+            start = end;
+            output(dest, run)
+        });
+        self.data.clear();
+        self.runs.clear();
+        result
+    }
+}
+
+fn write_to(dest: Dest, bytes: &[u8]) -> io::Result<()> {
+    match dest {
+        // The standard library's stdout is line buffered, so it needs a flush
+        // to write out anything after the last newline.
+        Dest::Stdout => {
+            let mut stdout = io::stdout().lock();
+            stdout.write_all(bytes)?;
+            stdout.flush()
+        }
+        Dest::Stderr => io::stderr().write_all(bytes),
+    }
+}
+
+fn flusher(rx: mpsc::Receiver<(Instant, Weak<Shared>)>) {
+    let mut pending: Vec<(Instant, Weak<Shared>)> = Vec::new();
+    loop {
+        let next = pending.iter().map(|(deadline, _)| *deadline).min();
+        let received = match next {
+            Some(deadline) => rx.recv_timeout(deadline.saturating_duration_since(Instant::now())),
+            None => rx.recv().map_err(|_| RecvTimeoutError::Disconnected),
+        };
+        match received {
+            Ok(buffer) => pending.push(buffer),
+            Err(RecvTimeoutError::Timeout) => {}
+            Err(RecvTimeoutError::Disconnected) => return,
+        }
+
+        // If a buffer was written out and refilled since it was sent here
+        // then this is a little early, which is harmless.
+        let now = Instant::now();
+        pending.retain(|(deadline, buffer)| {
+            if *deadline > now {
+                return true;
+            }
+            if let Some(buffer) = buffer.upgrade() {
+                let mut state = buffer.state.lock().unwrap();
+                if let Err(e) = state.write_out(&buffer.output) {
+                    state.error = Some(e);
+                }
+            }
+            false
+        });
+    }
+}
+
+/// A [`StdoutStream`] for the host's stdout, buffered by a [`StdioBuffer`].
+pub struct BufferedStdout(Arc<Shared>);
+
+impl StdoutStream for BufferedStdout {
+    fn stream(&self) -> Box<dyn HostOutputStream> {
+        Box::new(BufferedOutputStream {
+            buffer: self.0.clone(),
+            dest: Dest::Stdout,
+        })
+    }
+
+    fn isatty(&self) -> bool {
+        io::stdout().is_terminal()
+    }
+}
+
+/// A [`StdoutStream`] for the host's stderr, buffered by a [`StdioBuffer`].
+pub struct BufferedStderr(Arc<Shared>);
+
+impl StdoutStream for BufferedStderr {
+    fn stream(&self) -> Box<dyn HostOutputStream> {
+        Box::new(BufferedOutputStream {
+            buffer: self.0.clone(),
+            dest: Dest::Stderr,
+        })
+    }
+
+    fn isatty(&self) -> bool {
+        io::stderr().is_terminal()
+    }
+}
+
+struct BufferedOutputStream {
+    buffer: Arc<Shared>,
+    dest: Dest,
+}
+
+impl HostOutputStream for BufferedOutputStream {
+    fn write(&mut self, bytes: Bytes) -> StreamResult<()> {
+        self.buffer
+            .write(self.dest, &bytes)
+            .map_err(|e| StreamError::LastOperationFailed(anyhow::anyhow!(e)))
+    }
+
+    fn flush(&mut self) -> StreamResult<()> {
+        self.buffer
+            .flush()
+            .map_err(|e| StreamError::LastOperationFailed(anyhow::anyhow!(e)))
+    }
+
+    fn check_write(&mut self) -> StreamResult<usize> {
+        Ok(1024 * 1024)
+    }
+}
+
+#[async_trait::async_trait]
+impl Subscribe for BufferedOutputStream {
+    async fn ready(&mut self) {}
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    type Written = Arc<Mutex<Vec<(Dest, Vec<u8>)>>>;
+
+    /// Creates a buffer which records what it writes out instead of writing
+    /// to the host's stdio.
+    fn buffer(capacity: usize, max_delay: Duration) -> (StdioBuffer, Written) {
+        let written = Written::default();
+        let output = {
+            let written = written.clone();
+            Box::new(move |dest, bytes: &[u8]| {
+                written.lock().unwrap().push((dest, bytes.to_vec()));
+                Ok(())
+            })
+        };
+        (
+            StdioBuffer::with_output(capacity, max_delay, output),
+            written,
+        )
+    }
+
+    /// Returns what was written out so far, joining consecutive writes to
+    /// the same stream, as `flush_stdio_buffers` in another test may have
+    /// split them.
+    fn written(written: &Written) -> Vec<(Dest, Vec<u8>)> {
+        let mut runs: Vec<(Dest, Vec<u8>)> = Vec::new();
+        for (dest, bytes) in written.lock().unwrap().iter() {
+            match runs.last_mut() {
+                Some((last, run)) if last == dest => run.extend_from_slice(bytes),
+                _ => runs.push((*dest, bytes.clone())),
+            }
+        }
+        runs
+    }
+
+    const LONG: Duration = Duration::from_secs(3600);
+
+    #[test]
+    fn keeps_stdout_and_stderr_in_order() {
+        let (buffer, out) = buffer(64, LONG);
+        let mut stdout = buffer.stdout().stream();
+        let mut stderr = buffer.stderr().stream();
+        stdout.write(Bytes::from_static(b"out 1\n")).unwrap();
+        stdout.write(Bytes::from_static(b"out 2\n")).unwrap();
+        stderr.write(Bytes::from_static(b"err 1\n")).unwrap();
+        stdout.write(Bytes::from_static(b"out 3\n")).unwrap();
+        buffer.flush().unwrap();
+        assert_eq!(
+            written(&out),
+            [
+                (Dest::Stdout, b"out 1\nout 2\n".to_vec()),
+                (Dest::Stderr, b"err 1\n".to_vec()),
+                (Dest::Stdout, b"out 3\n".to_vec()),
+            ]
+        );
+    }
+
+    #[test]
+    fn large_writes_bypass_the_buffer() {
+        let (buffer, out) = buffer(8, LONG);
+        let mut stdout = buffer.stdout().stream();
+        let mut stderr = buffer.stderr().stream();
+        stdout.write(Bytes::from_static(b"small")).unwrap();
+        // The buffered output is written out first to keep the order.
+        stderr.write(Bytes::from_static(b"larger than 8")).unwrap();
+        assert_eq!(
+            written(&out),
+            [
+                (Dest::Stdout, b"small".to_vec()),
+                (Dest::Stderr, b"larger than 8".to_vec()),
+            ]
+        );
+        assert!(buffer.0.state.lock().unwrap().data.is_empty());
+    }
+
+    #[test]
+    fn full_buffer_is_written_out() {
+        let (buffer, out) = buffer(8, LONG);
+        let mut stdout = buffer.stdout().stream();
+        stdout.write(Bytes::from_static(b"12345")).unwrap();
+        stdout.write(Bytes::from_static(b"6789")).unwrap();
+        assert_eq!(written(&out), [(Dest::Stdout, b"12345".to_vec())]);
+        buffer.flush().unwrap();
+        assert_eq!(written(&out), [(Dest::Stdout, b"123456789".to_vec())]);
+    }
+
+    #[test]
+    fn stream_flush_writes_out() {
+        let (buffer, out) = buffer(64, LONG);
+        let mut stderr = buffer.stderr().stream();
+        stderr.write(Bytes::from_static(b"no newline")).unwrap();
+        stderr.flush().unwrap();
+        assert_eq!(written(&out), [(Dest::Stderr, b"no newline".to_vec())]);
+    }
+
+    #[test]
+    fn written_out_after_max_delay() {
+        let (buffer, out) = buffer(64, Duration::from_millis(10));
+        let mut stdout = buffer.stdout().stream();
+        stdout.write(Bytes::from_static(b"later")).unwrap();
+        let start = Instant::now();
+        while written(&out).is_empty() {
+            assert!(start.elapsed() < Duration::from_secs(10), "never flushed");
+            std::thread::sleep(Duration::from_millis(1));
+        }
+        assert_eq!(written(&out), [(Dest::Stdout, b"later".to_vec())]);
+        drop(buffer);
+    }
+
+    #[test]
+    fn background_errors_are_reported() {
+        let output: Output = Box::new(|_, _| Err(io::Error::new(io::ErrorKind::Other, "closed")));
+        let buffer = StdioBuffer::with_output(64, Duration::from_millis(10), output);
+        let mut stdout = buffer.stdout().stream();
+        stdout.write(Bytes::from_static(b"lost")).unwrap();
+        let start = Instant::now();
+        while buffer.0.state.lock().unwrap().error.is_none() {
+            assert!(start.elapsed() < Duration::from_secs(10), "never flushed");
+            std::thread::sleep(Duration::from_millis(1));
+        }
+        assert!(stdout.write(Bytes::from_static(b"next")).is_err());
+    }
+
+    #[test]
+    fn flush_all_buffers() {
+        let (a, out_a) = buffer(64, LONG);
+        let (b, out_b) = buffer(64, LONG);
+        a.stdout().stream().write(Bytes::from_static(b"a")).unwrap();
+        b.stderr().stream().write(Bytes::from_static(b"b")).unwrap();
+        flush_stdio_buffers();
+        assert_eq!(written(&out_a), [(Dest::Stdout, b"a".to_vec())]);
+        assert_eq!(written(&out_b), [(Dest::Stderr, b"b".to_vec())]);
+    }
+}
@@ -112,10 +112,13 @@ pub struct Config {
     pub(crate) async_stack_size: usize,
     #[cfg(feature = "async")]
     pub(crate) stack_creator: Option<Arc<dyn RuntimeFiberStackCreator>>,
+    #[cfg(feature = "async")]
+    pub(crate) async_stack_cache: wasmtime_runtime::FiberStackCacheConfig,
     pub(crate) async_support: bool,
     pub(crate) module_version: ModuleVersionStrategy,
     pub(crate) parallel_compilation: bool,
     pub(crate) memory_init_cow: bool,
+    pub(crate) memory_reservation_cache_size: usize,
     pub(crate) memory_guaranteed_dense_image_size: u64,
     pub(crate) force_memory_init_memfd: bool,
     pub(crate) wmemcheck: bool,
@@ -208,10 +211,13 @@ impl Config {
             async_stack_size: 2 << 20,
             #[cfg(feature = "async")]
             stack_creator: None,
+            #[cfg(feature = "async")]
+            async_stack_cache: Default::default(),
             async_support: false,
             module_version: ModuleVersionStrategy::default(),
             parallel_compilation: !cfg!(miri),
             memory_init_cow: true,
+            memory_reservation_cache_size: 0,
             memory_guaranteed_dense_image_size: 16 << 20,
             force_memory_init_memfd: false,
             wmemcheck: false,
@@ -644,6 +650,68 @@ impl Config {
         self
     }
 
+    /// Configures how many unused async stacks are kept around for reuse by
+    /// the on-demand allocator.
+    ///
+    /// With the default [`InstanceAllocationStrategy::OnDemand`] strategy each
+    /// [`call_async`] maps a fresh stack of [`Config::async_stack_size`] bytes,
+    /// plus a guard page, and unmaps it when the call's future is dropped. In
+    /// workloads performing many short async calls these system calls can
+    /// dominate the cost of each call. When this option is nonzero up to `max`
+    /// stacks are instead kept per-[`Engine`](crate::Engine) once their futures
+    /// finish and are handed out again to later calls.
+    ///
+    /// Cached stacks keep whatever memory was touched by previous calls
+    /// committed. See [`Config::async_stack_cache_zeroing`] to reset them
+    /// between uses.
+    ///
+    /// This option has no effect with the pooling allocator, which always
+    /// reuses its stacks, or with a custom [`Config::with_host_stack`]
+    /// creator. Stacks are also never cached on Windows, where fibers manage
+    /// their own stacks.
+    ///
+    /// This option defaults to `0`.
+    ///
+    /// [`call_async`]: crate::TypedFunc::call_async
+    #[cfg(feature = "async")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "async")))]
+    pub fn async_stack_cache_size(&mut self, max: usize) -> &mut Self {
+        self.async_stack_cache.max_stacks = max;
+        self
+    }
+
+    /// Configures whether or not stacks kept by
+    /// [`Config::async_stack_cache_size`] are reset to zero before reuse.
+    ///
+    /// This mirrors [`PoolingAllocationConfig::async_stack_zeroing`] for the
+    /// on-demand allocator and is a defense-in-depth mechanism that isn't
+    /// required for correctness.
+    ///
+    /// This option defaults to `false`.
+    #[cfg(feature = "async")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "async")))]
+    pub fn async_stack_cache_zeroing(&mut self, enable: bool) -> &mut Self {
+        self.async_stack_cache.async_stack_zeroing = enable;
+        self
+    }
+
+    /// How much memory, in bytes, at the top of each cached async stack is
+    /// zeroed with `memset`, and kept resident, when
+    /// [`Config::async_stack_cache_zeroing`] is enabled.
+    ///
+    /// The rest of each stack is returned to the system with `madvise`, or an
+    /// equivalent, so that it reads as zero on next use. This mirrors
+    /// [`PoolingAllocationConfig::async_stack_keep_resident`].
+    ///
+    /// This option defaults to `0`.
+    #[cfg(feature = "async")]
+    #[cfg_attr(nightlydoc, doc(cfg(feature = "async")))]
+    pub fn async_stack_cache_keep_resident(&mut self, size: usize) -> &mut Self {
+        let size = round_up_to_pages(size as u64) as usize;
+        self.async_stack_cache.async_stack_keep_resident = size;
+        self
+    }
+
     /// Configures whether the WebAssembly tail calls proposal will be enabled
     /// for compilation or not.
     ///
@@ -1376,6 +1444,59 @@ impl Config {
         self
     }
 
+    /// Configures whether the space reserved for growth of a "dynamic" memory
+    /// scales with the size of the memory.
+    ///
+    /// When enabled, each time a dynamic memory must be relocated due to
+    /// growth the new reservation has room to grow into that's at least as
+    /// large as the memory's new size, in addition to
+    /// [`Config::dynamic_memory_reserved_for_growth`] (but never exceeding
+    /// the memory's maximum size). This means that a memory which repeatedly
+    /// grows is relocated a number of times that's logarithmic in its final
+    /// size, similar to how `Vec<T>` grows, at the cost of larger virtual
+    /// address space reservations.
+    ///
+    /// Note that on Linux relocation of a dynamic memory remaps the existing
+    /// pages into the new reservation rather than copying them where the
+    /// kernel supports it, so this primarily reduces the number of
+    /// relocations rather than their cost.
+    ///
+    /// ## Default
+    ///
+    /// This value defaults to `false`.
+    pub fn dynamic_memory_growth_geometric(&mut self, enable: bool) -> &mut Self {
+        self.tunables.dynamic_memory_growth_geometric = enable;
+        self
+    }
+
+    /// Configures how many address space reservations of dropped linear
+    /// memories are kept for reuse with the on-demand allocator.
+    ///
+    /// With the default [`InstanceAllocationStrategy::OnDemand`] strategy
+    /// each linear memory reserves its own virtual address space, which with
+    /// the default static memory settings on 64-bit platforms is several GiB
+    /// including guard regions, and unmaps it when the memory is dropped.
+    /// When instantiating at a high rate these mappings contend on
+    /// process-wide locks in the kernel and cause TLB shootdowns. When this
+    /// option is nonzero, up to `max` reservations are instead kept
+    /// per-[`Engine`](crate::Engine) with their contents discarded, and given
+    /// to new memories which need a reservation of the same size.
+    ///
+    /// This provides much of the benefit of the pooling allocator without
+    /// sizing a pool up front, but note that cached reservations continue to
+    /// occupy virtual address space.
+    ///
+    /// This option has no effect with the pooling allocator or with a custom
+    /// [`Config::with_host_memory`] creator.
+    ///
+    /// ## Default
+    ///
+    /// This value defaults to `0`.
+    pub fn memory_reservation_cache_size(&mut self, max: usize) -> &mut Self {
+        self.memory_reservation_cache_size = max;
+        self
+    }
+
     /// Indicates whether a guard region is present before allocations of
     /// linear memory.
     ///
@@ -1614,7 +1735,6 @@ impl Config {
 
         match &self.allocation_strategy {
             InstanceAllocationStrategy::OnDemand => {
-                #[allow(unused_mut)]
                 let mut allocator = Box::new(OnDemandInstanceAllocator::new(
                     self.mem_creator.clone(),
                     stack_size,
@@ -1623,6 +1743,9 @@ impl Config {
                 if let Some(stack_creator) = &self.stack_creator {
                     allocator.set_stack_creator(stack_creator.clone());
                 }
+                #[cfg(feature = "async")]
+                allocator.set_stack_cache(self.async_stack_cache);
+                allocator.set_memory_reservation_cache(self.memory_reservation_cache_size);
                 Ok(allocator)
             }
             #[cfg(feature = "pooling-allocator")]
@@ -1,4 +1,6 @@
-use std::{collections::HashMap, fmt};
+use std::{collections::HashMap, fmt, io, ops::Range};
+
+use wasm_encoder::{Encode, Section};
 
 use crate::{
     store::StoreOpaque, AsContextMut, FrameInfo, Global, Instance, Memory, Module, StoreContextMut,
@@ -94,26 +96,79 @@ impl WasmCoreDump {
     /// network, or pass it to other debugging tools that consume Wasm core
     /// dumps.
     ///
+    /// This builds the whole core dump in memory; prefer
+    /// [`WasmCoreDump::serialize_to`] for stores with large linear memories.
+    ///
+    /// [spec]: https://github.com/WebAssembly/tool-conventions/blob/main/Coredump.md
+    pub fn serialize(&self, store: impl AsContextMut, name: &str) -> Vec<u8> {
+        let mut bytes = Vec::new();
+        self.serialize_to(store, name, &mut bytes)
+            .expect("writing a core dump to a `Vec<u8>` should not fail");
+        bytes
+    }
+
+    /// Serialize this core dump into [the standard core dump binary
+    /// format][spec], streaming it to `writer`.
+    ///
+    /// Unlike [`WasmCoreDump::serialize`] the contents of linear memories are
+    /// written directly from the store rather than copied into an
+    /// intermediate buffer, and pages which are entirely zero are omitted, so
+    /// the dump is written as a sparse set of data segments. The extra memory
+    /// needed is proportional to the number of data segments, not to the size
+    /// of linear memory.
+    ///
+    /// The store is only read from, so the core dump and its store may be
+    /// moved to a background thread after the trap to write the dump there,
+    /// as long as nothing else uses the store in the meantime. Wrapping
+    /// `writer` in a [`std::io::BufWriter`] is recommended when writing to a
+    /// file or socket.
+    ///
+    /// # Errors
+    ///
+    /// Returns any error from `writer`, or an error if the data of the
+    /// memories is too large to encode in a single wasm data section.
+    ///
     /// [spec]: https://github.com/WebAssembly/tool-conventions/blob/main/Coredump.md
-    pub fn serialize(&self, mut store: impl AsContextMut, name: &str) -> Vec<u8> {
+    pub fn serialize_to(
+        &self,
+        mut store: impl AsContextMut,
+        name: &str,
+        mut writer: impl io::Write,
+    ) -> io::Result<()> {
         let store = store.as_context_mut();
-        self._serialize(store, name)
+        self._serialize_to(store, name, &mut writer)
     }
 
-    fn _serialize<T>(&self, mut store: StoreContextMut<'_, T>, name: &str) -> Vec<u8> {
-        let mut core_dump = wasm_encoder::Module::new();
+    fn _serialize_to<T>(
+        &self,
+        mut store: StoreContextMut<'_, T>,
+        name: &str,
+        writer: &mut dyn io::Write,
+    ) -> io::Result<()> {
+        // The wasm magic number and version.
+        writer.write_all(b"\0asm\x01\0\0\0")?;
+
+        write_section(writer, &wasm_encoder::CoreDumpSection::new(name))?;
 
-        core_dump.section(&wasm_encoder::CoreDumpSection::new(name));
+        let too_large = || {
+            io::Error::new(
+                io::ErrorKind::InvalidData,
+                "core dump data section is too large to encode",
+            )
+        };
 
         // A map from each memory to its index in the core dump's memories
         // section.
         let mut memory_to_idx = HashMap::new();
 
-        let mut data = wasm_encoder::DataSection::new();
+        // The data segments to emit for each memory, recorded as the encoded
+        // segment header and the range of the memory it covers. The memory
+        // contents themselves are only read when the data section is written.
+        let mut segments: Vec<(Vec<u8>, usize, Range<usize>)> = Vec::new();
 
         {
             let mut memories = wasm_encoder::MemorySection::new();
-            for mem in self.memories() {
+            for (i, mem) in self.memories().iter().enumerate() {
                 let memory_idx = memories.len();
                 memory_to_idx.insert(mem.hash_key(&store.0), memory_idx);
                 let ty = mem.ty(&store);
@@ -124,31 +179,27 @@ impl WasmCoreDump {
                     shared: ty.is_shared(),
                 });
 
-                // Attach the memory data, balancing number of data segments and
-                // binary size. We don't want to attach the whole memory in one
-                // big segment, since it likely contains a bunch of large runs
-                // of zeroes. But we can't encode the data without any potential
-                // runs of zeroes (i.e. including only non-zero data in our
-                // segments) because we can run up against the implementation
-                // limits for number of segments in a Wasm module this way. So
-                // to balance these conflicting desires, we break the memory up
-                // into reasonably-sized chunks and then trim runs of zeroes
-                // from the start and end of each chunk.
-                const CHUNK_SIZE: u32 = 4096;
-                for (i, chunk) in mem
-                    .data(&store)
-                    .chunks_exact(CHUNK_SIZE as usize)
-                    .enumerate()
-                {
-                    if let Some(start) = chunk.iter().position(|byte| *byte != 0) {
-                        let end = chunk.iter().rposition(|byte| *byte != 0).unwrap() + 1;
-                        let offset = (i as u32) * CHUNK_SIZE + (start as u32);
-                        let offset = wasm_encoder::ConstExpr::i32_const(offset as i32);
-                        data.active(memory_idx, &offset, chunk[start..end].iter().copied());
+                for range in sparse_ranges(mem.data(&store)) {
+                    let mut header = Vec::new();
+                    if memory_idx == 0 {
+                        header.push(0x00);
+                    } else {
+                        header.push(0x02);
+                        memory_idx.encode(&mut header);
                     }
+                    let offset = if ty.is_64() {
+                        wasm_encoder::ConstExpr::i64_const(range.start as i64)
+                    } else {
+                        wasm_encoder::ConstExpr::i32_const(range.start as i32)
+                    };
+                    offset.encode(&mut header);
+                    u32::try_from(range.len())
+                        .map_err(|_| too_large())?
+                        .encode(&mut header);
+                    segments.push((header, i, range));
                 }
             }
-            core_dump.section(&memories);
+            write_section(writer, &memories)?;
         }
 
         // A map from each global to its index in the core dump's globals
@@ -189,11 +240,34 @@ impl WasmCoreDump {
                 };
                 globals.global(wasm_encoder::GlobalType { val_type, mutable }, &init);
             }
-            core_dump.section(&globals);
+            write_section(writer, &globals)?;
         }
 
-        core_dump.section(&data);
-        drop(data);
+        // The data section is written by hand so that memory contents go
+        // straight from linear memory to `writer`. This means that the size
+        // of the section needs to be computed up front from the segments.
+        {
+            let mut count = Vec::new();
+            u32::try_from(segments.len())
+                .map_err(|_| too_large())?
+                .encode(&mut count);
+            let size = segments
+                .iter()
+                .fold(count.len() as u64, |size, (header, _, range)| {
+                    size + header.len() as u64 + range.len() as u64
+                });
+            let mut section = vec![wasm_encoder::SectionId::Data as u8];
+            u32::try_from(size)
+                .map_err(|_| too_large())?
+                .encode(&mut section);
+            section.extend_from_slice(&count);
+            writer.write_all(&section)?;
+
+            for (header, i, range) in segments {
+                writer.write_all(&header)?;
+                writer.write_all(&self.memories[i].data(&store)[range])?;
+            }
+        }
 
         // A map from module id to its index within the core dump's modules
         // section.
@@ -208,7 +282,7 @@ impl WasmCoreDump {
                     None => modules.module(&format!("<anonymous-module-{}>", modules.len())),
                 };
             }
-            core_dump.section(&modules);
+            write_section(writer, &modules)?;
         }
 
         // TODO: We can't currently recover instances from stack frames. We can
@@ -243,7 +317,7 @@ impl WasmCoreDump {
 
                 instances.instance(module_index, memories, globals);
             }
-            core_dump.section(&instances);
+            write_section(writer, &instances)?;
         }
 
         {
@@ -269,11 +343,42 @@ impl WasmCoreDump {
 
                 stack.frame(instance, func, offset, locals, operand_stack);
             }
-            core_dump.section(&stack);
+            write_section(writer, &stack)?;
         }
 
-        core_dump.finish()
+        writer.flush()
+    }
+}
+
+fn write_section(writer: &mut dyn io::Write, section: &impl Section) -> io::Result<()> {
+    let mut bytes = vec![section.id()];
+    section.encode(&mut bytes);
+    writer.write_all(&bytes)
+}
+
+/// Splits `data` into the ranges which should be emitted as data segments.
+///
+/// Memory is scanned in page-sized chunks. Chunks which are entirely zero are
+/// skipped, adjacent non-zero chunks are merged into a single segment, and
+/// runs of zeroes are trimmed from the start and end of each segment. Merging
+/// keeps the number of segments, which implementations limit, proportional to
+/// the number of distinct non-zero regions rather than to the number of
+/// non-zero pages.
+fn sparse_ranges(data: &[u8]) -> Vec<Range<usize>> {
+    const CHUNK_SIZE: usize = 4096;
+    let mut ranges: Vec<Range<usize>> = Vec::new();
+    for (i, chunk) in data.chunks(CHUNK_SIZE).enumerate() {
+        let start = match chunk.iter().position(|byte| *byte != 0) {
+            Some(start) => i * CHUNK_SIZE + start,
+            None => continue,
+        };
+        let end = i * CHUNK_SIZE + chunk.iter().rposition(|byte| *byte != 0).unwrap() + 1;
+        match ranges.last_mut() {
+            Some(prev) if (prev.end - 1) / CHUNK_SIZE + 1 == i => prev.end = end,
+            _ => ranges.push(start..end),
+        }
     }
+    ranges
 }
 
 impl fmt::Display for WasmCoreDump {
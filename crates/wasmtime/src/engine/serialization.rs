@@ -351,6 +351,7 @@ impl Metadata<'_> {
 
             // This doesn't affect compilation, it's just a runtime setting.
             dynamic_memory_growth_reserve: _,
+            dynamic_memory_growth_geometric: _,
 
             // This does technically affect compilation but modules with/without
             // trap information can be loaded into engines with the opposite
@@ -1,7 +1,7 @@
 use crate::store::{StoreData, StoreOpaque, Stored};
 use crate::{
-    AsContext, AsContextMut, CallHook, Engine, Extern, FuncType, Instance, Module, StoreContext,
-    StoreContextMut, Val, ValRaw, ValType,
+    AsContext, AsContextMut, CallHook, Engine, Extern, FuncType, Instance, Module, ModuleExport,
+    StoreContext, StoreContextMut, Val, ValRaw, ValType,
 };
 use anyhow::{bail, Context as _, Error, Result};
 use std::ffi::c_void;
@@ -1370,7 +1370,7 @@ pub(crate) fn invoke_wasm_and_catch_traps<T>(
         }
         let result = wasmtime_runtime::catch_traps(
             store.0.signal_handler(),
-            store.0.engine().config().wasm_backtrace,
+            store.0.wasm_backtrace(),
             store.0.engine().config().coredump_on_trap,
             store.0.default_caller(),
             closure,
@@ -1832,6 +1832,23 @@ impl<T> Caller<'_, T> {
             .get_export(&mut self.store, name)
     }
 
+    /// Looks up an export from the caller's module previously found with
+    /// [`Module::get_export_index`](crate::Module::get_export_index).
+    ///
+    /// This is the same as [`Caller::get_export`] except that it avoids
+    /// looking up the export by name, which makes it suitable for host
+    /// functions that look up the same export, such as the caller's memory, on
+    /// every call.
+    ///
+    /// Returns `None` if there's no caller instance or if `export` was looked
+    /// up in a different module than the caller's.
+    pub fn get_module_export(&mut self, export: &ModuleExport) -> Option<Extern> {
+        self.caller
+            .host_state()
+            .downcast_ref::<Instance>()?
+            .get_module_export(&mut self.store, export)
+    }
+
     /// Access the underlying data owned by this `Store`.
     ///
     /// Same as [`Store::data`](crate::Store::data)
@@ -2,14 +2,16 @@ use crate::linker::{Definition, DefinitionType};
 use crate::store::{InstanceId, StoreOpaque, Stored};
 use crate::types::matching;
 use crate::{
-    AsContextMut, Engine, Export, Extern, Func, Global, Memory, Module, SharedMemory, StoreContext,
-    StoreContextMut, Table, TypedFunc,
+    AsContextMut, Engine, Export, Extern, Func, Global, Memory, Module, ModuleExport, SharedMemory,
+    StoreContext, StoreContextMut, Table, TypedFunc,
 };
 use anyhow::{anyhow, bail, Context, Result};
 use std::mem;
 use std::ptr::NonNull;
 use std::sync::Arc;
-use wasmtime_environ::{EntityType, FuncIndex, GlobalIndex, MemoryIndex, PrimaryMap, TableIndex};
+use wasmtime_environ::{
+    EntityIndex, EntityType, FuncIndex, GlobalIndex, MemoryIndex, PrimaryMap, TableIndex,
+};
 use wasmtime_runtime::{
     Imports, InstanceAllocationRequest, StorePtr, VMContext, VMFuncRef, VMFunctionImport,
     VMGlobalImport, VMMemoryImport, VMNativeCallFunction, VMOpaqueContext, VMTableImport,
@@ -431,14 +433,54 @@ impl Instance {
     }
 
     fn _get_export(&self, store: &mut StoreOpaque, name: &str) -> Option<Extern> {
-        // Instantiated instances will lazily fill in exports, so we process
-        // all that lazy logic here.
         let data = &store[self.0];
-
         let instance = store.instance(data.id);
         let (i, _, &index) = instance.module().exports.get_full(name)?;
+        Some(self._get_export_by_index(store, i, index))
+    }
+
+    /// Looks up an export previously found with
+    /// [`Module::get_export_index`].
+    ///
+    /// This is a faster alternative to [`Instance::get_export`] for exports
+    /// which are accessed repeatedly, as it avoids looking up the export by
+    /// name.
+    ///
+    /// Returns `None` if `export` was looked up in a different module than the
+    /// one this is an instance of.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `store` does not own this instance.
+    pub fn get_module_export(
+        &self,
+        mut store: impl AsContextMut,
+        export: &ModuleExport,
+    ) -> Option<Extern> {
+        self._get_module_export(store.as_context_mut().0, export)
+    }
+
+    fn _get_module_export(&self, store: &mut StoreOpaque, export: &ModuleExport) -> Option<Extern> {
+        let data = &store[self.0];
+        if !Engine::same(store.engine(), &export.engine)
+            || store.instance(data.id).module_id() != Some(export.module)
+        {
+            return None;
+        }
+        Some(self._get_export_by_index(store, export.index, export.entity))
+    }
+
+    fn _get_export_by_index(
+        &self,
+        store: &mut StoreOpaque,
+        i: usize,
+        index: EntityIndex,
+    ) -> Extern {
+        // Instantiated instances will lazily fill in exports, so we process
+        // all that lazy logic here.
+        let data = &store[self.0];
         if let Some(export) = &data.exports[i] {
-            return Some(export.clone());
+            return export.clone();
         }
 
         let id = data.id;
@@ -447,7 +489,7 @@ impl Instance {
             unsafe { Extern::from_wasmtime_export(instance.get_export_by_index(index), store) };
         let data = &mut store[self.0];
         data.exports[i] = Some(item.clone());
-        Some(item)
+        item
     }
 
     /// Looks up an exported [`Func`] value by name.
@@ -513,6 +513,9 @@ impl Memory {
                 Some(size) => {
                     let vm = (*mem).vmmemory();
                     *store[self.0].definition = vm;
+                    if delta > 0 {
+                        wasmtime_runtime::Store::memory_grown(store);
+                    }
                     Ok(u64::try_from(size).unwrap() / u64::from(wasmtime_environ::WASM_PAGE_SIZE))
                 }
                 None => bail!("failed to grow memory by `{}`", delta),
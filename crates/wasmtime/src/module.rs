@@ -15,8 +15,8 @@ use std::ptr::NonNull;
 use std::sync::Arc;
 use wasmparser::{Parser, ValidPayload, Validator};
 use wasmtime_environ::{
-    DefinedFuncIndex, DefinedMemoryIndex, HostPtr, ModuleEnvironment, ModuleTypes, ObjectKind,
-    VMOffsets,
+    DefinedFuncIndex, DefinedMemoryIndex, EntityIndex, HostPtr, ModuleEnvironment, ModuleTypes,
+    ObjectKind, VMOffsets,
 };
 use wasmtime_jit::{CodeMemory, CompiledModule, CompiledModuleInfo};
 use wasmtime_runtime::{
@@ -27,7 +27,8 @@ use wasmtime_runtime::{
 mod registry;
 
 pub use registry::{
-    is_wasm_trap_pc, register_code, unregister_code, ModuleRegistry, RegisteredModuleId,
+    is_wasm_trap_pc, register_code, unregister_code, ModuleRegistry, RegisteredCode,
+    RegisteredModuleId,
 };
 
 /// A compiled WebAssembly module, ready to be instantiated.
@@ -895,6 +896,27 @@ impl Module {
         ))
     }
 
+    /// Looks up the export named `name` ahead of time, returning a handle
+    /// which can be used to cheaply get that export from instances of this
+    /// module.
+    ///
+    /// The returned [`ModuleExport`] can be passed to
+    /// [`Instance::get_module_export`](crate::Instance::get_module_export)
+    /// and [`Caller::get_module_export`](crate::Caller::get_module_export),
+    /// which avoid the by-name lookup done by `get_export`.
+    ///
+    /// Returns `None` if this module has no export named `name`.
+    pub fn get_export_index(&self, name: &str) -> Option<ModuleExport> {
+        let module = self.compiled_module().module();
+        let (index, _, &entity) = module.exports.get_full(name)?;
+        Some(ModuleExport {
+            engine: self.engine().clone(),
+            module: self.id(),
+            index,
+            entity,
+        })
+    }
+
     /// Returns the [`Engine`] that this [`Module`] was compiled by.
     pub fn engine(&self) -> &Engine {
         &self.inner.engine
@@ -1093,6 +1115,21 @@ impl Module {
     }
 }
 
+/// An export of a [`Module`] which has been looked up ahead of time with
+/// [`Module::get_export_index`].
+#[derive(Clone, Debug)]
+pub struct ModuleExport {
+    /// The engine of the module this export was looked up in, as module ids
+    /// are only unique within an engine.
+    pub(crate) engine: Engine,
+    /// The module this export was looked up in.
+    pub(crate) module: CompiledModuleId,
+    /// The position of the export in the module's list of exports.
+    pub(crate) index: usize,
+    /// The item which is exported.
+    pub(crate) entity: EntityIndex,
+}
+
 impl ModuleInner {
     fn memory_images(&self) -> Result<Option<&ModuleMemoryImages>> {
         let images = self
@@ -3,11 +3,12 @@
 use crate::code::CodeObject;
 #[cfg(feature = "component-model")]
 use crate::component::Component;
-use crate::{FrameInfo, Module, Trap};
+use crate::{Module, Trap};
 use once_cell::sync::Lazy;
 use std::collections::btree_map::Entry;
 use std::{
     collections::BTreeMap,
+    fmt,
     ptr::NonNull,
     sync::{Arc, RwLock},
 };
@@ -24,16 +25,22 @@ use wasmtime_runtime::{ModuleInfo, VMSharedSignatureIndex, VMWasmCallFunction};
 /// currently small enough to not worry much about.
 #[derive(Default)]
 pub struct ModuleRegistry {
-    // Keyed by the end address of a `CodeObject`.
-    //
-    // The value here is the start address and the information about what's
-    // loaded at that address.
-    loaded_code: BTreeMap<usize, (usize, LoadedCode)>,
+    loaded_code: RegisteredCode,
 
     // Preserved for keeping data segments alive or similar
     modules_without_code: Vec<Module>,
 }
 
+/// The code registered with a `ModuleRegistry`, which is cheap to clone so
+/// that values outliving the store, such as backtraces, can keep it alive and
+/// look up program counters later on.
+///
+/// The map is keyed by the end address of a `CodeObject`, and the value is the
+/// start address and the information about what's loaded at that address.
+#[derive(Clone, Default)]
+pub struct RegisteredCode(Arc<BTreeMap<usize, (usize, LoadedCode)>>);
+
+#[derive(Clone)]
 struct LoadedCode {
     /// Representation of loaded code which could be either a component or a
     /// module.
@@ -74,21 +81,22 @@ impl ModuleRegistry {
     }
 
     fn code(&self, pc: usize) -> Option<(&LoadedCode, usize)> {
-        let (end, (start, code)) = self.loaded_code.range(pc..).next()?;
-        if pc < *start || *end < pc {
-            return None;
-        }
-        Some((code, pc - *start))
+        self.loaded_code.code(pc)
     }
 
     fn module_and_offset(&self, pc: usize) -> Option<(&Module, usize)> {
-        let (code, offset) = self.code(pc)?;
-        Some((code.module(pc)?, offset))
+        self.loaded_code.module_and_offset(pc)
+    }
+
+    /// Returns the code currently registered, which keeps that code alive.
+    pub(crate) fn registered_code(&self) -> RegisteredCode {
+        self.loaded_code.clone()
     }
 
     /// Gets an iterator over all modules in the registry.
     pub fn all_modules(&self) -> impl Iterator<Item = &'_ Module> + '_ {
         self.loaded_code
+            .0
             .values()
             .flat_map(|(_, code)| code.modules.values())
             .chain(self.modules_without_code.iter())
@@ -135,21 +143,31 @@ impl ModuleRegistry {
         // If this module is already present in the registry then that means
         // it's either an overlapping image, for example for two modules
         // found within a component, or it's a second instantiation of the same
-        // module. Delegate to `push_module` to find out.
-        if let Some((other_start, prev)) = self.loaded_code.get_mut(&end_addr) {
+        // module. Only the former changes anything.
+        //
+        // Backtraces may share the map, in which case `Arc::make_mut` copies
+        // it, so it's only called when something is actually added. Every
+        // instantiation comes through here, and nothing is added for all but
+        // the first instantiation of a module.
+        if let Some((other_start, prev)) = self.loaded_code.0.get(&end_addr) {
             assert_eq!(*other_start, start_addr);
             if let Some(module) = module {
-                prev.push_module(module);
+                if !prev.contains_module(module) {
+                    let loaded_code = Arc::make_mut(&mut self.loaded_code.0);
+                    let (_, prev) = loaded_code.get_mut(&end_addr).unwrap();
+                    prev.push_module(module);
+                }
             }
             return id;
         }
 
         // Assert that this module's code doesn't collide with any other
         // registered modules
-        if let Some((_, (prev_start, _))) = self.loaded_code.range(start_addr..).next() {
+        let loaded_code = Arc::make_mut(&mut self.loaded_code.0);
+        if let Some((_, (prev_start, _))) = loaded_code.range(start_addr..).next() {
             assert!(*prev_start > end_addr);
         }
-        if let Some((prev_end, _)) = self.loaded_code.range(..=start_addr).next_back() {
+        if let Some((prev_end, _)) = loaded_code.range(..=start_addr).next_back() {
             assert!(*prev_end < start_addr);
         }
 
@@ -160,7 +178,7 @@ impl ModuleRegistry {
         if let Some(module) = module {
             item.push_module(module);
         }
-        let prev = self.loaded_code.insert(end_addr, (start_addr, item));
+        let prev = loaded_code.insert(end_addr, (start_addr, item));
         assert!(prev.is_none());
         id
     }
@@ -179,9 +197,10 @@ impl ModuleRegistry {
     /// debug information due to the compiler's configuration. The second
     /// boolean indicates whether the engine used to compile this module is
     /// using environment variables to control debuginfo parsing.
-    pub(crate) fn lookup_frame_info(&self, pc: usize) -> Option<(FrameInfo, &Module)> {
+    #[cfg(test)]
+    pub(crate) fn lookup_frame_info(&self, pc: usize) -> Option<(crate::FrameInfo, &Module)> {
         let (module, offset) = self.module_and_offset(pc)?;
-        let info = FrameInfo::new(module.clone(), offset)?;
+        let info = crate::FrameInfo::new(module.clone(), offset)?;
         Some((info, module))
     }
 
@@ -196,7 +215,7 @@ impl ModuleRegistry {
         // `VMSharedSignatureIndex` to `SignatureIndex` map.
         //
         // See also the comment in `ModuleInner::wasm_to_native_trampoline`.
-        for (_, code) in self.loaded_code.values() {
+        for (_, code) in self.loaded_code.0.values() {
             for module in code.modules.values() {
                 if let Some(trampoline) = module.runtime_info().wasm_to_native_trampoline(sig) {
                     return Some(trampoline);
@@ -207,17 +226,54 @@ impl ModuleRegistry {
     }
 }
 
+impl RegisteredCode {
+    fn code(&self, pc: usize) -> Option<(&LoadedCode, usize)> {
+        let (end, (start, code)) = self.0.range(pc..).next()?;
+        if pc < *start || *end < pc {
+            return None;
+        }
+        Some((code, pc - *start))
+    }
+
+    /// Fetches the registered module containing `pc` and the offset of `pc`
+    /// within that module's text section.
+    pub(crate) fn module_and_offset(&self, pc: usize) -> Option<(&Module, usize)> {
+        let (code, offset) = self.code(pc)?;
+        Some((code.module(pc)?, offset))
+    }
+}
+
+impl fmt::Debug for RegisteredCode {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("RegisteredCode").finish_non_exhaustive()
+    }
+}
+
 impl LoadedCode {
+    /// Returns the key of `module` in `self.modules`, which is the address of
+    /// its first function.
+    fn module_start(module: &Module) -> Option<usize> {
+        let (_, func) = module.compiled_module().finished_functions().next()?;
+        Some(func.as_ptr() as usize)
+    }
+
+    /// Returns whether `push_module` would leave `self.modules` as it is.
+    fn contains_module(&self, module: &Module) -> bool {
+        match Self::module_start(module) {
+            Some(start) => self.modules.contains_key(&start),
+            None => true,
+        }
+    }
+
     fn push_module(&mut self, module: &Module) {
-        let func = match module.compiled_module().finished_functions().next() {
-            Some((_, func)) => func,
+        let start = match Self::module_start(module) {
+            Some(start) => start,
             // There are no compiled functions in this module so there's no
             // need to push onto `self.modules` which is only used for frame
             // information lookup for a trap which only symbolicates defined
             // functions.
             None => return,
         };
-        let start = func.as_ptr() as usize;
 
         match self.modules.entry(start) {
             // This module is already present, and it should be the same as
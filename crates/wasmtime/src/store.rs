@@ -205,6 +205,7 @@ pub struct StoreInner<T> {
 
     limiter: Option<ResourceLimiterInner<T>>,
     call_hook: Option<CallHookInner<T>>,
+    memory_grow_hook: Option<Box<dyn FnMut(&mut T) + Send + Sync>>,
     epoch_deadline_behavior:
         Option<Box<dyn FnMut(StoreContextMut<T>) -> Result<UpdateDeadline> + Send + Sync>>,
     // for comments about `ManuallyDrop`, see `Store::into_data`
@@ -314,6 +315,9 @@ pub struct StoreOpaque {
     // until the reserve is empty.
     fuel_reserve: u64,
     fuel_yield_interval: Option<NonZeroU64>,
+    // Whether backtraces are captured when wasm traps, which defaults to
+    // `Config::wasm_backtrace`.
+    wasm_backtrace: bool,
     /// Indexed data within this `Store`, used to store information about
     /// globals, functions, memories, etc.
     ///
@@ -498,6 +502,7 @@ impl<T> Store<T> {
                 },
                 fuel_reserve: 0,
                 fuel_yield_interval: None,
+                wasm_backtrace: engine.config().wasm_backtrace,
                 store_data: ManuallyDrop::new(StoreData::new()),
                 default_caller: InstanceHandle::null(),
                 hostcall_val_storage: Vec::new(),
@@ -511,6 +516,7 @@ impl<T> Store<T> {
             },
             limiter: None,
             call_hook: None,
+            memory_grow_hook: None,
             epoch_deadline_behavior: None,
             data: ManuallyDrop::new(data),
         });
@@ -766,6 +772,25 @@ impl<T> Store<T> {
         self.inner.call_hook = Some(CallHookInner::Sync(Box::new(hook)));
     }
 
+    /// Configure a function that runs whenever a linear memory owned by this
+    /// store has successfully grown by a nonzero number of pages.
+    ///
+    /// Growth of a memory may move its base pointer in addition to changing
+    /// its length, so embedders which cache the result of
+    /// [`Memory::data_ptr`](crate::Memory::data_ptr) and
+    /// [`Memory::data_size`](crate::Memory::data_size) across host calls can
+    /// use this hook to invalidate those caches rather than re-querying the
+    /// memory on every call. The hook runs after the memory's new base and
+    /// length are visible, both for `memory.grow` executed by WebAssembly and
+    /// for [`Memory::grow`](crate::Memory::grow) called by the host.
+    ///
+    /// Note that this hook does not run for growth of
+    /// [`SharedMemory`](crate::SharedMemory), whose base pointer never
+    /// changes.
+    pub fn memory_grow_hook(&mut self, hook: impl FnMut(&mut T) + Send + Sync + 'static) {
+        self.inner.memory_grow_hook = Some(Box::new(hook));
+    }
+
     /// Returns the [`Engine`] that this store is associated with.
     pub fn engine(&self) -> &Engine {
         self.inner.engine()
@@ -780,6 +805,18 @@ impl<T> Store<T> {
         self.inner.gc()
     }
 
+    /// Configures whether a [`WasmBacktrace`](crate::WasmBacktrace) is
+    /// captured when WebAssembly in this [`Store`] traps.
+    ///
+    /// This overrides the engine-wide
+    /// [`Config::wasm_backtrace`](crate::Config::wasm_backtrace) setting for
+    /// this store only. Disabling backtraces avoids walking the stack on each
+    /// trap, which can be worthwhile for guests which use traps to signal
+    /// routine failures and whose embedder only inspects the trap code.
+    pub fn set_wasm_backtrace(&mut self, enable: bool) {
+        self.inner.set_wasm_backtrace(enable)
+    }
+
     /// Returns the amount fuel in this [`Store`]. When fuel is enabled, it must
     /// be configured via [`Store::set_fuel`].
     ///
@@ -1022,6 +1059,13 @@ impl<'a, T> StoreContextMut<'a, T> {
         self.0.gc()
     }
 
+    /// Configures whether backtraces are captured when wasm traps.
+    ///
+    /// For more information see [`Store::set_wasm_backtrace`].
+    pub fn set_wasm_backtrace(&mut self, enable: bool) {
+        self.0.set_wasm_backtrace(enable)
+    }
+
     /// Returns remaining fuel in this store.
     ///
     /// For more information see [`Store::get_fuel`]
@@ -1484,6 +1528,15 @@ impl StoreOpaque {
         }
     }
 
+    #[inline]
+    pub fn wasm_backtrace(&self) -> bool {
+        self.wasm_backtrace
+    }
+
+    pub fn set_wasm_backtrace(&mut self, enable: bool) {
+        self.wasm_backtrace = enable;
+    }
+
     #[inline]
     pub fn signal_handler(&self) -> Option<*const SignalHandler<'static>> {
         let handler = self.signal_handler.as_ref()?;
@@ -1691,7 +1744,7 @@ impl<T> StoreContextMut<'_, T> {
             // wrap that in a custom future implementation which does the
             // translation from the future protocol to our fiber API.
             FiberFuture {
-                fiber,
+                fiber: Some(fiber),
                 current_poll_cx,
                 engine,
                 state: Some(wasmtime_runtime::AsyncWasmCallState::new()),
@@ -1702,7 +1755,7 @@ impl<T> StoreContextMut<'_, T> {
         return Ok(slot.unwrap());
 
         struct FiberFuture<'a> {
-            fiber: wasmtime_fiber::Fiber<'a, Result<()>, (), Result<()>>,
+            fiber: Option<wasmtime_fiber::Fiber<'a, Result<()>, (), Result<()>>>,
             current_poll_cx: *mut *mut Context<'static>,
             engine: Engine,
             // See comments in `FiberFuture::resume` for this
@@ -1772,7 +1825,11 @@ impl<T> StoreContextMut<'_, T> {
         // correct. That's what `unsafe` in Rust is all about, though, right?
         unsafe impl Send for FiberFuture<'_> {}
 
-        impl FiberFuture<'_> {
+        impl<'a> FiberFuture<'a> {
+            fn fiber(&self) -> &wasmtime_fiber::Fiber<'a, Result<()>, (), Result<()>> {
+                self.fiber.as_ref().unwrap()
+            }
+
             /// This is a helper function to call `resume` on the underlying
             /// fiber while correctly managing Wasmtime's thread-local data.
             ///
@@ -1798,7 +1855,7 @@ impl<T> StoreContextMut<'_, T> {
                         fiber: self,
                         state: Some(prev),
                     };
-                    return restore.fiber.fiber.resume(val);
+                    return restore.fiber.fiber().resume(val);
                 }
 
                 struct Restore<'a, 'b> {
@@ -1865,7 +1922,7 @@ impl<T> StoreContextMut<'_, T> {
                         // then that's a bug indicating that TLS management in
                         // Wasmtime is incorrect.
                         Err(()) => {
-                            if let Some(range) = self.fiber.stack().range() {
+                            if let Some(range) = self.fiber().stack().range() {
                                 wasmtime_runtime::AsyncWasmCallState::assert_current_state_not_in_range(range);
                             }
                             Poll::Pending
@@ -1892,7 +1949,7 @@ impl<T> StoreContextMut<'_, T> {
         // completion.
         impl Drop for FiberFuture<'_> {
             fn drop(&mut self) {
-                if !self.fiber.done() {
+                if !self.fiber().done() {
                     let result = self.resume(Err(anyhow!("future dropped")));
                     // This resumption with an error should always complete the
                     // fiber. While it's technically possible for host code to catch
@@ -1903,10 +1960,11 @@ impl<T> StoreContextMut<'_, T> {
 
                 self.state.take().unwrap().assert_null();
 
+                // Hand the stack back to the allocator, which may reuse it for
+                // the next fiber.
+                let stack = self.fiber.take().unwrap().into_stack();
                 unsafe {
-                    self.engine
-                        .allocator()
-                        .deallocate_fiber_stack(self.fiber.stack());
+                    self.engine.allocator().deallocate_fiber_stack(stack);
                 }
             }
         }
@@ -2042,6 +2100,12 @@ unsafe impl<T> wasmtime_runtime::Store for StoreInner<T> {
         }
     }
 
+    fn memory_grown(&mut self) {
+        if let Some(hook) = &mut self.memory_grow_hook {
+            hook(&mut self.data);
+        }
+    }
+
     fn table_growing(
         &mut self,
         current: u32,
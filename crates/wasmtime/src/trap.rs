@@ -1,8 +1,10 @@
 #[cfg(feature = "coredump")]
 use crate::coredump::WasmCoreDump;
+use crate::module::RegisteredCode;
 use crate::store::StoreOpaque;
 use crate::{AsContext, Module};
 use anyhow::Error;
+use once_cell::sync::OnceCell;
 use std::fmt;
 use wasmtime_environ::{EntityRef, FilePos};
 use wasmtime_jit::{demangle_function_name, demangle_function_name_or_index};
@@ -104,9 +106,7 @@ pub(crate) fn from_runtime_box(
             error,
             needs_backtrace,
         } => {
-            debug_assert!(
-                needs_backtrace == backtrace.is_some() || !store.engine().config().wasm_backtrace
-            );
+            debug_assert!(needs_backtrace == backtrace.is_some() || !store.wasm_backtrace());
             (error, None)
         }
         wasmtime_runtime::TrapReason::Jit { pc, faulting_addr } => {
@@ -130,7 +130,7 @@ pub(crate) fn from_runtime_box(
 
     if let Some(bt) = backtrace {
         let bt = WasmBacktrace::from_captured(store, bt, pc);
-        if !bt.wasm_trace.is_empty() {
+        if !bt.is_empty() {
             error = error.context(bt);
         }
     }
@@ -157,7 +157,12 @@ pub(crate) fn from_runtime_box(
 /// the error when the error is logged.
 ///
 /// Capturing of wasm backtraces can be configured through the
-/// [`Config::wasm_backtrace`](crate::Config::wasm_backtrace) method.
+/// [`Config::wasm_backtrace`](crate::Config::wasm_backtrace) method, or per
+/// store with [`Store::set_wasm_backtrace`](crate::Store::set_wasm_backtrace).
+/// When a backtrace is captured only the raw frames are recorded; the modules
+/// they belong to, function names and source locations are looked up the
+/// first time [`WasmBacktrace::frames`] is called, or the backtrace is
+/// displayed.
 ///
 /// For more information about errors in wasmtime see the documentation of the
 /// [`Trap`] type.
@@ -197,11 +202,12 @@ pub(crate) fn from_runtime_box(
 /// ```
 #[derive(Debug)]
 pub struct WasmBacktrace {
-    wasm_trace: Vec<FrameInfo>,
-    hint_wasm_backtrace_details_env: bool,
-    // This is currently only present for the `Debug` implementation for extra
-    // context.
-    #[allow(dead_code)]
+    // The code of the store the backtrace was captured in, used to look up
+    // the frames of `runtime_trace` when they're first needed.
+    code: RegisteredCode,
+    trap_pc: Option<usize>,
+    wasm_trace: OnceCell<Vec<FrameInfo>>,
+    wasm_backtrace_details_env_used: bool,
     runtime_trace: wasmtime_runtime::Backtrace,
 }
 
@@ -215,9 +221,10 @@ impl WasmBacktrace {
     /// backtrace will have no frames in it.
     ///
     /// Note that this function will respect the [`Config::wasm_backtrace`]
-    /// configuration option and will return an empty backtrace if that is
-    /// disabled. To always capture a backtrace use the
-    /// [`WasmBacktrace::force_capture`] method.
+    /// configuration option, as overridden by
+    /// [`Store::set_wasm_backtrace`](crate::Store::set_wasm_backtrace), and
+    /// will return an empty backtrace if that is disabled. To always capture a
+    /// backtrace use the [`WasmBacktrace::force_capture`] method.
     ///
     /// Also note that this function will only capture frames from the
     /// specified `store` on the stack, ignoring frames from other stores if
@@ -256,12 +263,14 @@ impl WasmBacktrace {
     /// ```
     pub fn capture(store: impl AsContext) -> WasmBacktrace {
         let store = store.as_context();
-        if store.engine().config().wasm_backtrace {
+        if store.0.wasm_backtrace() {
             Self::force_capture(store)
         } else {
             WasmBacktrace {
-                wasm_trace: Vec::new(),
-                hint_wasm_backtrace_details_env: false,
+                code: RegisteredCode::default(),
+                trap_pc: None,
+                wasm_trace: OnceCell::new(),
+                wasm_backtrace_details_env_used: false,
                 runtime_trace: wasmtime_runtime::Backtrace::empty(),
             }
         }
@@ -287,12 +296,34 @@ impl WasmBacktrace {
         runtime_trace: wasmtime_runtime::Backtrace,
         trap_pc: Option<usize>,
     ) -> Self {
-        let mut wasm_trace = Vec::<FrameInfo>::with_capacity(runtime_trace.frames().len());
-        let mut hint_wasm_backtrace_details_env = false;
-        let wasm_backtrace_details_env_used =
-            store.engine().config().wasm_backtrace_details_env_used;
+        // Only the raw frames are kept here, along with a handle to the code
+        // they may belong to, as traps can be frequent and the backtrace is
+        // often never looked at.
+        Self {
+            code: store.modules().registered_code(),
+            trap_pc,
+            wasm_trace: OnceCell::new(),
+            wasm_backtrace_details_env_used: store
+                .engine()
+                .config()
+                .wasm_backtrace_details_env_used,
+            runtime_trace,
+        }
+    }
+
+    /// Returns a list of function frames in WebAssembly this backtrace
+    /// represents.
+    pub fn frames(&self) -> &[FrameInfo] {
+        self.wasm_trace.get_or_init(|| {
+            self.module_frames()
+                .filter_map(|(module, offset)| FrameInfo::new(module.clone(), offset))
+                .collect()
+        })
+    }
 
-        for frame in runtime_trace.frames() {
+    /// Returns the module and text offset of each frame in this backtrace.
+    fn module_frames(&self) -> impl Iterator<Item = (&Module, usize)> + '_ {
+        self.runtime_trace.frames().filter_map(move |frame| {
             debug_assert!(frame.pc() != 0);
 
             // Note that we need to be careful about the pc we pass in
@@ -305,7 +336,7 @@ impl WasmBacktrace {
             // likely a call instruction on the stack). In that case we
             // want to lookup information for the previous instruction
             // (the call instruction) so we subtract one as the lookup.
-            let pc_to_lookup = if Some(frame.pc()) == trap_pc {
+            let pc_to_lookup = if Some(frame.pc()) == self.trap_pc {
                 frame.pc()
             } else {
                 frame.pc() - 1
@@ -330,38 +361,38 @@ impl WasmBacktrace {
             //
             // In this scenario, the `wasmtime_runtime::Backtrace` will contain
             // two frames: Wasm in store B followed by Wasm in store A. But
-            // `store.modules()` will only have the module information for
-            // modules instantiated within this store. Therefore, we use `if let
-            // Some(..)` instead of the `unwrap` you might otherwise expect and
-            // we ignore frames from modules that were not registered in this
-            // store's module registry.
-            if let Some((info, module)) = store.modules().lookup_frame_info(pc_to_lookup) {
-                wasm_trace.push(info);
-
-                // If this frame has unparsed debug information and the
-                // store's configuration indicates that we were
-                // respecting the environment variable of whether to
-                // do this then we will print out a helpful note in
-                // `Display` to indicate that more detailed information
-                // in a trap may be available.
-                let has_unparsed_debuginfo = module.compiled_module().has_unparsed_debuginfo();
-                if has_unparsed_debuginfo && wasm_backtrace_details_env_used {
-                    hint_wasm_backtrace_details_env = true;
-                }
-            }
-        }
+            // `self.code` will only have the module information for modules
+            // instantiated within this store. Therefore, we use `filter_map`
+            // instead of the `unwrap` you might otherwise expect and we ignore
+            // frames from modules that were not registered in this store's
+            // module registry.
+            self.code.module_and_offset(pc_to_lookup)
+        })
+    }
 
-        Self {
-            wasm_trace,
-            runtime_trace,
-            hint_wasm_backtrace_details_env,
-        }
+    /// Returns whether this backtrace has no frames, without symbolizing any.
+    ///
+    /// This stops at the first frame found, which is usually the innermost
+    /// one.
+    fn is_empty(&self) -> bool {
+        !self.module_frames().any(|(module, offset)| {
+            module
+                .compiled_module()
+                .func_by_text_offset(offset)
+                .is_some()
+        })
     }
 
-    /// Returns a list of function frames in WebAssembly this backtrace
-    /// represents.
-    pub fn frames(&self) -> &[FrameInfo] {
-        self.wasm_trace.as_slice()
+    // If a frame has unparsed debug information and the store's configuration
+    // indicates that we were respecting the environment variable of whether to
+    // do this then we will print out a helpful note in `Display` to indicate
+    // that more detailed information in a trap may be available.
+    fn hint_wasm_backtrace_details_env(&self) -> bool {
+        self.wasm_backtrace_details_env_used
+            && self
+                .frames()
+                .iter()
+                .any(|frame| frame.module().compiled_module().has_unparsed_debuginfo())
     }
 }
 
@@ -370,7 +401,7 @@ impl fmt::Display for WasmBacktrace {
         writeln!(f, "error while executing at wasm backtrace:")?;
 
         let mut needs_newline = false;
-        for (i, frame) in self.wasm_trace.iter().enumerate() {
+        for (i, frame) in self.frames().iter().enumerate() {
             // Avoid putting a trailing newline on the output
             if needs_newline {
                 writeln!(f, "")?;
@@ -415,7 +446,7 @@ impl fmt::Display for WasmBacktrace {
                 }
             }
         }
-        if self.hint_wasm_backtrace_details_env {
+        if self.hint_wasm_backtrace_details_env() {
             write!(f, "\nnote: using the `WASMTIME_BACKTRACE_DETAILS=1` environment variable may show more debugging information")?;
         }
         Ok(())
@@ -0,0 +1,222 @@
+/*
+Example of using the C++20 coroutine support in `wasmtime.hh`: awaiting
+asynchronous instantiation and calls, and host functions written as
+coroutines.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   c++ examples/cxx-async.cpp \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -std=c++20 \
+       -lpthread -ldl -lm \
+       -o cxx-async
+   ./cxx-async
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+
+You can also build using cmake:
+
+mkdir build && cd build && cmake .. && cmake --build . --target wasmtime-cxx-async
+*/
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <wasmtime.hh>
+
+#ifndef WASMTIME_HH_COROUTINES
+#error "this example requires a compiler with C++20 coroutines"
+#endif
+
+using namespace wasmtime;
+
+namespace {
+
+void check(bool condition, const char *what) {
+  if (!condition) {
+    std::cerr << "check failed: " << what << std::endl;
+    std::exit(1);
+  }
+}
+
+std::string read_file(const char *path) {
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  if (!file) {
+    std::cerr << "error reading file: " << path << std::endl;
+    std::exit(1);
+  }
+  return buffer.str();
+}
+
+/// A single-threaded executor running queued work on the thread which calls
+/// `run_until`. Work may be queued from any thread.
+class Executor {
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::function<void()>> queue_;
+
+public:
+  void execute(std::function<void()> work) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(std::move(work));
+    }
+    ready_.notify_one();
+  }
+
+  template <typename Done> void run_until(Done done) {
+    while (!done()) {
+      std::function<void()> work;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return !queue_.empty(); });
+        work = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      work();
+    }
+  }
+};
+
+/// Suspends a coroutine and resumes it later on `executor`, standing in for
+/// waiting on I/O.
+struct Defer {
+  Executor &executor;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    executor.execute([handle] { handle.resume(); });
+  }
+  void await_resume() const noexcept {}
+};
+
+/// A coroutine which starts running immediately, and which is done once it
+/// returns.
+class Task {
+public:
+  struct promise_type {
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  Task(Task &&other) : handle_(std::exchange(other.handle_, {})) {}
+  ~Task() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  bool done() const { return handle_.done(); }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+Task run(Store &store, Linker &linker, const Module &module,
+         Executor &executor, const std::vector<int32_t> &logged) {
+  std::cout << "Instantiating module..." << std::endl;
+  Instance instance =
+      (co_await linker.instantiate_async(store, module).on(executor)).unwrap();
+
+  std::cout << "Calling an async function..." << std::endl;
+  auto run_func =
+      instance.get_typed_func<int32_t(int32_t)>(store, "run").unwrap();
+  Result<int32_t> result = co_await run_func.call_async(store, 4).on(executor);
+  check(result.unwrap() == 41, "run(4) == 41");
+  check(logged == std::vector<int32_t>{4}, "log(4) was called");
+
+  // Without an executor the call is polled on whichever thread wakes it,
+  // which here is still the executor's, as that's where the host coroutines
+  // are resumed.
+  result = co_await run_func.call_async(store, 5);
+  check(result.unwrap() == 51, "run(5) == 51");
+
+  std::cout << "Checking errors..." << std::endl;
+  auto fail = instance.get_typed_func<int32_t(int32_t)>(store, "fail").unwrap();
+  Result<int32_t> failed = co_await fail.call_async(store, 1).on(executor);
+  check(!failed, "host errors trap");
+  check(failed.err().is_trap(), "host errors become traps");
+  check(failed.err().message().find("fetch failed") != std::string::npos,
+        "host error message");
+
+  // A future which is never awaited cancels its call.
+  {
+    auto cancelled = run_func.call_async(store, 6);
+  }
+
+  std::cout << "Instantiating module ahead of time..." << std::endl;
+  InstancePre pre = linker.instantiate_pre(module).unwrap();
+  Instance second =
+      (co_await pre.instantiate_async(store).on(executor)).unwrap();
+  auto second_run =
+      second.get_typed_func<int32_t(int32_t)>(store, "run").unwrap();
+  result = co_await second_run.call_async(store, 7).on(executor);
+  check(result.unwrap() == 71, "run(7) == 71");
+}
+
+} // namespace
+
+int main() {
+  Config config;
+  wasmtime_config_async_support_set(config.capi(), true);
+  Engine engine(std::move(config));
+  Module module =
+      Module::compile(engine, read_file("examples/cxx-async.wat")).unwrap();
+
+  Executor executor;
+  std::vector<int32_t> logged;
+
+  Store store(engine);
+  Linker linker(engine);
+  std::cout << "Defining host functions..." << std::endl;
+  linker
+      .func_wrap_async("host", "fetch",
+                       [&executor](int32_t id) -> HostTask<int32_t> {
+                         co_await Defer{executor};
+                         co_return id * 10;
+                       })
+      .unwrap();
+  linker
+      .func_wrap_async("host", "log",
+                       [&executor, &logged](int32_t value) -> HostTask<> {
+                         co_await Defer{executor};
+                         logged.push_back(value);
+                       })
+      .unwrap();
+  linker
+      .func_wrap_async("host", "fail",
+                       [&executor](Caller caller,
+                                   int32_t) -> HostTask<int32_t> {
+                         (void)caller.context();
+                         co_await Defer{executor};
+                         co_return Error(std::string("fetch failed"));
+                       })
+      .unwrap();
+
+  Task task = run(store, linker, module, executor, logged);
+  executor.run_until([&] { return task.done(); });
+
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,12 @@
+(module
+  (import "host" "fetch" (func $fetch (param i32) (result i32)))
+  (import "host" "log" (func $log (param i32)))
+  (import "host" "fail" (func $fail (param i32) (result i32)))
+
+  (func (export "run") (param i32) (result i32)
+    (call $log (local.get 0))
+    (i32.add (call $fetch (local.get 0)) (i32.const 1)))
+
+  (func (export "fail") (param i32) (result i32)
+    (call $fail (local.get 0)))
+)
@@ -0,0 +1,157 @@
+/*
+Example of using the header-only C++ API in `wasmtime.hh`: typed calls into
+WebAssembly and host functions, errors and traps, and the lifetime of host
+function state.
+
+You can compile and run this example on Linux with:
+
+   cargo build --release -p wasmtime-c-api
+   c++ examples/cxx.cpp \
+       -I crates/c-api/include \
+       -I crates/c-api/wasm-c-api/include \
+       target/release/libwasmtime.a \
+       -std=c++17 \
+       -lpthread -ldl -lm \
+       -o cxx
+   ./cxx
+
+Note that on Windows and macOS the command will be similar, but you'll need
+to tweak the `-lpthread` and such annotations.
+
+You can also build using cmake:
+
+mkdir build && cd build && cmake .. && cmake --build . --target wasmtime-cxx
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <wasmtime.hh>
+
+using namespace wasmtime;
+
+namespace {
+
+void check(bool condition, const char *what) {
+  if (!condition) {
+    std::cerr << "check failed: " << what << std::endl;
+    std::exit(1);
+  }
+}
+
+std::string read_file(const char *path) {
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  if (!file) {
+    std::cerr << "error reading file: " << path << std::endl;
+    std::exit(1);
+  }
+  return buffer.str();
+}
+
+bool contains(const std::string &haystack, const char *needle) {
+  return haystack.find(needle) != std::string::npos;
+}
+
+} // namespace
+
+int main() {
+  Engine engine;
+  Module module =
+      Module::compile(engine, read_file("examples/cxx.wat")).unwrap();
+
+  // Host functions own what they capture, and release it once nothing can
+  // call them anymore.
+  auto token = std::make_shared<int>(0);
+
+  {
+    Store store(engine);
+    Linker linker(engine);
+
+    std::cout << "Defining host functions..." << std::endl;
+    linker.func_wrap("host", "double", [token](int32_t x) { return x * 2; })
+        .unwrap();
+    linker
+        .func_wrap("host", "checked",
+                   [](Caller caller, int32_t x) -> Result<int32_t> {
+                     (void)caller.context();
+                     if (x < 0)
+                       return Error(std::string("negative input"));
+                     return x;
+                   })
+        .unwrap();
+
+    // Copies of a module share its code, and either may be instantiated.
+    Module copy = module;
+    Module moved = std::move(copy);
+
+    std::cout << "Instantiating module..." << std::endl;
+    Instance instance = linker.instantiate(store, moved).unwrap();
+
+    std::cout << "Calling typed functions..." << std::endl;
+    auto run = instance.get_typed_func<int64_t(int32_t, double)>(store, "run")
+                   .unwrap();
+    check(run.call(store, 21, 2.5).unwrap() == 44, "run(21, 2.5) == 44");
+
+    auto swap = instance
+                    .get_typed_func<std::tuple<float, int64_t>(int64_t, float)>(
+                        store, "swap")
+                    .unwrap();
+    auto swapped = swap.call(store, 7, 1.5f).unwrap();
+    check(swapped == std::make_tuple(1.5f, int64_t(7)), "swap(7, 1.5)");
+
+    Func add = Func::wrap(store, [](int64_t a, int64_t b) { return a + b; });
+    auto typed_add = add.typed<int64_t(int64_t, int64_t)>(store).unwrap();
+    check(typed_add.call(store, 2, 3).unwrap() == 5, "add(2, 3) == 5");
+
+    std::cout << "Checking errors..." << std::endl;
+    auto mismatch = instance.get_typed_func<int32_t(int32_t)>(store, "run");
+    check(!mismatch, "signature mismatch is an error");
+    check(!mismatch.err().is_trap(), "signature mismatch isn't a trap");
+    check(contains(mismatch.err().message(), "signature mismatch"),
+          "signature mismatch message");
+
+    auto missing = instance.get_typed_func<void()>(store, "missing");
+    check(!missing, "missing export is an error");
+    check(contains(missing.err().message(), "missing"),
+          "missing export message");
+
+    auto divide = instance.get_typed_func<int32_t(int32_t, int32_t)>(
+                              store, "divide")
+                      .unwrap();
+    check(divide.call(store, 7, 2).unwrap() == 3, "divide(7, 2) == 3");
+    auto trapped = divide.call(store, 1, 0);
+    check(!trapped, "division by zero traps");
+    check(trapped.err().is_trap(), "division by zero is a trap");
+    check(trapped.err().trap_code() ==
+              WASMTIME_TRAP_CODE_INTEGER_DIVISION_BY_ZERO,
+          "division by zero trap code");
+
+    auto checked =
+        instance.get_typed_func<int32_t(int32_t)>(store, "checked").unwrap();
+    check(checked.call(store, 3).unwrap() == 3, "checked(3) == 3");
+    auto failed = checked.call(store, -1);
+    check(!failed, "host errors trap");
+    check(failed.err().is_trap(), "host errors become traps");
+    check(contains(failed.err().message(), "negative input"),
+          "host error message");
+
+    // Errors own what they wrap, and a moved-from error has no message.
+    Error error = std::move(failed.err());
+    check(failed.err().message().empty(), "moved-from error is empty");
+    check(contains(error.message(), "negative input"), "moved error message");
+
+    check(token.use_count() > 1, "host function state is alive");
+  }
+
+  // Dropping the store and the linker releases the host functions.
+  check(token.use_count() == 1, "host function state is released");
+
+  std::cout << "Done." << std::endl;
+  return 0;
+}
@@ -0,0 +1,19 @@
+(module
+  (import "host" "double" (func $double (param i32) (result i32)))
+  (import "host" "checked" (func $checked (param i32) (result i32)))
+
+  (func (export "run") (param i32 f64) (result i64)
+    (i64.add
+      (i64.extend_i32_s (call $double (local.get 0)))
+      (i64.trunc_f64_s (local.get 1))))
+
+  (func (export "swap") (param i64 f32) (result f32 i64)
+    local.get 1
+    local.get 0)
+
+  (func (export "checked") (param i32) (result i32)
+    (call $checked (local.get 0)))
+
+  (func (export "divide") (param i32 i32) (result i32)
+    (i32.div_s (local.get 0) (local.get 1)))
+)
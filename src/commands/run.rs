@@ -744,7 +744,13 @@ impl RunCommand {
 
     fn set_preview2_ctx(&self, store: &mut Store<Host>) -> Result<()> {
         let mut builder = preview2::WasiCtxBuilder::new();
-        builder.inherit_stdio().args(&self.compute_argv()?);
+        match self.run.common.wasi.stdio_buffer {
+            Some(capacity) => {
+                builder.inherit_stdio_buffered(capacity, std::time::Duration::from_millis(100))
+            }
+            None => builder.inherit_stdio(),
+        };
+        builder.args(&self.compute_argv()?);
 
         for (key, value) in self.vars.iter() {
             let value = match value {
@@ -892,18 +898,16 @@ fn write_core_dump(
     path: &str,
 ) -> Result<()> {
     use std::fs::File;
-    use std::io::Write;
+    use std::io::BufWriter;
 
     let core_dump = err
         .downcast_ref::<wasmtime::WasmCoreDump>()
         .expect("should have been configured to capture core dumps");
 
-    let core_dump = core_dump.serialize(store, name);
-
-    let mut core_dump_file =
+    let core_dump_file =
         File::create(path).context(format!("failed to create file at `{}`", path))?;
-    core_dump_file
-        .write_all(&core_dump)
+    core_dump
+        .serialize_to(store, name, BufWriter::new(core_dump_file))
         .with_context(|| format!("failed to write core dump file at `{}`", path))?;
     Ok(())
 }
@@ -1,21 +1,23 @@
 use crate::common::{Profile, RunCommon, RunTarget};
-use anyhow::{anyhow, bail, Result};
+use anyhow::{anyhow, bail, Context, Result};
 use clap::Parser;
 use std::{
     path::PathBuf,
     pin::Pin,
     sync::{
-        atomic::{AtomicBool, AtomicU64, Ordering},
-        Arc,
+        atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering},
+        Arc, Mutex, Weak,
     },
+    time::Duration,
 };
+use tokio::sync::{mpsc, OwnedSemaphorePermit, Semaphore};
 use wasmtime::component::{InstancePre, Linker};
 use wasmtime::{Engine, Store, StoreLimits};
 use wasmtime_wasi::preview2::{self, StreamError, StreamResult, WasiCtx, WasiCtxBuilder, WasiView};
 use wasmtime_wasi_http::io::TokioIo;
 use wasmtime_wasi_http::{
     bindings::http::types as http_types, body::HyperOutgoingBody, hyper_response_error,
-    WasiHttpCtx, WasiHttpView,
+    proxy::Proxy, WasiHttpCtx, WasiHttpView,
 };
 
 #[cfg(feature = "wasi-nn")]
@@ -75,6 +77,48 @@ pub struct ServeCommand {
     #[arg(long = "addr", value_name = "SOCKADDR", default_value_t = DEFAULT_ADDR )]
     addr: std::net::SocketAddr,
 
+    /// Number of instances of the component to create ahead of the requests
+    /// which use them.
+    ///
+    /// Requests take an instance from this pool when one is ready, instead of
+    /// instantiating the component themselves, and the pool is refilled in the
+    /// background. Requests which find the pool empty instantiate the
+    /// component as usual.
+    #[arg(long = "warm-pool", value_name = "N", default_value_t = 0)]
+    warm_pool: usize,
+
+    /// Maximum number of requests to handle at once.
+    ///
+    /// Requests beyond this wait, in the order they arrived, for one of the
+    /// requests being handled to finish.
+    #[arg(long = "max-concurrent-requests", value_name = "N")]
+    max_concurrent_requests: Option<usize>,
+
+    /// Maximum number of requests to keep waiting when
+    /// `--max-concurrent-requests` are already being handled.
+    ///
+    /// Requests beyond this are answered with `503 Service Unavailable`. By
+    /// default there's no limit.
+    #[arg(
+        long = "max-queued-requests",
+        value_name = "N",
+        requires = "max_concurrent_requests"
+    )]
+    max_queued_requests: Option<usize>,
+
+    /// Number of shards to split the server into.
+    ///
+    /// Each shard is a thread running a single-threaded runtime with its own
+    /// listener on `--addr`, and the kernel spreads incoming connections
+    /// across the listeners with `SO_REUSEPORT`. Shards are pinned to cores
+    /// where the platform supports it, and a connection is handled entirely
+    /// on the shard which accepted it. `--warm-pool` and the request limits
+    /// apply to each shard separately.
+    ///
+    /// By default a single listener feeds a multi-threaded runtime instead.
+    #[arg(long = "shards", value_name = "N")]
+    shards: Option<usize>,
+
     /// The WebAssembly component to run.
     #[arg(value_name = "WASM", required = true)]
     component: PathBuf,
@@ -109,6 +153,14 @@ impl ServeCommand {
             bail!("wasi-threads does not support components yet")
         }
 
+        if self.max_concurrent_requests == Some(0) {
+            bail!("--max-concurrent-requests must be at least 1");
+        }
+
+        if self.shards == Some(0) {
+            bail!("--shards must be at least 1");
+        }
+
         // The serve command requires both wasi-http and the component model, so we enable those by
         // default here.
         if self.run.common.wasi.http.replace(true) == Some(false) {
@@ -118,6 +170,10 @@ impl ServeCommand {
             bail!("components are required for the serve command, and must not be disabled");
         }
 
+        if let Some(shards) = self.shards {
+            return self.serve_sharded(shards);
+        }
+
         let runtime = tokio::runtime::Builder::new_multi_thread()
             .enable_time()
             .enable_io()
@@ -237,9 +293,8 @@ impl ServeCommand {
         Ok(())
     }
 
-    async fn serve(mut self) -> Result<()> {
-        use hyper::server::conn::http1;
-
+    /// Compiles the component and prepares it for instantiation.
+    fn prepare(&mut self) -> Result<(Engine, InstancePre<Host>)> {
         let mut config = self.run.common.config(None)?;
         config.wasm_component_model(true);
         config.async_support(true);
@@ -271,6 +326,12 @@ impl ServeCommand {
 
         let instance = linker.instantiate_pre(&component)?;
 
+        Ok((engine, instance))
+    }
+
+    async fn serve(mut self) -> Result<()> {
+        let (engine, instance) = self.prepare()?;
+
         let listener = tokio::net::TcpListener::bind(self.addr).await?;
 
         eprintln!("Serving HTTP on http://{}/", listener.local_addr()?);
@@ -283,25 +344,180 @@ impl ServeCommand {
 
         log::info!("Listening on {}", self.addr);
 
-        let handler = ProxyHandler::new(self, engine, instance);
-
-        loop {
-            let (stream, _) = listener.accept().await?;
-            let stream = TokioIo::new(stream);
-            let h = handler.clone();
-            tokio::task::spawn(async move {
-                if let Err(e) = http1::Builder::new()
-                    .keep_alive(true)
-                    .serve_connection(stream, h)
-                    .await
-                {
-                    eprintln!("error: {e:?}");
-                }
-            });
+        // Instantiating runs on the runtime's worker threads, so at most half
+        // of them refill the warm pool, to leave the rest for the requests
+        // themselves.
+        let parallelism = std::thread::available_parallelism().map_or(1, |n| n.get());
+        let refills = (parallelism / 2).max(1);
+
+        let handler = ProxyHandler::new(Arc::new(self), engine, instance, 0, 1, refills);
+
+        accept(listener, handler).await
+    }
+
+    fn serve_sharded(mut self, shards: usize) -> Result<()> {
+        let (engine, instance) = self.prepare()?;
+
+        let sockets = bind_shared(self.addr, shards)?;
+
+        eprintln!(
+            "Serving HTTP on http://{}/ with {shards} shards",
+            sockets[0].local_addr()?
+        );
+
+        // Epochs belong to the engine, which every shard shares, so one
+        // thread ticks for all of them.
+        let _epoch_thread = if let Some(timeout) = self.run.common.wasm.timeout {
+            Some(EpochThread::spawn(timeout, engine.clone()))
+        } else {
+            None
+        };
+
+        log::info!("Listening on {} with {shards} shards", self.addr);
+
+        let cores = available_cores();
+        let cmd = Arc::new(self);
+        let (exited, mut exits) = mpsc::unbounded_channel();
+
+        for (i, socket) in sockets.into_iter().enumerate() {
+            let (cmd, engine, instance) = (cmd.clone(), engine.clone(), instance.clone());
+            let core = (!cores.is_empty()).then(|| cores[i % cores.len()]);
+            let exited = exited.clone();
+
+            std::thread::Builder::new()
+                .name(format!("wasmtime-serve-{i}"))
+                .spawn(move || {
+                    if let Some(core) = core {
+                        if let Err(e) = pin_to_core(core) {
+                            log::warn!("failed to pin shard {i} to core {core}: {e}");
+                        }
+                    }
+
+                    let result = tokio::runtime::Builder::new_current_thread()
+                        .enable_time()
+                        .enable_io()
+                        .build()
+                        .map_err(anyhow::Error::from)
+                        .and_then(|runtime| {
+                            runtime.block_on(async move {
+                                // Request ids are interleaved across the
+                                // shards so that each can hand them out
+                                // without synchronizing with the others. A
+                                // shard has a single thread, so a single task
+                                // refills its warm pool.
+                                let handler = ProxyHandler::new(
+                                    cmd,
+                                    engine,
+                                    instance,
+                                    i as u64,
+                                    shards as u64,
+                                    1,
+                                );
+                                let listener = socket.listen(1024)?;
+                                accept(listener, handler).await
+                            })
+                        });
+                    let _ = exited.send(result.with_context(|| format!("shard {i} failed")));
+                })?;
         }
+
+        let runtime = tokio::runtime::Builder::new_current_thread()
+            .enable_io()
+            .build()?;
+
+        runtime.block_on(async move {
+            tokio::select! {
+                _ = tokio::signal::ctrl_c() => Ok(()),
+
+                // Shards only stop when they fail, and then the whole server
+                // stops with them.
+                Some(res) = exits.recv() => res,
+            }
+        })
     }
 }
 
+/// Serves HTTP on every connection accepted by `listener`.
+async fn accept(listener: tokio::net::TcpListener, handler: ProxyHandler) -> Result<()> {
+    use hyper::server::conn::http1;
+
+    loop {
+        let (stream, _) = listener.accept().await?;
+        let stream = TokioIo::new(stream);
+        let h = handler.clone();
+        tokio::task::spawn(async move {
+            if let Err(e) = http1::Builder::new()
+                .keep_alive(true)
+                .serve_connection(stream, h)
+                .await
+            {
+                eprintln!("error: {e:?}");
+            }
+        });
+    }
+}
+
+/// Binds `count` sockets to `addr` which share it with `SO_REUSEPORT`.
+///
+/// When `addr` has no port the first socket picks one and the rest bind to
+/// it.
+#[cfg(all(unix, not(any(target_os = "solaris", target_os = "illumos"))))]
+fn bind_shared(addr: std::net::SocketAddr, count: usize) -> Result<Vec<tokio::net::TcpSocket>> {
+    let mut addr = addr;
+    let mut sockets = Vec::with_capacity(count);
+    for _ in 0..count {
+        let socket = if addr.is_ipv4() {
+            tokio::net::TcpSocket::new_v4()?
+        } else {
+            tokio::net::TcpSocket::new_v6()?
+        };
+        socket.set_reuseaddr(true)?;
+        socket.set_reuseport(true)?;
+        socket
+            .bind(addr)
+            .with_context(|| format!("failed to bind to {addr}"))?;
+        addr = socket.local_addr()?;
+        sockets.push(socket);
+    }
+    Ok(sockets)
+}
+
+#[cfg(not(all(unix, not(any(target_os = "solaris", target_os = "illumos")))))]
+fn bind_shared(_addr: std::net::SocketAddr, _count: usize) -> Result<Vec<tokio::net::TcpSocket>> {
+    bail!("--shards is not supported on this platform, as it requires SO_REUSEPORT")
+}
+
+/// The cores this process is allowed to run on.
+#[cfg(target_os = "linux")]
+fn available_cores() -> Vec<usize> {
+    use rustix::process::{sched_getaffinity, CpuSet};
+
+    match sched_getaffinity(None) {
+        Ok(set) => (0..CpuSet::MAX_CPU).filter(|&i| set.is_set(i)).collect(),
+        Err(_) => Vec::new(),
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+fn available_cores() -> Vec<usize> {
+    Vec::new()
+}
+
+#[cfg(target_os = "linux")]
+fn pin_to_core(core: usize) -> std::io::Result<()> {
+    use rustix::process::{sched_setaffinity, CpuSet};
+
+    let mut set = CpuSet::new();
+    set.set(core);
+    sched_setaffinity(None, &set)?;
+    Ok(())
+}
+
+#[cfg(not(target_os = "linux"))]
+fn pin_to_core(_core: usize) -> std::io::Result<()> {
+    Ok(())
+}
+
 struct EpochThread {
     shutdown: Arc<AtomicBool>,
     handle: Option<std::thread::JoinHandle<()>>,
@@ -335,15 +551,44 @@ impl Drop for EpochThread {
 }
 
 struct ProxyHandlerInner {
-    cmd: ServeCommand,
+    cmd: Arc<ServeCommand>,
     engine: Engine,
     instance_pre: InstancePre<Host>,
     next_id: AtomicU64,
+    id_step: u64,
+    warm_pool: Option<WarmPool>,
+    limit: Option<ConcurrencyLimit>,
 }
 
 impl ProxyHandlerInner {
     fn next_req_id(&self) -> u64 {
-        self.next_id.fetch_add(1, Ordering::Relaxed)
+        self.next_id.fetch_add(self.id_step, Ordering::Relaxed)
+    }
+
+    async fn instantiate(&self) -> Result<ProxyInstance> {
+        let req_id = self.next_req_id();
+        let mut store = self.cmd.new_store(&self.engine, req_id)?;
+        let (proxy, _inst) = Proxy::instantiate_pre(&mut store, &self.instance_pre).await?;
+        Ok(ProxyInstance {
+            req_id,
+            store,
+            proxy,
+        })
+    }
+
+    /// Takes an instance from the warm pool, or creates one if there are none
+    /// ready.
+    async fn take_instance(&self) -> Result<ProxyInstance> {
+        if let Some(mut instance) = self.warm_pool.as_ref().and_then(|pool| pool.take()) {
+            // The epoch may have moved on while the instance sat in the pool,
+            // so the deadline is counted from when it starts handling the
+            // request instead.
+            if self.cmd.run.common.wasm.timeout.is_some() {
+                instance.store.set_epoch_deadline(1);
+            }
+            return Ok(instance);
+        }
+        self.instantiate().await
     }
 }
 
@@ -351,13 +596,137 @@ impl ProxyHandlerInner {
 struct ProxyHandler(Arc<ProxyHandlerInner>);
 
 impl ProxyHandler {
-    fn new(cmd: ServeCommand, engine: Engine, instance_pre: InstancePre<Host>) -> Self {
-        Self(Arc::new(ProxyHandlerInner {
+    /// Creates a handler whose request ids start at `first_id` and go up by
+    /// `id_step`, and which refills its warm pool with up to `refills`
+    /// instantiations at once.
+    fn new(
+        cmd: Arc<ServeCommand>,
+        engine: Engine,
+        instance_pre: InstancePre<Host>,
+        first_id: u64,
+        id_step: u64,
+        refills: usize,
+    ) -> Self {
+        let (warm_pool, ready) = if cmd.warm_pool > 0 {
+            let (tx, rx) = mpsc::channel(cmd.warm_pool);
+            (Some(WarmPool(Mutex::new(rx))), Some(tx))
+        } else {
+            (None, None)
+        };
+        let limit = cmd
+            .max_concurrent_requests
+            .map(|max| ConcurrencyLimit::new(max, cmd.max_queued_requests));
+
+        let inner = Arc::new(ProxyHandlerInner {
             cmd,
             engine,
             instance_pre,
-            next_id: AtomicU64::from(0),
-        }))
+            next_id: AtomicU64::from(first_id),
+            id_step,
+            warm_pool,
+            limit,
+        });
+
+        if let Some(ready) = ready {
+            // Several instances can be created at once to refill the pool
+            // after a burst of requests.
+            for _ in 0..inner.cmd.warm_pool.min(refills) {
+                WarmPool::spawn_refill(Arc::downgrade(&inner), ready.clone());
+            }
+        }
+
+        Self(inner)
+    }
+}
+
+/// A store with the proxy component instantiated in it.
+struct ProxyInstance {
+    req_id: u64,
+    store: Store<Host>,
+    proxy: Proxy,
+}
+
+/// Instances of the proxy component which are ready to handle a request.
+struct WarmPool(Mutex<mpsc::Receiver<ProxyInstance>>);
+
+impl WarmPool {
+    fn take(&self) -> Option<ProxyInstance> {
+        self.0.lock().unwrap().try_recv().ok()
+    }
+
+    /// Spawns a task which adds instances to the pool whenever it has room for
+    /// them, until the handler is dropped.
+    fn spawn_refill(inner: Weak<ProxyHandlerInner>, ready: mpsc::Sender<ProxyInstance>) {
+        const MIN_BACKOFF: Duration = Duration::from_millis(100);
+        const MAX_BACKOFF: Duration = Duration::from_secs(30);
+
+        tokio::task::spawn(async move {
+            let mut backoff = MIN_BACKOFF;
+
+            // Reserving space first means that an instance is only created
+            // once there's a place for it in the pool.
+            while let Ok(permit) = ready.reserve().await {
+                let Some(inner) = inner.upgrade() else {
+                    return;
+                };
+                match inner.instantiate().await {
+                    Ok(instance) => {
+                        permit.send(instance);
+                        backoff = MIN_BACKOFF;
+                    }
+                    Err(e) => {
+                        // Instantiating can fail for reasons which pass, such
+                        // as running out of memory for a moment, so try again
+                        // later. Requests meanwhile instantiate the component
+                        // themselves. The handler isn't kept alive while
+                        // waiting.
+                        log::error!(
+                            "failed to instantiate for the warm pool, retrying in {backoff:?}: {e:?}"
+                        );
+                        drop((permit, inner));
+                        tokio::time::sleep(backoff).await;
+                        backoff = (backoff * 2).min(MAX_BACKOFF);
+                    }
+                }
+            }
+        });
+    }
+}
+
+/// A limit on the number of requests handled at once.
+struct ConcurrencyLimit {
+    permits: Arc<Semaphore>,
+    max_queued: Option<usize>,
+    queued: AtomicUsize,
+}
+
+impl ConcurrencyLimit {
+    fn new(max_concurrent: usize, max_queued: Option<usize>) -> Self {
+        ConcurrencyLimit {
+            permits: Arc::new(Semaphore::new(max_concurrent)),
+            max_queued,
+            queued: AtomicUsize::new(0),
+        }
+    }
+
+    /// Waits for a request to be allowed to run, returning `None` if too many
+    /// requests are already waiting.
+    ///
+    /// The semaphore is fair, so requests are let through in the order they
+    /// started waiting.
+    async fn acquire(&self) -> Option<OwnedSemaphorePermit> {
+        if let Ok(permit) = self.permits.clone().try_acquire_owned() {
+            return Some(permit);
+        }
+        let queued = self.queued.fetch_add(1, Ordering::Relaxed);
+        if self.max_queued.is_some_and(|max| queued >= max) {
+            self.queued.fetch_sub(1, Ordering::Relaxed);
+            return None;
+        }
+        let permit = self.permits.clone().acquire_owned().await;
+        self.queued.fetch_sub(1, Ordering::Relaxed);
+        // The semaphore is never closed.
+        Some(permit.unwrap())
     }
 }
 
@@ -377,7 +746,22 @@ impl hyper::service::Service<Request> for ProxyHandler {
 
         // TODO: need to track the join handle, but don't want to block the response on it
         tokio::task::spawn(async move {
-            let req_id = inner.next_req_id();
+            // The permit is held until the guest returns, which may be after
+            // the response has been sent if it streams the body.
+            let _permit = match &inner.limit {
+                Some(limit) => match limit.acquire().await {
+                    Some(permit) => Some(permit),
+                    None => {
+                        let resp = hyper::Response::builder()
+                            .status(hyper::StatusCode::SERVICE_UNAVAILABLE)
+                            .body(http_body_util::Empty::new().map_err(|e| match e {}).boxed())?;
+                        let _ = sender.send(Ok(resp));
+                        return Ok(());
+                    }
+                },
+                None => None,
+            };
+
             let (mut parts, body) = req.into_parts();
 
             parts.uri = {
@@ -410,21 +794,21 @@ impl hyper::service::Service<Request> for ProxyHandler {
 
             let req = hyper::Request::from_parts(parts, body.map_err(hyper_response_error).boxed());
 
+            let ProxyInstance {
+                req_id,
+                mut store,
+                proxy,
+            } = inner.take_instance().await?;
+
             log::info!(
                 "Request {req_id} handling {} to {}",
                 req.method(),
                 req.uri()
             );
 
-            let mut store = inner.cmd.new_store(&inner.engine, req_id)?;
-
             let req = store.data_mut().new_incoming_request(req)?;
             let out = store.data_mut().new_response_outparam(sender)?;
 
-            let (proxy, _inst) =
-                wasmtime_wasi_http::proxy::Proxy::instantiate_pre(&mut store, &inner.instance_pre)
-                    .await?;
-
             if let Err(e) = proxy
                 .wasi_http_incoming_handler()
                 .call_handle(store, req, out)
@@ -409,6 +409,86 @@ async fn async_host_func_with_pooling_stacks() -> Result<()> {
     Ok(())
 }
 
+#[tokio::test]
+async fn async_with_cached_stacks() -> Result<()> {
+    for zeroing in [false, true] {
+        let mut config = Config::new();
+        config.async_support(true);
+        config.async_stack_cache_size(1);
+        config.async_stack_cache_zeroing(zeroing);
+        config.async_stack_cache_keep_resident(4096);
+
+        let engine = Engine::new(&config)?;
+        let mut store = Store::new(&engine, ());
+        let func = Func::new_async(
+            &mut store,
+            FuncType::new(None, None),
+            move |_caller, _params, _results| Box::new(async { Ok(()) }),
+        );
+
+        // Run enough calls, including concurrent ones, to exercise both
+        // reusing a cached stack and freeing stacks when the cache is full.
+        run_smoke_test(&mut store, func).await;
+        run_smoke_typed_test(&mut store, func).await;
+        let mut store2 = Store::new(&engine, ());
+        let func2 = Func::wrap0_async(&mut store2, move |_caller| Box::new(async { Ok(()) }));
+        let (a, b) = tokio::join!(
+            func.call_async(&mut store, &[], &mut []),
+            func2.call_async(&mut store2, &[], &mut []),
+        );
+        a?;
+        b?;
+        run_smoke_test(&mut store, func).await;
+    }
+    Ok(())
+}
+
+// Only stacks whose memory range is known are cached, which excludes Windows'
+// native fiber stacks.
+#[tokio::test]
+#[cfg(unix)]
+async fn async_cached_stacks_are_reused() -> Result<()> {
+    use std::sync::atomic::{AtomicUsize, Ordering::SeqCst};
+
+    for zeroing in [false, true] {
+        let mut config = Config::new();
+        config.async_support(true);
+        config.async_stack_cache_size(1);
+        config.async_stack_cache_zeroing(zeroing);
+        config.async_stack_cache_keep_resident(4096);
+
+        let engine = Engine::new(&config)?;
+        let mut store = Store::new(&engine, ());
+
+        // Records the address of a local on the fiber stack of each call.
+        let slot = Arc::new(AtomicUsize::new(0));
+        let func = Func::wrap0_async(&mut store, {
+            let slot = slot.clone();
+            move |_caller| {
+                let mut local = 0u64;
+                unsafe { std::ptr::write_volatile(&mut local, u64::MAX) };
+                slot.store(&local as *const u64 as usize, SeqCst);
+                Box::new(async { Ok(()) })
+            }
+        });
+
+        func.call_async(&mut store, &[], &mut []).await?;
+        let first = slot.load(SeqCst);
+
+        // The stack is still mapped once the call has returned, as it's in
+        // the cache rather than freed, and it has been reset if requested.
+        let value = unsafe { std::ptr::read_volatile(first as *const u64) };
+        if zeroing {
+            assert_eq!(value, 0);
+        }
+
+        // The next call runs on that same stack.
+        func.call_async(&mut store, &[], &mut []).await?;
+        assert_eq!(slot.load(SeqCst), first);
+    }
+    Ok(())
+}
+
 /// This will execute the `future` provided to completion and each invocation of
 /// `poll` for the future will be executed on a separate thread.
 pub async fn execute_across_threads<F>(future: F) -> F::Output
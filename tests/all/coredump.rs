@@ -258,3 +258,61 @@ fn multiple_globals_memories_and_instances() -> Result<()> {
 
     Ok(())
 }
+
+#[test]
+#[cfg_attr(miri, ignore)]
+fn coredump_streams_sparse_memory() -> Result<()> {
+    let mut config = Config::default();
+    config.coredump_on_trap(true);
+    let engine = Engine::new(&config).unwrap();
+
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (memory 4)
+                (data (i32.const 10) "abc")
+                (data (i32.const 4090) "page-crossing")
+                (data (i32.const 0x30000) "\01\00\00\02")
+                (func (export "a")
+                    unreachable
+                )
+            )
+        "#,
+    )?;
+
+    let mut store = Store::<()>::new(&engine, ());
+    let instance = Instance::new(&mut store, &module, &[])?;
+
+    let a_func = instance.get_typed_func::<(), ()>(&mut store, "a")?;
+    let err = a_func.call(&mut store, ()).unwrap_err();
+    let core_dump = err.downcast_ref::<WasmCoreDump>().unwrap();
+
+    let mut streamed = Vec::new();
+    core_dump.serialize_to(&mut store, "sparse", &mut streamed)?;
+    assert_eq!(streamed, core_dump.serialize(&mut store, "sparse"));
+
+    // The first two pages are merged into one segment, the all-zero third
+    // page is skipped, and the fourth page only covers its non-zero bytes.
+    let mut segments = Vec::new();
+    for payload in wasmparser::Parser::new(0).parse_all(&streamed) {
+        if let wasmparser::Payload::DataSection(reader) = payload? {
+            for data in reader {
+                let data = data?;
+                let offset = match data.kind {
+                    wasmparser::DataKind::Active { offset_expr, .. } => {
+                        match offset_expr.get_operators_reader().read()? {
+                            wasmparser::Operator::I32Const { value } => value,
+                            op => bail!("unexpected offset {op:?}"),
+                        }
+                    }
+                    wasmparser::DataKind::Passive => bail!("unexpected passive segment"),
+                };
+                segments.push((offset, data.data.len()));
+            }
+        }
+    }
+    assert_eq!(segments, [(10, 4093), (0x30000, 4)]);
+
+    Ok(())
+}
@@ -12,6 +12,75 @@ fn wrong_import_numbers() -> Result<()> {
     Ok(())
 }
 
+#[test]
+#[cfg_attr(miri, ignore)]
+fn module_export_index() -> Result<()> {
+    let engine = Engine::default();
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (import "" "peek" (func $peek (result i32)))
+                (memory (export "memory") 1)
+                (data (i32.const 0) "\2a")
+                (func (export "run") (result i32) call $peek)
+            )
+        "#,
+    )?;
+    let other = Module::new(&engine, r#"(module (memory (export "memory") 1))"#)?;
+    assert!(module.get_export_index("missing").is_none());
+    let memory = module.get_export_index("memory").unwrap();
+    let other_memory = other.get_export_index("memory").unwrap();
+
+    let mut store = Store::new(&engine, ());
+    let (memory2, other_memory2) = (memory.clone(), other_memory.clone());
+    let peek = Func::wrap(&mut store, move |mut caller: Caller<'_, ()>| {
+        assert!(caller.get_module_export(&other_memory2).is_none());
+        let memory = caller
+            .get_module_export(&memory2)
+            .and_then(|e| e.into_memory())
+            .unwrap();
+        i32::from(memory.data(&caller)[0])
+    });
+    let instance = Instance::new(&mut store, &module, &[peek.into()])?;
+
+    let by_index = instance
+        .get_module_export(&mut store, &memory)
+        .and_then(|e| e.into_memory())
+        .unwrap();
+    let by_name = instance.get_memory(&mut store, "memory").unwrap();
+    assert_eq!(by_index.data_ptr(&store), by_name.data_ptr(&store));
+    assert!(instance
+        .get_module_export(&mut store, &other_memory)
+        .is_none());
+
+    let run = instance.get_typed_func::<(), i32>(&mut store, "run")?;
+    assert_eq!(run.call(&mut store, ())?, 42);
+    Ok(())
+}
+
+#[test]
+#[cfg_attr(miri, ignore)]
+fn module_export_index_other_engine() -> Result<()> {
+    // Module ids are only unique within an engine, so the first module
+    // compiled by each of these engines has the same id.
+    let wat = r#"(module (memory (export "memory") 1))"#;
+    let engine = Engine::default();
+    let module = Module::new(&engine, wat)?;
+    let other = Module::new(&Engine::default(), wat)?;
+    let other_memory = other.get_export_index("memory").unwrap();
+
+    let mut store = Store::new(&engine, ());
+    let instance = Instance::new(&mut store, &module, &[])?;
+    assert!(instance
+        .get_module_export(&mut store, &other_memory)
+        .is_none());
+    assert!(instance
+        .get_module_export(&mut store, &module.get_export_index("memory").unwrap())
+        .is_some());
+    Ok(())
+}
+
 #[test]
 #[cfg_attr(miri, ignore)]
 fn initializes_linear_memory() -> Result<()> {
@@ -497,6 +497,123 @@ fn dynamic_extra_growth_unchanged_pointer() -> Result<()> {
     Ok(())
 }
 
+#[test]
+#[cfg_attr(miri, ignore)]
+fn dynamic_geometric_growth() -> Result<()> {
+    let mut config = Config::new();
+    config.static_memory_maximum_size(0);
+    config.dynamic_memory_reserved_for_growth(0);
+    config.dynamic_memory_growth_geometric(true);
+    let engine = Engine::new(&config)?;
+    let mut store = Store::new(&engine, ());
+
+    let mem = Memory::new(&mut store, MemoryType::new(1, None))?;
+    mem.data_mut(&mut store)[0] = 1;
+    let mut ptr = mem.data_ptr(&store);
+    let mut relocations = 0;
+
+    // Each page is tagged with its index to ensure that contents are preserved
+    // across relocations, however those are implemented.
+    for page in 1..64 {
+        mem.grow(&mut store, 1)?;
+        mem.data_mut(&mut store)[page << 16] = (page + 1) as u8;
+        if ptr != mem.data_ptr(&store) {
+            ptr = mem.data_ptr(&store);
+            relocations += 1;
+        }
+    }
+
+    // Growth one page at a time to 64 pages relocates at 2, 5, 11, 23 and 47
+    // pages with geometric reservations, rather than on every growth.
+    assert_eq!(relocations, 5);
+    for page in 0..64 {
+        assert_eq!(mem.data(&store)[page << 16], (page + 1) as u8);
+    }
+    Ok(())
+}
+
+#[test]
+#[cfg_attr(miri, ignore)]
+fn memory_reservation_cache() -> Result<()> {
+    for dynamic in [false, true] {
+        let mut config = Config::new();
+        config.memory_reservation_cache_size(1);
+        if dynamic {
+            config.static_memory_maximum_size(0);
+            config.dynamic_memory_reserved_for_growth(0);
+        }
+        let engine = Engine::new(&config)?;
+        let module = Module::new(
+            &engine,
+            r#"
+                (module
+                    (memory (export "mem") 1)
+                    (data (i32.const 0) "\01")
+                )
+            "#,
+        )?;
+
+        let mut base = None;
+        for _ in 0..3 {
+            let mut store = Store::new(&engine, ());
+            let instance = Instance::new(&mut store, &module, &[])?;
+            let mem = instance.get_memory(&mut store, "mem").unwrap();
+
+            // Each memory starts out initialized and otherwise zeroed, even
+            // when its reservation was used by a previous memory.
+            assert_eq!(mem.data(&store)[0], 1);
+            assert!(mem.data(&store)[1..].iter().all(|b| *b == 0));
+            assert_eq!(mem.size(&store), 1);
+
+            // Static memories reuse the same reservation each time.
+            if !dynamic {
+                let ptr = mem.data_ptr(&store);
+                assert_eq!(*base.get_or_insert(ptr), ptr);
+            }
+
+            mem.data_mut(&mut store).fill(0xff);
+            mem.grow(&mut store, 1)?;
+            mem.data_mut(&mut store)[1 << 16] = 0xff;
+        }
+    }
+    Ok(())
+}
+
+#[test]
+#[cfg_attr(miri, ignore)]
+fn memory_grow_hook() -> Result<()> {
+    let engine = Engine::default();
+    let mut store = Store::new(&engine, 0);
+    store.memory_grow_hook(|grows| *grows += 1);
+
+    let module = Module::new(
+        &engine,
+        r#"
+            (module
+                (memory (export "mem") 1)
+                (func (export "grow") (param i32) (result i32)
+                    local.get 0
+                    memory.grow)
+            )
+        "#,
+    )?;
+    let instance = Instance::new(&mut store, &module, &[])?;
+    let mem = instance.get_memory(&mut store, "mem").unwrap();
+    let grow = instance.get_typed_func::<i32, i32>(&mut store, "grow")?;
+
+    // Growth from both wasm and the host runs the hook.
+    assert_eq!(grow.call(&mut store, 1)?, 1);
+    assert_eq!(*store.data(), 1);
+    mem.grow(&mut store, 1)?;
+    assert_eq!(*store.data(), 2);
+
+    // Growth by zero pages or failed growth doesn't.
+    assert_eq!(grow.call(&mut store, 0)?, 3);
+    assert_eq!(grow.call(&mut store, 0x10000)?, -1);
+    assert_eq!(*store.data(), 2);
+    Ok(())
+}
+
 // This test exercises trying to create memories of the maximum 64-bit memory
 // size of `1 << 48` pages. This should always fail but in the process of
 // determining this failure we shouldn't hit any overflows or anything like that
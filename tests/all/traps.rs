@@ -232,6 +232,40 @@ fn test_trap_backtrace_disabled() -> Result<()> {
     Ok(())
 }
 
+#[test]
+fn test_trap_backtrace_disabled_per_store() -> Result<()> {
+    let engine = Engine::default();
+    let wat = r#"
+        (module $hello_mod
+            (func (export "run") (call $hello))
+            (func $hello (unreachable))
+        )
+    "#;
+    let module = Module::new(&engine, wat)?;
+
+    for enable in [false, true, false] {
+        let mut store = Store::<()>::new(&engine, ());
+        store.set_wasm_backtrace(enable);
+        let instance = Instance::new(&mut store, &module, &[])?;
+        let run_func = instance.get_typed_func::<(), ()>(&mut store, "run")?;
+
+        let e = run_func.call(&mut store, ()).unwrap_err();
+        assert_eq!(
+            *e.downcast_ref::<Trap>().unwrap(),
+            Trap::UnreachableCodeReached
+        );
+        match e.downcast_ref::<WasmBacktrace>() {
+            Some(trace) => {
+                assert!(enable);
+                assert_eq!(trace.frames().len(), 2);
+                assert_eq!(trace.frames()[0].func_name(), Some("hello"));
+            }
+            None => assert!(!enable),
+        }
+    }
+    Ok(())
+}
+
 #[test]
 fn test_trap_trace_cb() -> Result<()> {
     let mut store = Store::<()>::default();